@@ -0,0 +1,1222 @@
+#include "common/draw_batcher.hpp"
+#include "common/gltf_utils.hpp"
+#include "common/job_system.hpp"
+#include "common/mesh_optimize.hpp"
+#include "common/mesh_simplify.hpp"
+#include "common/meshlet_builder.hpp"
+#include "common/meshopt_decoder.hpp"
+#include "common/occlusion_culler.hpp"
+#include "common/vertex_quantize.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Checks of the CPU side of the import, culling and scheduling code, on known inputs: no device, no asset, registered with
+// CTest as sakura_checks. Each check prints what differs from the expected result and returns false, the exit
+// code is 1 when a check failed.
+
+namespace {
+
+struct Check
+{
+    std::string           name;
+    std::function<bool()> run;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Reference encoder of the EXT_meshopt_compression index codec (TRIANGLES mode): port of meshopt_encodeIndexBuffer
+// of meshoptimizer, version 1, with its static codeaux table. The decoder must return the encoded triangles as they
+// were, including their rotation.
+//
+std::vector<uint8_t> encodeMeshoptIndexBuffer(std::span<const uint32_t> indices)
+{
+    static const uint8_t  kCodeAuxTable[16] = { 0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0, 0 };
+    static const uint32_t kTriangleOrder[3][3] = { { 0, 1, 2 }, { 1, 2, 0 }, { 2, 0, 1 } };
+    const int             fecMax = 13;
+
+    uint32_t edges[16][2];
+    uint32_t vertices[16];
+    uint32_t edgeOffset = 0;
+    uint32_t vertexOffset = 0;
+    std::fill(&edges[0][0], &edges[0][0] + 32, ~0U);
+    std::fill(vertices, vertices + 16, ~0U);
+
+    const auto findEdge = [&](uint32_t a, uint32_t b, uint32_t c) {
+        for (int i = 0; i < 16; i++)
+        {
+            const uint32_t* edge = edges[(edgeOffset - 1 - i) & 15];
+            if (edge[0] == a && edge[1] == b)
+                return (i << 2) | 0;
+            if (edge[0] == b && edge[1] == c)
+                return (i << 2) | 1;
+            if (edge[0] == c && edge[1] == a)
+                return (i << 2) | 2;
+        }
+        return -1;
+    };
+    const auto findVertex = [&](uint32_t v) {
+        for (int i = 0; i < 16; i++)
+            if (vertices[(vertexOffset - 1 - i) & 15] == v)
+                return i;
+        return -1;
+    };
+    const auto pushEdge = [&](uint32_t a, uint32_t b) {
+        edges[edgeOffset][0] = a;
+        edges[edgeOffset][1] = b;
+        edgeOffset = (edgeOffset + 1) & 15;
+    };
+    const auto pushVertex = [&](uint32_t v) {
+        vertices[vertexOffset] = v;
+        vertexOffset = (vertexOffset + 1) & 15;
+    };
+
+    std::vector<uint8_t> codes;
+    std::vector<uint8_t> data;
+    const auto encodeIndex = [&data](uint32_t index, uint32_t last) {
+        const uint32_t delta = index - last;
+        uint32_t       v = (delta << 1) ^ uint32_t(int32_t(delta) >> 31);
+        do
+        {
+            data.push_back(uint8_t((v & 127) | (v > 127 ? 128 : 0)));
+            v >>= 7;
+        } while (v);
+    };
+
+    uint32_t next = 0;
+    uint32_t last = 0;
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const int edge = findEdge(indices[i + 0], indices[i + 1], indices[i + 2]);
+        if (edge >= 0 && (edge >> 2) < 15)
+        {
+            const uint32_t* order = kTriangleOrder[edge & 3];
+            const uint32_t  a = indices[i + order[0]], b = indices[i + order[1]], c = indices[i + order[2]];
+            const int       fc = findVertex(c);
+            int             fec = (fc >= 1 && fc < fecMax) ? fc : (c == next) ? (next++, 0) : 15;
+            if (fec == 15 && c + 1 == last)
+                fec = 13, last = c;
+            if (fec == 15 && c == last + 1)
+                fec = 14, last = c;
+            codes.push_back(uint8_t(((edge >> 2) << 4) | fec));
+            if (fec == 15)
+                encodeIndex(c, last), last = c;
+            if (fec == 0 || fec >= fecMax)
+                pushVertex(c);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+        else
+        {
+            const uint32_t  rotation = indices[i + 1] == next ? 1 : indices[i + 2] == next ? 2 : 0;
+            const uint32_t* order = kTriangleOrder[rotation];
+            const uint32_t  a = indices[i + order[0]], b = indices[i + order[1]], c = indices[i + order[2]];
+
+            const bool reset = a == 0 && b == 1 && c == 2 && next > 0;
+            if (reset)
+            {
+                next = 0;
+                std::fill(vertices, vertices + 16, ~0U);
+            }
+            const int fb = findVertex(b);
+            const int fc = findVertex(c);
+            const int fea = (a == next) ? (next++, 0) : 15;
+            const int feb = (fb >= 0 && fb < 14) ? fb + 1 : (b == next) ? (next++, 0) : 15;
+            const int fec = (fc >= 0 && fc < 14) ? fc + 1 : (c == next) ? (next++, 0) : 15;
+
+            const uint8_t codeaux = uint8_t((feb << 4) | fec);
+            const int     codeauxIndex = int(std::find(kCodeAuxTable, kCodeAuxTable + 14, codeaux) - kCodeAuxTable);
+            if (fea == 0 && codeauxIndex < 14 && !reset)
+                codes.push_back(uint8_t(0xF0 | codeauxIndex));
+            else
+            {
+                codes.push_back(uint8_t(0xF0 | 14 | fea));
+                data.push_back(codeaux);
+            }
+            if (fea == 15)
+                encodeIndex(a, last), last = a;
+            if (feb == 15)
+                encodeIndex(b, last), last = b;
+            if (fec == 15)
+                encodeIndex(c, last), last = c;
+            if (fea == 0 || fea == 15)
+                pushVertex(a);
+            if (feb == 0 || feb == 15)
+                pushVertex(b);
+            if (fec == 0 || fec == 15)
+                pushVertex(c);
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+    }
+
+    // Header, one code per triangle, the auxiliary data, and the codeaux table that ends the stream
+    std::vector<uint8_t> stream = { 0xE1 };
+    stream.insert(stream.end(), codes.begin(), codes.end());
+    stream.insert(stream.end(), data.begin(), data.end());
+    stream.insert(stream.end(), kCodeAuxTable, kCodeAuxTable + 16);
+    return stream;
+}
+
+// Triangles of a grid of `size` x `size` quads, in row order
+std::vector<uint32_t> makeGridTriangles(uint32_t size)
+{
+    std::vector<uint32_t> indices;
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            const uint32_t v = y * (size + 1) + x;
+            indices.insert(indices.end(), { v, v + 1, v + size + 1, v + 1, v + size + 2, v + size + 1 });
+        }
+    }
+    return indices;
+}
+
+// The encoder keeps the order of the triangles, each may be rotated to start with a recent edge or a new vertex
+bool checkMeshoptIndexRoundTrip(const std::string& name, std::span<const uint32_t> indices)
+{
+    const std::vector<uint8_t> stream = encodeMeshoptIndexBuffer(indices);
+    for (size_t indexSize : { size_t(2), size_t(4) })
+    {
+        std::vector<uint8_t> decoded(indices.size() * indexSize);
+        if (!nvsamples::decodeMeshoptIndexBuffer(decoded.data(), indices.size(), indexSize, stream))
+        {
+            fmt::print(stderr, "  {}: the {}-byte decoding failed\n", name, indexSize);
+            return false;
+        }
+        const auto index = [&](size_t i) -> uint32_t {
+            return indexSize == 2 ? reinterpret_cast<const uint16_t*>(decoded.data())[i] : reinterpret_cast<const uint32_t*>(decoded.data())[i];
+        };
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const uint32_t* triangle = &indices[i];
+            bool            match = false;
+            for (uint32_t rotation = 0; rotation < 3 && !match; rotation++)
+                match = index(i) == triangle[rotation] && index(i + 1) == triangle[(rotation + 1) % 3] && index(i + 2) == triangle[(rotation + 2) % 3];
+            if (!match)
+            {
+                fmt::print(stderr, "  {}: {}-byte triangle {} is {} {} {} instead of {} {} {}\n", name, indexSize, i / 3, index(i), index(i + 1),
+                           index(i + 2), triangle[0], triangle[1], triangle[2]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool checkMeshoptIndexCodec()
+{
+    bool ok = true;
+
+    // Free first vertices referencing the vertex FIFO (codes 0xFF with auxiliary FIFO indices), new first vertex with
+    // an auxiliary code missing from the table (0xFE), and a reset
+    const std::vector<uint32_t> fifoReferences = { 0, 1, 2, 5, 0, 1, 3, 0, 2, 6, 3, 1, 7, 5, 2, 0, 1, 2, 4, 3, 1 };
+    ok &= checkMeshoptIndexRoundTrip("fifo_references", fifoReferences);
+
+    // Codes of the first two triangles: 0, 1, 2 has three new vertices (0xF0, table entry 0x00), 5, 0, 1 has a free
+    // first vertex and two vertex FIFO references (0xFF, auxiliary code 0x32)
+    const std::vector<uint8_t> stream = encodeMeshoptIndexBuffer(std::span(fifoReferences).first(6));
+    if (stream.size() < 3 || stream[0] != 0xE1 || stream[1] != 0xF0 || stream[2] != 0xFF || stream[3] != 0x32)
+    {
+        fmt::print(stderr, "  fifo_references: the triangle with a free first vertex is not encoded with code 0xFF\n");
+        ok = false;
+    }
+
+    // Grid in row order: mostly edge FIFO hits
+    const std::vector<uint32_t> grid = makeGridTriangles(32);
+    ok &= checkMeshoptIndexRoundTrip("grid", grid);
+
+    // Shuffled grid triangles: free indices, vertex FIFO references and misses of all kinds
+    std::vector<uint32_t> shuffled = grid;
+    std::mt19937          random(7);
+    for (size_t i = shuffled.size() / 3 - 1; i > 0; i--)
+    {
+        const size_t j = random() % (i + 1);
+        std::swap_ranges(shuffled.begin() + i * 3, shuffled.begin() + i * 3 + 3, shuffled.begin() + j * 3);
+    }
+    ok &= checkMeshoptIndexRoundTrip("shuffled_grid", shuffled);
+
+    // Same, on a window of triangles small enough to stay in the FIFOs
+    std::vector<uint32_t> local(shuffled.begin(), shuffled.begin() + 3 * 64);
+    for (uint32_t& index : local)
+        index %= 24;
+    ok &= checkMeshoptIndexRoundTrip("local_window", local);
+
+    return ok;
+}
+
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Reference encoder of the EXT_meshopt_compression vertex codec (ATTRIBUTES mode): port of meshopt_encodeVertexBuffer
+// of meshoptimizer, version 0. Each group of 16 bytes takes the smallest of its 0, 2, 4 and 8 bit encodings, so a
+// stream of varied data uses all of them.
+//
+uint8_t zigzag8(uint8_t v)
+{
+    return uint8_t((v << 1) ^ uint8_t(int8_t(v) >> 7));
+}
+
+// Bytes of a group of 16 values encoded with 2^bitsLog2 bits per value (bitsLog2 0: all zero, 3: stored as is)
+size_t measureBytesGroup(const uint8_t* buffer, int bitsLog2)
+{
+    if (bitsLog2 == 0)
+        return std::all_of(buffer, buffer + 16, [](uint8_t v) { return v == 0; }) ? 0 : SIZE_MAX;
+    if (bitsLog2 == 3)
+        return 16;
+    const uint32_t bits = 1U << bitsLog2;
+    const uint32_t sentinel = (1U << bits) - 1U;
+    return bits * 2 + size_t(std::count_if(buffer, buffer + 16, [&](uint8_t v) { return v >= sentinel; }));
+}
+
+// Values MSB first, the ones that do not fit are a sentinel followed by the byte after the group
+void encodeBytesGroup(std::vector<uint8_t>& stream, const uint8_t* buffer, int bitsLog2)
+{
+    if (bitsLog2 == 0)
+        return;
+    if (bitsLog2 == 3)
+    {
+        stream.insert(stream.end(), buffer, buffer + 16);
+        return;
+    }
+    const uint32_t       bits = 1U << bitsLog2;
+    const uint32_t       sentinel = (1U << bits) - 1U;
+    std::vector<uint8_t> packed(bits * 2, 0);
+    std::vector<uint8_t> extra;
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        const uint32_t bitOffset = i * bits;
+        packed[bitOffset / 8] |= uint8_t(std::min<uint32_t>(buffer[i], sentinel) << (8 - bits - bitOffset % 8));
+        if (buffer[i] >= sentinel)
+            extra.push_back(buffer[i]);
+    }
+    stream.insert(stream.end(), packed.begin(), packed.end());
+    stream.insert(stream.end(), extra.begin(), extra.end());
+}
+
+std::vector<uint8_t> encodeMeshoptVertexBuffer(const void* vertices, size_t count, size_t byteStride)
+{
+    const uint8_t*       data = static_cast<const uint8_t*>(vertices);
+    std::vector<uint8_t> stream = { 0xA0 };
+    std::vector<uint8_t> lastVertex(data, data + byteStride);  // The first vertex is the reference of the first deltas
+
+    // Blocks of vertices, one byte stream per byte of the vertex: zigzag deltas from the previous vertex
+    const size_t blockSize = std::min<size_t>((8192 / byteStride) & ~size_t(15), 256);
+    for (size_t offset = 0; offset < count; offset += blockSize)
+    {
+        const size_t blockCount = std::min(blockSize, count - offset);
+        const size_t groupCount = (blockCount + 15) / 16;
+        for (size_t k = 0; k < byteStride; k++)
+        {
+            uint8_t buffer[256] = {};
+            uint8_t previous = lastVertex[k];
+            for (size_t i = 0; i < blockCount; i++)
+            {
+                const uint8_t value = data[(offset + i) * byteStride + k];
+                buffer[i] = zigzag8(uint8_t(value - previous));
+                previous = value;
+            }
+
+            // 2-bit mode of each group in a header, then the groups
+            const size_t headerOffset = stream.size();
+            stream.resize(stream.size() + (groupCount + 3) / 4, 0);
+            for (size_t group = 0; group < groupCount; group++)
+            {
+                int best = 3;
+                for (int bitsLog2 = 2; bitsLog2 >= 0; bitsLog2--)
+                    best = measureBytesGroup(buffer + group * 16, bitsLog2) <= measureBytesGroup(buffer + group * 16, best) ? bitsLog2 : best;
+                stream[headerOffset + group / 4] |= uint8_t(best << ((group % 4) * 2));
+                encodeBytesGroup(stream, buffer + group * 16, best);
+            }
+        }
+        lastVertex.assign(data + (offset + blockCount - 1) * byteStride, data + (offset + blockCount) * byteStride);
+    }
+
+    // Tail of at least 32 bytes, ending with the first vertex
+    stream.resize(stream.size() + std::max<size_t>(byteStride, 32) - byteStride, 0);
+    stream.insert(stream.end(), data, data + byteStride);
+    return stream;
+}
+
+bool checkMeshoptVertexRoundTrip(const std::string& name, const std::vector<uint8_t>& vertices, size_t byteStride)
+{
+    const size_t               count = vertices.size() / byteStride;
+    const std::vector<uint8_t> stream = encodeMeshoptVertexBuffer(vertices.data(), count, byteStride);
+    std::vector<uint8_t>       decoded(vertices.size());
+    if (!nvsamples::decodeMeshoptVertexBuffer(decoded.data(), count, byteStride, stream))
+    {
+        fmt::print(stderr, "  {}: the decoding failed\n", name);
+        return false;
+    }
+    const auto mismatch = std::mismatch(vertices.begin(), vertices.end(), decoded.begin());
+    if (mismatch.first != vertices.end())
+    {
+        const size_t offset = size_t(mismatch.first - vertices.begin());
+        fmt::print(stderr, "  {}: byte {} of vertex {} is {} instead of {}\n", name, offset % byteStride, offset / byteStride,
+                   *mismatch.second, *mismatch.first);
+        return false;
+    }
+
+    // A truncated stream is rejected
+    if (nvsamples::decodeMeshoptVertexBuffer(decoded.data(), count, byteStride, std::span(stream).first(stream.size() - 1)))
+    {
+        fmt::print(stderr, "  {}: the truncated stream is decoded\n", name);
+        return false;
+    }
+    return true;
+}
+
+bool checkMeshoptVertexCodec()
+{
+    bool         ok = true;
+    std::mt19937 random(11);
+
+    // Positions along a curve and a color: small deltas (2 and 4 bits), several blocks of 256 vertices
+    struct Vertex
+    {
+        float    position[3];
+        uint32_t color;
+    };
+    std::vector<uint8_t> curve(1000 * sizeof(Vertex));
+    for (size_t i = 0; i < 1000; i++)
+    {
+        const float  t = float(i) * 0.01F;
+        const Vertex vertex = { { std::cos(t), std::sin(t), t * 0.1F }, 0xFF000000U | uint32_t(i / 64) };
+        memcpy(curve.data() + i * sizeof(Vertex), &vertex, sizeof(Vertex));
+    }
+    ok &= checkMeshoptVertexRoundTrip("curve", curve, sizeof(Vertex));
+
+    // Constant data, only zero groups
+    ok &= checkMeshoptVertexRoundTrip("constant", std::vector<uint8_t>(4 * 300, 0x5A), 4);
+
+    // Random data in the largest stride, mostly bytes stored as is
+    std::vector<uint8_t> noise(256 * 40);
+    for (uint8_t& value : noise)
+        value = uint8_t(random());
+    ok &= checkMeshoptVertexRoundTrip("noise", noise, 256);
+
+    // A single vertex, shorter than a group
+    ok &= checkMeshoptVertexRoundTrip("single_vertex", { 1, 2, 3, 4, 5, 6, 7, 8 }, 8);
+
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Filters of the vertex codec, on values encoded as meshoptimizer's meshopt_encodeFilter* functions do.
+// Five elements: the SSE2 paths decode groups of 4, the scalar one the rest.
+//
+int quantizeSnorm(float v, int bits)
+{
+    const float scale = float((1 << (bits - 1)) - 1);
+    v = std::clamp(v, -1.0F, 1.0F) * scale;
+    return int(v + (v >= 0.0F ? 0.5F : -0.5F));
+}
+
+const glm::vec3 kFilterNormals[] = {
+    glm::vec3(0.0F, 0.0F, 1.0F),  glm::vec3(0.6F, -0.8F, 0.0F), glm::vec3(0.48F, 0.6F, -0.64F),
+    glm::vec3(-1.0F, 0.0F, 0.0F), glm::vec3(-0.36F, -0.48F, -0.8F),
+};
+
+// Octahedral normals of `bits` bits in 4 components, the 4th is kept
+template <typename T>
+bool checkOctahedralFilter(int bits)
+{
+    const std::string name = fmt::format("octahedral_{}", bits);
+    std::vector<T>    data;
+    for (const glm::vec3& n : kFilterNormals)
+    {
+        const float l = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        const float u = n.x / l;
+        const float v = n.y / l;
+        const float fu = n.z >= 0.0F ? u : (1.0F - std::abs(v)) * (u >= 0.0F ? 1.0F : -1.0F);
+        const float fv = n.z >= 0.0F ? v : (1.0F - std::abs(u)) * (v >= 0.0F ? 1.0F : -1.0F);
+        data.insert(data.end(), { T(quantizeSnorm(fu, bits)), T(quantizeSnorm(fv, bits)), T((1 << (bits - 1)) - 1), T(7) });
+    }
+
+    nvsamples::decodeMeshoptFilter(data.data(), std::size(kFilterNormals), 4 * sizeof(T), nvsamples::MeshoptFilter::eOctahedral);
+
+    const float maxValue = float((1 << (bits - 1)) - 1);
+    const float tolerance = bits == 8 ? 0.02F : 0.001F;
+    for (size_t i = 0; i < std::size(kFilterNormals); i++)
+    {
+        const glm::vec3 decoded = glm::vec3(float(data[i * 4 + 0]), float(data[i * 4 + 1]), float(data[i * 4 + 2])) / maxValue;
+        const glm::vec3 difference = decoded - kFilterNormals[i];
+        if (std::max({ std::abs(difference.x), std::abs(difference.y), std::abs(difference.z) }) > tolerance || data[i * 4 + 3] != 7)
+        {
+            fmt::print(stderr, "  {}: normal {} is decoded as {} {} {} (w {})\n", name, i, decoded.x, decoded.y, decoded.z, int(data[i * 4 + 3]));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkMeshoptFilters()
+{
+    bool ok = true;
+    ok &= checkOctahedralFilter<int8_t>(8);
+    ok &= checkOctahedralFilter<int16_t>(16);
+
+    // Quaternions: the 3 smallest components scaled by sqrt(2), the index of the largest in the low bits of the 4th
+    const glm::vec4 quaternions[] = {
+        glm::vec4(0.0F, 0.0F, 0.0F, 1.0F), glm::vec4(0.5F, -0.5F, 0.5F, -0.5F), glm::vec4(0.1F, 0.7F, -0.1F, 0.7F),
+        glm::vec4(-0.8F, 0.36F, 0.48F, 0.0F), glm::vec4(0.26F, 0.0F, -0.96F, 0.1F),
+    };
+    std::vector<int16_t> data;
+    for (glm::vec4 q : quaternions)
+    {
+        q /= glm::length(q);
+        int qc = 0;
+        for (int c = 1; c < 4; c++)
+            qc = std::abs(q[c]) > std::abs(q[qc]) ? c : qc;
+        const float scale = std::sqrt(2.0F) * (q[qc] < 0.0F ? -1.0F : 1.0F);
+        data.insert(data.end(), { int16_t(quantizeSnorm(q[(qc + 1) & 3] * scale, 16)), int16_t(quantizeSnorm(q[(qc + 2) & 3] * scale, 16)),
+                                  int16_t(quantizeSnorm(q[(qc + 3) & 3] * scale, 16)), int16_t((quantizeSnorm(1.0F, 16) & ~3) | qc) });
+    }
+    nvsamples::decodeMeshoptFilter(data.data(), std::size(quaternions), 8, nvsamples::MeshoptFilter::eQuaternion);
+    for (size_t i = 0; i < std::size(quaternions); i++)
+    {
+        // q and -q are the same rotation
+        const glm::vec4 decoded = glm::vec4(data[i * 4 + 0], data[i * 4 + 1], data[i * 4 + 2], data[i * 4 + 3]) / 32767.0F;
+        if (std::abs(glm::dot(decoded, quaternions[i] / glm::length(quaternions[i]))) < 0.9999F)
+        {
+            fmt::print(stderr, "  quaternion: {} is decoded as {} {} {} {}\n", i, decoded.x, decoded.y, decoded.z, decoded.w);
+            ok = false;
+        }
+    }
+
+    // Exponential: 24-bit signed mantissa, 8-bit signed exponent, decoded exactly
+    const std::pair<int32_t, int32_t> floats[] = { { 0, 0 }, { 1, 0 }, { -12345, -10 }, { 8388607, 3 }, { -3, -20 } };
+    std::vector<uint32_t>             encoded;
+    for (const auto& [mantissa, exponent] : floats)
+        encoded.push_back((uint32_t(exponent) << 24) | (uint32_t(mantissa) & 0xFFFFFF));
+    nvsamples::decodeMeshoptFilter(encoded.data(), std::size(floats), 4, nvsamples::MeshoptFilter::eExponential);
+    for (size_t i = 0; i < std::size(floats); i++)
+    {
+        float decoded;
+        memcpy(&decoded, &encoded[i], sizeof(decoded));
+        const float expected = std::ldexp(float(floats[i].first), floats[i].second);
+        if (decoded != expected)
+        {
+            fmt::print(stderr, "  exponential: {} is decoded as {} instead of {}\n", i, decoded, expected);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Mesh optimization: the reordering keeps every triangle, as it is (no rotation for the overdraw)
+//
+std::vector<std::array<uint32_t, 3>> sortedTriangles(std::span<const uint32_t> indices)
+{
+    std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++)
+        triangles[t] = { indices[t * 3 + 0], indices[t * 3 + 1], indices[t * 3 + 2] };
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+bool checkOverdrawKeepsTriangles(const std::string& name, std::vector<uint32_t> indices, std::span<const glm::vec3> positions)
+{
+    const std::vector<std::array<uint32_t, 3>> input = sortedTriangles(indices);
+    nvsamples::optimizeOverdraw(indices, positions);
+    if (sortedTriangles(indices) != input)
+    {
+        fmt::print(stderr, "  {}: the triangles after optimizeOverdraw differ from the input\n", name);
+        return false;
+    }
+    return true;
+}
+
+bool checkMeshOptimize()
+{
+    // Grid bent into a half cylinder, with clusters facing different directions
+    const uint32_t         gridSize = 32;
+    std::vector<glm::vec3> positions;
+    for (uint32_t y = 0; y <= gridSize; y++)
+    {
+        for (uint32_t x = 0; x <= gridSize; x++)
+        {
+            const float angle = float(x) / float(gridSize) * 3.14159265F;
+            positions.push_back(glm::vec3(std::cos(angle), std::sin(angle), float(y) / float(gridSize)));
+        }
+    }
+    const std::vector<uint32_t> grid = makeGridTriangles(gridSize);
+
+    bool ok = checkOverdrawKeepsTriangles("grid", grid, positions);
+
+    std::vector<uint32_t> optimized = grid;
+    nvsamples::optimizeVertexCache(optimized, positions.size());
+    if (sortedTriangles(optimized) != sortedTriangles(grid))
+    {
+        fmt::print(stderr, "  grid: the triangles after optimizeVertexCache differ from the input\n");
+        ok = false;
+    }
+    ok &= checkOverdrawKeepsTriangles("grid_vertex_cache", optimized, positions);
+
+    // A degenerate first triangle misses the cache less than 3 times, it must still start the first cluster
+    std::vector<uint32_t> degenerateFirst = optimized;
+    degenerateFirst.insert(degenerateFirst.begin(), { 0, 0, 1 });
+    ok &= checkOverdrawKeepsTriangles("degenerate_first_triangle", degenerateFirst, positions);
+
+    // Same, with the second triangle sharing the vertices of the first: no triangle with 3 misses at the start
+    std::vector<uint32_t> sharedStart = optimized;
+    sharedStart.insert(sharedStart.begin(), { 5, 5, 6, 5, 6, 7 });
+    ok &= checkOverdrawKeepsTriangles("shared_start", sharedStart, positions);
+
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Vertex quantization: a flat mesh keeps an invertible dequantization, and its positions are restored
+//
+bool checkPositionQuantization()
+{
+    // Plane at y = 2, flat along y
+    const std::vector<glm::vec3> positions = { glm::vec3(-1.0F, 2.0F, -3.0F), glm::vec3(1.0F, 2.0F, -3.0F), glm::vec3(1.0F, 2.0F, 3.0F),
+                                               glm::vec3(-1.0F, 2.0F, 3.0F) };
+    glm::vec3                    offset, scale;
+    nvsamples::computePositionQuantization(positions, offset, scale);
+    if (!(scale.x > 0.0F && scale.y > 0.0F && scale.z > 0.0F))
+    {
+        fmt::print(stderr, "  plane: the scale {} {} {} has a zero component\n", scale.x, scale.y, scale.z);
+        return false;
+    }
+
+    const std::vector<int16_t> encoded = nvsamples::encodePositionsSnorm16(positions, offset, scale);
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        const glm::vec3 decoded = offset + glm::vec3(encoded[i * 4 + 0], encoded[i * 4 + 1], encoded[i * 4 + 2]) / 32767.0F * scale;
+        if (glm::length(decoded - positions[i]) > 1e-3F)
+        {
+            fmt::print(stderr, "  plane: position {} decoded as {} {} {}\n", i, decoded.x, decoded.y, decoded.z);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Occlusion culling: a wall in front of the camera hides the boxes behind it, not the ones in front of it or beside
+// it, and the selection keeps the large and simple meshes as occluders
+//
+bool checkOcclusionCuller()
+{
+    // Camera at the origin looking down -Z, 90 degrees field of view, depth from 0 (near) to 1 (far)
+    const float nearPlane = 0.1F, farPlane = 100.0F;
+    glm::mat4   viewProj(0.0F);
+    viewProj[0][0] = 1.0F;
+    viewProj[1][1] = 1.0F;
+    viewProj[2][2] = farPlane / (nearPlane - farPlane);
+    viewProj[2][3] = -1.0F;
+    viewProj[3][2] = -(farPlane * nearPlane) / (farPlane - nearPlane);
+
+    // Wall at z = -5, covering the left half of the view (x from -10 to 0)
+    const std::vector<glm::vec3> wallPositions = { glm::vec3(-10.0F, -10.0F, -5.0F), glm::vec3(0.0F, -10.0F, -5.0F), glm::vec3(0.0F, 10.0F, -5.0F),
+                                                   glm::vec3(-10.0F, 10.0F, -5.0F) };
+    const std::vector<uint32_t>  wallIndices = { 0, 1, 2, 0, 2, 3 };
+
+    nvsamples::OcclusionCuller culler;
+    culler.init(64, 32, 1);
+    culler.beginFrame(viewProj);
+    culler.addOccluder(wallPositions, wallIndices, glm::mat4(1.0F));
+    culler.rasterize();
+
+    bool ok = true;
+    if (culler.getOccluderTriangleCount() != 2)
+    {
+        fmt::print(stderr, "  occlusion: {} occluder triangles queued instead of 2\n", culler.getOccluderTriangleCount());
+        ok = false;
+    }
+    const float wallDepth = culler.getDepth(culler.getWidth() / 4, culler.getHeight() / 2);
+    const float clearDepth = culler.getDepth(culler.getWidth() * 3 / 4, culler.getHeight() / 2);
+    if (!(wallDepth > 0.0F && wallDepth < 1.0F) || clearDepth != 1.0F)
+    {
+        fmt::print(stderr, "  occlusion: depth {} behind the wall and {} beside it\n", wallDepth, clearDepth);
+        ok = false;
+    }
+
+    const auto expectVisible = [&](const char* name, const glm::vec3& center, bool expected) {
+        const glm::vec3 halfSize(0.5F);
+        if (culler.isVisible(center - halfSize, center + halfSize, glm::mat4(1.0F)) != expected)
+        {
+            fmt::print(stderr, "  occlusion: the box {} is {}\n", name, expected ? "hidden" : "visible");
+            ok = false;
+        }
+    };
+    expectVisible("behind the wall", glm::vec3(-3.0F, 0.0F, -10.0F), false);
+    expectVisible("in front of the wall", glm::vec3(-1.5F, 0.0F, -3.0F), true);
+    expectVisible("beside the wall", glm::vec3(3.0F, 0.0F, -10.0F), true);
+    expectVisible("across the wall edge", glm::vec3(0.0F, 0.0F, -10.0F), true);
+
+    // Occluder selection: a large floor of 2 triangles, a large but detailed mesh, a small box and a mesh too
+    // expensive with its instances
+    const nvsamples::OccluderCandidate candidates[] = {
+        { .bboxMin = glm::vec3(-1.0F, 0.0F, -1.0F), .bboxMax = glm::vec3(1.0F, 1.0F, 1.0F), .triangleCount = 9128, .instanceCount = 1 },
+        { .bboxMin = glm::vec3(-10.0F, 0.0F, -10.0F), .bboxMax = glm::vec3(10.0F, 0.0F, 10.0F), .triangleCount = 2, .instanceCount = 1 },
+        { .bboxMin = glm::vec3(0.0F), .bboxMax = glm::vec3(0.1F), .triangleCount = 12, .instanceCount = 1 },
+        { .bboxMin = glm::vec3(-5.0F, 0.0F, -5.0F), .bboxMax = glm::vec3(5.0F, 3.0F, 5.0F), .triangleCount = 500, .instanceCount = 100 },
+        { .bboxMin = glm::vec3(-4.0F, 0.0F, 2.0F), .bboxMax = glm::vec3(4.0F, 4.0F, 2.5F), .triangleCount = 12, .instanceCount = 2 },
+    };
+    const std::vector<uint32_t> selected = nvsamples::selectOccluderMeshes(candidates, glm::vec3(-10.0F, 0.0F, -10.0F), glm::vec3(10.0F, 4.0F, 10.0F));
+    const std::vector<uint32_t> expected = { 1, 4 };  // Largest first
+    if (selected != expected)
+    {
+        fmt::print(stderr, "  occluder selection: {} meshes selected instead of the floor and the wall\n", selected.size());
+        ok = false;
+    }
+
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Simplification: the levels only use vertices of their input triangles, a flat grid keeps its outline without
+// flipping triangles, and each level of a chain is coarser than the previous one
+//
+// Vertices of a grid of `size` x `size` quads in the XZ plane, row by row, the height a bump of `bumpHeight`
+std::vector<glm::vec3> makeGridPositions(uint32_t size, float bumpHeight)
+{
+    std::vector<glm::vec3> positions;
+    for (uint32_t y = 0; y <= size; y++)
+    {
+        for (uint32_t x = 0; x <= size; x++)
+        {
+            const float u = float(x) / float(size);
+            const float v = float(y) / float(size);
+            positions.push_back(glm::vec3(u, bumpHeight * std::sin(u * 6.0F) * std::cos(v * 5.0F), v));
+        }
+    }
+    return positions;
+}
+
+// Every index refers to a vertex, and no triangle has the same vertex twice
+bool checkTriangles(const std::string& name, std::span<const uint32_t> indices, size_t vertexCount)
+{
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+        if (a >= vertexCount || b >= vertexCount || c >= vertexCount || a == b || b == c || a == c)
+        {
+            fmt::print(stderr, "  {}: triangle {} is {} {} {} ({} vertices)\n", name, i / 3, a, b, c, vertexCount);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool checkSimplifyUnusedVertices()
+{
+    // Flat grid whose vertices follow an unused copy of themselves in the position array
+    const uint32_t         gridSize = 16;
+    std::vector<glm::vec3> positions = makeGridPositions(gridSize, 0.0F);
+    const uint32_t         gridVertexCount = uint32_t(positions.size());
+    positions.insert(positions.end(), positions.begin(), positions.end());
+    std::vector<uint32_t> indices = makeGridTriangles(gridSize);
+    for (uint32_t& index : indices)
+        index += gridVertexCount;
+
+    bool ok = true;
+    const std::vector<nvsamples::MeshLod> lods = nvsamples::generateMeshLods(indices, positions, {});
+    if (lods.empty())
+    {
+        fmt::print(stderr, "  unused_duplicates: no level of detail generated\n");
+        ok = false;
+    }
+    for (size_t level = 0; level < lods.size(); level++)
+    {
+        for (uint32_t index : lods[level].indices)
+        {
+            if (index < gridVertexCount)
+            {
+                fmt::print(stderr, "  unused_duplicates: LOD {} uses vertex {}, absent from the input triangles\n", level + 1, index);
+                ok = false;
+                break;
+            }
+        }
+    }
+    return ok;
+}
+
+bool checkSimplifyFlatGrid()
+{
+    // The interior of a flat grid collapses at no cost, its border vertices stay: the area is kept and all the
+    // triangles face the same way as before (-Y with the winding of makeGridTriangles)
+    const uint32_t               gridSize = 16;
+    const std::vector<glm::vec3> positions = makeGridPositions(gridSize, 0.0F);
+    const std::vector<uint32_t>  indices = makeGridTriangles(gridSize);
+    float                        error = -1.0F;
+    const std::vector<uint32_t>  simplified = nvsamples::simplifyMesh(indices, positions, {}, 0, 1e-4F, &error);
+    if (!checkTriangles("flat_grid", simplified, positions.size()))
+        return false;
+
+    bool ok = true;
+    if (simplified.size() * 4 > indices.size())
+    {
+        fmt::print(stderr, "  flat_grid: {} of {} triangles left\n", simplified.size() / 3, indices.size() / 3);
+        ok = false;
+    }
+    if (error < 0.0F || error > 1e-4F)
+    {
+        fmt::print(stderr, "  flat_grid: error {} outside of [0, 1e-4]\n", error);
+        ok = false;
+    }
+    float area = 0.0F;
+    for (size_t i = 0; i < simplified.size(); i += 3)
+    {
+        const glm::vec3& p0 = positions[simplified[i]];
+        const glm::vec3  normal = glm::cross(positions[simplified[i + 1]] - p0, positions[simplified[i + 2]] - p0);
+        area += glm::length(normal) * 0.5F;
+        if (normal.y >= 0.0F)
+        {
+            fmt::print(stderr, "  flat_grid: triangle {} is flipped or degenerate\n", i / 3);
+            ok = false;
+            break;
+        }
+    }
+    if (std::abs(area - 1.0F) > 1e-3F)
+    {
+        fmt::print(stderr, "  flat_grid: area {} instead of 1, the outline moved\n", area);
+        ok = false;
+    }
+    return ok;
+}
+
+bool checkSimplifyTarget()
+{
+    // A bumpy grid reaches the index count target when the error is not limited
+    const uint32_t               gridSize = 32;
+    const std::vector<glm::vec3> positions = makeGridPositions(gridSize, 0.1F);
+    const std::vector<uint32_t>  indices = makeGridTriangles(gridSize);
+    const size_t                 target = indices.size() / 4;
+    float                        error = -1.0F;
+    const std::vector<uint32_t>  simplified = nvsamples::simplifyMesh(indices, positions, {}, target, FLT_MAX, &error);
+    if (!checkTriangles("bumpy_target", simplified, positions.size()))
+        return false;
+    if (simplified.size() > target || simplified.size() < target / 2 || error <= 0.0F)
+    {
+        fmt::print(stderr, "  bumpy_target: {} indices for a target of {}, error {}\n", simplified.size(), target, error);
+        return false;
+    }
+    return true;
+}
+
+bool checkLodChain()
+{
+    // Each level has fewer triangles than the previous one, and an error at least as large
+    const uint32_t                        gridSize = 32;
+    const std::vector<glm::vec3>          positions = makeGridPositions(gridSize, 0.1F);
+    const std::vector<uint32_t>           indices = makeGridTriangles(gridSize);
+    const std::vector<nvsamples::MeshLod> lods = nvsamples::generateMeshLods(indices, positions, {}, 4, 0.5F);
+    if (lods.size() < 2)
+    {
+        fmt::print(stderr, "  lod_chain: {} levels of detail\n", lods.size());
+        return false;
+    }
+
+    size_t previousCount = indices.size();
+    float  previousError = 0.0F;
+    for (size_t level = 0; level < lods.size(); level++)
+    {
+        const nvsamples::MeshLod& lod = lods[level];
+        if (!checkTriangles(fmt::format("lod_chain LOD {}", level + 1), lod.indices, positions.size()))
+            return false;
+        if (lod.indices.empty() || lod.indices.size() >= previousCount || lod.error < previousError)
+        {
+            fmt::print(stderr, "  lod_chain: LOD {} has {} indices and error {}, after {} and {}\n", level + 1, lod.indices.size(), lod.error,
+                       previousCount, previousError);
+            return false;
+        }
+        previousCount = lod.indices.size();
+        previousError = lod.error;
+    }
+    return true;
+}
+
+bool checkMeshSimplify()
+{
+    bool ok = true;
+    ok &= checkSimplifyUnusedVertices();
+    ok &= checkSimplifyFlatGrid();
+    ok &= checkSimplifyTarget();
+    ok &= checkLodChain();
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Meshlets: within the limits of the mesh shader, covering every triangle once, with bounds holding their vertices
+//
+bool checkMeshlets()
+{
+    const uint32_t               gridSize = 24;
+    const std::vector<glm::vec3> positions = makeGridPositions(gridSize, 0.0F);
+    const std::vector<uint32_t>  indices = makeGridTriangles(gridSize);
+    const nvsamples::MeshletMesh mesh = nvsamples::buildMeshlets(indices, positions);
+
+    bool                  ok = true;
+    std::vector<uint32_t> meshletIndices;
+    for (size_t m = 0; m < mesh.meshlets.size() && ok; m++)
+    {
+        const nvsamples::Meshlet& meshlet = mesh.meshlets[m];
+        if (meshlet.vertexCount == 0 || meshlet.vertexCount > nvsamples::kMeshletMaxVertices || meshlet.triangleCount == 0
+            || meshlet.triangleCount > nvsamples::kMeshletMaxTriangles || meshlet.vertexOffset + meshlet.vertexCount > mesh.vertices.size()
+            || (meshlet.triangleOffset + meshlet.triangleCount) * 3 > mesh.triangles.size())
+        {
+            fmt::print(stderr, "  meshlets: meshlet {} has {} vertices and {} triangles, or its ranges are out of the mesh\n", m,
+                       meshlet.vertexCount, meshlet.triangleCount);
+            ok = false;
+            break;
+        }
+
+        const std::span<const uint32_t> vertices(mesh.vertices.data() + meshlet.vertexOffset, meshlet.vertexCount);
+        for (uint32_t i = 0; i < meshlet.triangleCount * 3; i++)
+        {
+            const uint8_t local = mesh.triangles[meshlet.triangleOffset * 3 + i];
+            if (local >= meshlet.vertexCount)
+            {
+                fmt::print(stderr, "  meshlets: meshlet {} uses local vertex {} of {}\n", m, local, meshlet.vertexCount);
+                ok = false;
+                break;
+            }
+            meshletIndices.push_back(vertices[local]);
+        }
+        for (uint32_t v : vertices)
+        {
+            if (glm::length(positions[v] - meshlet.bounds.center) > meshlet.bounds.radius * 1.0001F + 1e-6F)
+            {
+                fmt::print(stderr, "  meshlets: vertex {} is outside of the bounding sphere of meshlet {}\n", v, m);
+                ok = false;
+                break;
+            }
+        }
+
+        // Flat meshlets facing -Y: culled as backfacing from above, not from below
+        const glm::vec3 center = meshlet.bounds.center;
+        if (!nvsamples::isMeshletBackfacing(meshlet.bounds, center + glm::vec3(0.0F, 5.0F, 0.0F))
+            || nvsamples::isMeshletBackfacing(meshlet.bounds, center - glm::vec3(0.0F, 5.0F, 0.0F)))
+        {
+            fmt::print(stderr, "  meshlets: wrong normal cone test of meshlet {}\n", m);
+            ok = false;
+        }
+    }
+    if (ok && sortedTriangles(meshletIndices) != sortedTriangles(indices))
+    {
+        fmt::print(stderr, "  meshlets: the meshlets do not hold the triangles of the mesh once each\n");
+        ok = false;
+    }
+
+    // Frustum of an identity view-projection: x and y in [-1, 1], depth in [0, 1]
+    const std::array<glm::vec4, 6> planes = nvsamples::extractFrustumPlanes(glm::mat4(1.0F));
+    if (nvsamples::isSphereOutsideFrustum(planes, glm::vec3(0.0F, 0.0F, 0.5F), 0.1F)
+        || nvsamples::isSphereOutsideFrustum(planes, glm::vec3(1.05F, 0.0F, 0.5F), 0.1F)
+        || !nvsamples::isSphereOutsideFrustum(planes, glm::vec3(3.0F, 0.0F, 0.5F), 0.1F)
+        || !nvsamples::isSphereOutsideFrustum(planes, glm::vec3(0.0F, 0.0F, -0.5F), 0.1F))
+    {
+        fmt::print(stderr, "  meshlets: wrong frustum test\n");
+        ok = false;
+    }
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Mesh geometry prepared at import: the full resolution mesh and its levels of detail only index the vertices
+// written for the mesh, also when the POSITION accessor holds vertices the primitive does not use
+//
+// Grid of `gridSize` x `gridSize` quads, the POSITION accessor starts with an unused copy of the grid vertices: the
+// used vertices are duplicates of unused ones with the same position
+tinygltf::Model makeGridGltfWithUnusedVertices(uint32_t gridSize)
+{
+    std::vector<glm::vec3> positions;
+    for (uint32_t y = 0; y <= gridSize; y++)
+        for (uint32_t x = 0; x <= gridSize; x++)
+            positions.push_back(glm::vec3(float(x) / float(gridSize), 0.0F, float(y) / float(gridSize)));
+    const uint32_t gridVertexCount = uint32_t(positions.size());
+    positions.insert(positions.end(), positions.begin(), positions.end());
+    std::vector<uint32_t> indices = makeGridTriangles(gridSize);
+    for (uint32_t& index : indices)
+        index += gridVertexCount;
+
+    tinygltf::Model model;
+    model.buffers.resize(1);
+    std::vector<unsigned char>& data = model.buffers[0].data;
+    data.resize(positions.size() * sizeof(glm::vec3) + indices.size() * sizeof(uint32_t));
+    memcpy(data.data(), positions.data(), positions.size() * sizeof(glm::vec3));
+    memcpy(data.data() + positions.size() * sizeof(glm::vec3), indices.data(), indices.size() * sizeof(uint32_t));
+
+    tinygltf::BufferView positionView;
+    positionView.buffer = 0;
+    positionView.byteLength = positions.size() * sizeof(glm::vec3);
+    tinygltf::BufferView indexView;
+    indexView.buffer = 0;
+    indexView.byteOffset = positionView.byteLength;
+    indexView.byteLength = indices.size() * sizeof(uint32_t);
+    model.bufferViews = { positionView, indexView };
+
+    tinygltf::Accessor positionAccessor;
+    positionAccessor.bufferView = 0;
+    positionAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+    positionAccessor.count = positions.size();
+    positionAccessor.type = TINYGLTF_TYPE_VEC3;
+    positionAccessor.minValues = { 0.0, 0.0, 0.0 };
+    positionAccessor.maxValues = { 1.0, 0.0, 1.0 };
+    tinygltf::Accessor indexAccessor;
+    indexAccessor.bufferView = 1;
+    indexAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+    indexAccessor.count = indices.size();
+    indexAccessor.type = TINYGLTF_TYPE_SCALAR;
+    model.accessors = { positionAccessor, indexAccessor };
+
+    tinygltf::Primitive primitive;
+    primitive.mode = TINYGLTF_MODE_TRIANGLES;
+    primitive.indices = 1;
+    primitive.attributes["POSITION"] = 0;
+    tinygltf::Mesh mesh;
+    mesh.primitives.push_back(primitive);
+    model.meshes.push_back(mesh);
+    return model;
+}
+
+bool checkGltfMeshGeometry()
+{
+    const tinygltf::Model model = makeGridGltfWithUnusedVertices(16);
+    bool                  ok = true;
+
+    const nvsamples::GltfImportSettings settings{ .generateLods = true, .optimizeMeshes = true };
+    const nvsamples::GltfMeshGeometry   geometry = nvsamples::prepareGltfMeshGeometry(model, 0, settings);
+    if (geometry.lods.empty())
+    {
+        fmt::print(stderr, "  gltf_lods: no level of detail generated\n");
+        ok = false;
+    }
+
+    // Every index of every list addresses the written vertices (the ones mapped by remap)
+    const size_t mappedCount = std::count_if(geometry.remap.begin(), geometry.remap.end(), [](uint32_t r) { return r != ~0U; });
+    if (mappedCount != geometry.positions.size())
+    {
+        fmt::print(stderr, "  gltf_lods: {} vertices mapped for {} positions\n", mappedCount, geometry.positions.size());
+        ok = false;
+    }
+    const auto checkRange = [&](const char* name, std::span<const uint32_t> indices) {
+        for (uint32_t index : indices)
+        {
+            if (index >= geometry.positions.size())
+            {
+                fmt::print(stderr, "  gltf_lods: {} index {} out of the {} vertices\n", name, index, geometry.positions.size());
+                ok = false;
+                return;
+            }
+        }
+    };
+    checkRange("LOD 0", geometry.indices);
+    for (const nvsamples::MeshLod& lod : geometry.lods)
+        checkRange("LOD n", lod.indices);
+
+    return ok;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Instance batching: after any sequence of changes, each instance is in the one batch of its mesh and material, and
+// no batch is empty or duplicated
+//
+bool checkDrawBatcher()
+{
+    constexpr uint32_t                         kNone = ~0U;
+    nvsamples::DrawBatcher                     batcher;
+    std::vector<std::pair<uint32_t, uint32_t>> expected(64, { kNone, kNone });  // Mesh and material of each instance
+    std::mt19937                               random(5);
+
+    for (uint32_t step = 1; step <= 2000; step++)
+    {
+        const uint32_t instance = random() % uint32_t(expected.size());
+        const uint32_t operation = random() % 16;
+        if (operation == 0)
+        {
+            batcher.removeInstance(instance);
+            expected[instance] = { kNone, kNone };
+        }
+        else if (operation == 1)
+        {
+            batcher.resize(instance);
+            for (uint32_t i = instance; i < expected.size(); i++)
+                expected[i] = { kNone, kNone };
+        }
+        else
+        {
+            const uint32_t meshIndex = random() % 4;
+            const uint32_t materialIndex = random() % 3;
+            batcher.setInstance(instance, meshIndex, materialIndex);
+            expected[instance] = { meshIndex, materialIndex };
+        }
+
+        if (step % 50 != 0)
+            continue;
+        std::vector<uint32_t>                      found(expected.size(), 0);
+        std::vector<std::pair<uint32_t, uint32_t>> keys;
+        for (const nvsamples::DrawBatch& batch : batcher.getBatches())
+        {
+            keys.emplace_back(batch.meshIndex, batch.materialIndex);
+            if (batch.instances.empty())
+            {
+                fmt::print(stderr, "  draw_batcher: step {}, empty batch of mesh {} material {}\n", step, batch.meshIndex, batch.materialIndex);
+                return false;
+            }
+            for (uint32_t i : batch.instances)
+            {
+                if (i >= expected.size() || expected[i] != std::make_pair(batch.meshIndex, batch.materialIndex) || found[i]++ > 0)
+                {
+                    fmt::print(stderr, "  draw_batcher: step {}, instance {} is wrongly in the batch of mesh {} material {}\n", step, i,
+                               batch.meshIndex, batch.materialIndex);
+                    return false;
+                }
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        if (std::adjacent_find(keys.begin(), keys.end()) != keys.end())
+        {
+            fmt::print(stderr, "  draw_batcher: step {}, two batches share a mesh and a material\n", step);
+            return false;
+        }
+        for (uint32_t i = 0; i < expected.size(); i++)
+        {
+            if (expected[i].first != kNone && found[i] == 0)
+            {
+                fmt::print(stderr, "  draw_batcher: step {}, instance {} is in no batch\n", step, i);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Job system: parallelFor covers its range once, dependent jobs run in order, and the jobs scheduled by running jobs
+// are waited for
+//
+bool checkJobSystem()
+{
+    bool                 ok = true;
+    nvsamples::JobSystem jobs(3);
+
+    for (uint32_t count : { 0U, 1U, 100U, 10000U })
+    {
+        for (uint32_t grainSize : { 1U, 7U, 256U })
+        {
+            std::vector<std::atomic<uint32_t>> hits(count);
+            std::atomic<bool>                  rangeTooLarge{ false };
+            jobs.parallelFor(count, grainSize, [&](uint32_t begin, uint32_t end) {
+                rangeTooLarge = rangeTooLarge || end - begin > grainSize;
+                for (uint32_t i = begin; i < end; i++)
+                    hits[i].fetch_add(1, std::memory_order_relaxed);
+            });
+            const auto wrongHit = std::find_if(hits.begin(), hits.end(), [](const std::atomic<uint32_t>& hit) { return hit != 1; });
+            if (wrongHit != hits.end() || rangeTooLarge)
+            {
+                fmt::print(stderr, "  parallel_for: count {} grain size {}, item {} is run {} times{}\n", count, grainSize,
+                           wrongHit - hits.begin(), wrongHit != hits.end() ? wrongHit->load() : 1U, rangeTooLarge ? ", a range is too large" : "");
+                ok = false;
+            }
+        }
+    }
+
+    // A chain of jobs, each scheduled after the previous one
+    std::vector<uint32_t>                               order;
+    std::vector<std::unique_ptr<nvsamples::JobCounter>> counters;
+    for (uint32_t i = 0; i < 64; i++)
+    {
+        counters.push_back(std::make_unique<nvsamples::JobCounter>());
+        auto job = [&order, i] { order.push_back(i); };
+        if (i == 0)
+            jobs.schedule(job, counters.back().get());
+        else
+            jobs.scheduleAfter(*counters[i - 1], job, counters.back().get());
+    }
+    jobs.wait(*counters.back());
+    std::vector<uint32_t> expectedOrder(64);
+    std::iota(expectedOrder.begin(), expectedOrder.end(), 0U);
+    if (order != expectedOrder)
+    {
+        fmt::print(stderr, "  dependencies: the {} jobs of the chain did not run in order\n", order.size());
+        ok = false;
+    }
+
+    // Jobs scheduling jobs on the counter being waited for
+    nvsamples::JobCounter counter;
+    std::atomic<uint32_t> done{ 0 };
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        jobs.schedule(
+            [&] {
+                for (uint32_t j = 0; j < 16; j++)
+                    jobs.schedule([&] { done++; }, &counter);
+                done++;
+            },
+            &counter);
+    }
+    jobs.wait(counter);
+    if (done != 16 * 17)
+    {
+        fmt::print(stderr, "  nested_jobs: {} of {} jobs done when the wait returned\n", done.load(), 16 * 17);
+        ok = false;
+    }
+    return ok;
+}
+}  // namespace
+
+
+//---------------------------------------------------------------------------------------------------------------
+// The main function, runs the checks whose name contains the first argument (all without argument)
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+
+    const Check checks[] = {
+        { "meshopt_index_codec", checkMeshoptIndexCodec },
+        { "meshopt_vertex_codec", checkMeshoptVertexCodec },
+        { "meshopt_filters", checkMeshoptFilters },
+        { "mesh_optimize", checkMeshOptimize },
+        { "mesh_simplify", checkMeshSimplify },
+        { "meshlets", checkMeshlets },
+        { "position_quantization", checkPositionQuantization },
+        { "occlusion_culler", checkOcclusionCuller },
+        { "gltf_mesh_geometry", checkGltfMeshGeometry },
+        { "draw_batcher", checkDrawBatcher },
+        { "job_system", checkJobSystem },
+    };
+
+    uint32_t failures = 0;
+    for (const Check& check : checks)
+    {
+        if (check.name.find(filter) == std::string::npos)
+            continue;
+        const bool ok = check.run();
+        fmt::print("{:<40} {}\n", check.name, ok ? "ok" : "FAILED");
+        failures += ok ? 0 : 1;
+    }
+    return failures > 0 ? 1 : 0;
+}
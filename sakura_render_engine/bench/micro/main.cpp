@@ -0,0 +1,364 @@
+#include <sakura.h>
+#include "common/gltf_utils.hpp"
+#include "common/gltf_synthetic.hpp"
+#include "common/path_utils.hpp"
+#include "tinygltf/json.hpp"  // nlohmann::json, shipped with tinygltf
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+
+#include <fmt/format.h>
+#include <nvutils/file_operations.hpp>
+#include <nvutils/primitives.hpp>
+#include <nvvk/resource_allocator.hpp>
+#include <nvvk/staging.hpp>
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Micro-benchmarks of the scene loading path: glTF parsing (loadGltfResources), import (importGltfData, with and
+// without the instances), primitive meshes (primitiveMeshToResource) and image decoding (decodeGltfImages).
+//
+// The assets of resources/ are measured as they are, the synthetic models (gltf_synthetic.hpp) scale the node
+// count, the mesh count and the buffer sizes. No command is submitted: the uploads are appended to the staging
+// uploader and dropped, so the Vulkan device is only used for the buffer allocations and any device works,
+// e.g. lavapipe on machines without GPU:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json sakura_microbench --filter import
+//
+// Each benchmark runs enough iterations to last --minTime seconds per repetition, the reported time is the median
+// of the repetitions. With --baseline, the exit code is 2 when a benchmark is slower than the baseline by more than
+// the tolerance.
+
+namespace {
+
+struct MicroBenchmark
+{
+    std::string           name;
+    std::function<void()> setup;  // Not measured, called once before the runs (e.g. loading the input)
+    std::function<void()> run;    // Measured
+    std::function<void()> reset;  // Not measured, called after each run (e.g. freeing what the run created)
+};
+
+struct MicroBenchmarkResult
+{
+    std::string name;
+    uint64_t    iterations = 0;  // Per repetition
+    double      medianNs = 0.0;  // Per iteration
+    double      minNs = 0.0;
+    double      maxNs = 0.0;
+};
+
+MicroBenchmarkResult runMicroBenchmark(const MicroBenchmark& benchmark, double minTime, uint32_t repetitions)
+{
+    if (benchmark.setup)
+        benchmark.setup();
+
+    // Time of one iteration, to size the repetitions
+    double firstTime = 0.0;
+    {
+        nvutils::PerformanceTimer timer;
+        benchmark.run();
+        firstTime = timer.getSeconds();
+        if (benchmark.reset)
+            benchmark.reset();
+    }
+    const uint64_t iterations = std::max<uint64_t>(1, uint64_t(minTime / std::max(firstTime, 1e-9)));
+
+    std::vector<double> samples;
+    for (uint32_t repetition = 0; repetition < repetitions; repetition++)
+    {
+        double time = 0.0;
+        for (uint64_t i = 0; i < iterations; i++)
+        {
+            nvutils::PerformanceTimer timer;
+            benchmark.run();
+            time += timer.getMicroseconds();
+            if (benchmark.reset)
+                benchmark.reset();
+        }
+        samples.push_back(time * 1000.0 / double(iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+    return { .name = benchmark.name, .iterations = iterations, .medianNs = samples[samples.size() / 2], .minNs = samples.front(), .maxNs = samples.back() };
+}
+
+std::string formatTime(double ns)
+{
+    if (ns >= 1e6)
+        return fmt::format("{:.3f} ms", ns * 1e-6);
+    if (ns >= 1e3)
+        return fmt::format("{:.3f} us", ns * 1e-3);
+    return fmt::format("{:.0f} ns", ns);
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Vulkan objects needed by the import functions, and the scene the benchmarks import into
+//
+class ImportContext
+{
+public:
+    bool init(const nvvk::Context& context)
+    {
+        VmaAllocatorCreateInfo allocatorInfo = {
+            .flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT,
+            .physicalDevice = context.getPhysicalDevice(),
+            .device = context.getDevice(),
+            .instance = context.getInstance(),
+            .vulkanApiVersion = VK_API_VERSION_1_4,
+        };
+        if (m_allocator.init(allocatorInfo) != VK_SUCCESS)
+            return false;
+        m_stagingUploader.init(&m_allocator, true);
+        return true;
+    }
+
+    void deinit()
+    {
+        clearScene();
+        m_stagingUploader.deinit();
+        m_allocator.deinit();
+    }
+
+    // Destroy what the import created, the appended uploads are never executed
+    void clearScene()
+    {
+        m_stagingUploader.cancelAppended();
+        m_stagingUploader.releaseStaging(true);
+        for (nvvk::Buffer& buffer : m_scene.bGltfDatas)
+            m_allocator.destroyBuffer(buffer);
+        m_scene = {};
+    }
+
+    nvsamples::GltfSceneResource& getScene() { return m_scene; }
+    nvvk::StagingUploader&        getStagingUploader() { return m_stagingUploader; }
+
+private:
+    nvvk::ResourceAllocator      m_allocator;
+    nvvk::StagingUploader        m_stagingUploader;
+    nvsamples::GltfSceneResource m_scene;
+};
+
+}  // namespace
+
+
+//---------------------------------------------------------------------------------------------------------------
+// The main function, entry point of the micro-benchmarks
+int main(int argc, char** argv)
+{
+    std::string           filter;
+    std::filesystem::path outputFile = nvutils::getExecutablePath().replace_extension(".json");
+    std::filesystem::path baselineFile;
+    float                 minTime = 0.5F;
+    uint32_t              repetitions = 5;
+    float                 tolerance = 0.1F;
+    bool                  list = false;
+
+    nvutils::ParameterParser   cli(nvutils::getExecutablePath().stem().string());
+    nvutils::ParameterRegistry reg;
+    reg.add({ "filter", "Run the benchmarks whose name contains this string" }, &filter);
+    reg.add({ "output", "JSON file of the results" }, &outputFile);
+    reg.add({ "baseline", "JSON results to compare to, the exit code is 2 on a regression" }, &baselineFile);
+    reg.add({ "minTime", "Minimum duration of a repetition, in seconds" }, &minTime);
+    reg.add({ "repetitions", "Number of repetitions, the median is reported" }, &repetitions);
+    reg.add({ "tolerance", "Relative increase of a time reported as a regression" }, &tolerance);
+    reg.add({ "list", "List the benchmarks and exit" }, &list, true);
+    cli.add(reg);
+    cli.parse(argc, argv);
+    repetitions = std::max(repetitions, 1U);
+
+    // Device for the buffer allocations only, no queue is used
+    nvvk::ContextInitInfo vkSetup{};
+    vkSetup.enableValidationLayers = false;
+    nvvk::Context vkContext;
+    if (vkContext.init(vkSetup) != VK_SUCCESS)
+    {
+        LOGE("Error in Vulkan context creation\n");
+        return 1;
+    }
+    ImportContext importContext;
+    if (!importContext.init(vkContext))
+    {
+        LOGE("Error in the allocator creation\n");
+        return 1;
+    }
+
+    // Assets, and synthetic models written as .glb to measure their parsing too
+    std::vector<std::pair<std::string, std::filesystem::path>> modelFiles;
+    for (const char* asset : { "teapot.gltf", "plane.gltf", "sphere.gltf", "cubeTextured.gltf", "shader_ball.gltf", "meet_mat.glb", "wuson.glb" })
+    {
+        const std::filesystem::path filename = nvutils::findFile(asset, nvsamples::getResourcesDirs());
+        if (!filename.empty())
+            modelFiles.push_back({ std::filesystem::path(asset).stem().string(), filename });
+    }
+
+    const nvsamples::SyntheticGltfSettings syntheticModels[] = {
+        { .nodeCount = 1, .meshCount = 1, .gridSize = 512 },      // Buffer size: 262k vertices
+        { .nodeCount = 1, .meshCount = 1, .gridSize = 1024 },     //              1M vertices
+        { .nodeCount = 1, .meshCount = 64, .gridSize = 32 },      // Mesh (primitive) count
+        { .nodeCount = 1, .meshCount = 1024, .gridSize = 8 },     //
+        { .nodeCount = 1024, .meshCount = 16, .gridSize = 8 },    // Node count
+        { .nodeCount = 16384, .meshCount = 16, .gridSize = 8 },   //
+    };
+    const std::filesystem::path syntheticDir = std::filesystem::temp_directory_path() / "sakura_microbench";
+    std::filesystem::create_directories(syntheticDir);
+    for (const nvsamples::SyntheticGltfSettings& settings : syntheticModels)
+    {
+        const std::string name = fmt::format("synthetic_n{}_m{}_g{}", settings.nodeCount, settings.meshCount, settings.gridSize);
+        const std::filesystem::path filename = syntheticDir / (name + ".glb");
+        tinygltf::Model model = nvsamples::makeSyntheticGltf(settings);
+        tinygltf::TinyGLTF writer;
+        if (writer.WriteGltfSceneToFile(&model, filename.string(), true, true, false, true))
+            modelFiles.push_back({ name, filename });
+        else
+            LOGW("Could not write %s\n", nvutils::utf8FromPath(filename).c_str());
+    }
+
+    // The benchmarks
+    const nvsamples::GltfImportSettings importSettingsFull{ .generateLods = true, .optimizeMeshes = true, .buildMeshlets = true, .quantizeVertices = true };
+    std::vector<std::unique_ptr<tinygltf::Model>> models(modelFiles.size());  // Loaded by the first import benchmark
+    std::vector<MicroBenchmark>                   benchmarks;
+    auto add = [&](MicroBenchmark benchmark) {
+        if (benchmark.name.find(filter) != std::string::npos)
+            benchmarks.push_back(std::move(benchmark));
+    };
+
+    const auto clearScene = [&importContext] { importContext.clearScene(); };
+    for (size_t i = 0; i < modelFiles.size(); i++)
+    {
+        const std::string&          name = modelFiles[i].first;
+        const std::filesystem::path filename = modelFiles[i].second;
+        const auto loadModel = [&models, i, filename] {
+            if (!models[i])
+                models[i] = std::make_unique<tinygltf::Model>(nvsamples::loadGltfResources(filename));
+        };
+        const auto importModel = [&models, &importContext, i](bool importInstance, const nvsamples::GltfImportSettings& settings) {
+            nvsamples::importGltfData(importContext.getScene(), *models[i], importContext.getStagingUploader(), importInstance, settings);
+        };
+
+        add({ .name = "load/" + name, .run = [filename] { nvsamples::loadGltfResources(filename); } });
+        add({ .name = "import/" + name, .setup = loadModel, .run = [=] { importModel(false, {}); }, .reset = clearScene });
+        add({ .name = "import_instances/" + name, .setup = loadModel, .run = [=] { importModel(true, {}); }, .reset = clearScene });
+        add({ .name = "import_full/" + name, .setup = loadModel, .run = [=] { importModel(true, importSettingsFull); }, .reset = clearScene });
+    }
+
+    const std::pair<std::string, nvutils::PrimitiveMesh> primitiveMeshes[] = {
+        { "cube", nvutils::createCube() },
+        { "sphere_64", nvutils::createSphereUv(0.5F, 64, 64) },
+        { "sphere_512", nvutils::createSphereUv(0.5F, 512, 512) },
+        { "plane_1024", nvutils::createPlane(1024) },
+    };
+    for (const auto& primitive : primitiveMeshes)
+    {
+        const nvutils::PrimitiveMesh& primitiveMesh = primitive.second;
+        add({ .name = "primitive/" + primitive.first,
+              .run = [&] { nvsamples::primitiveMeshToResource(importContext.getScene(), importContext.getStagingUploader(), primitiveMesh); },
+              .reset = clearScene });
+    }
+
+    // Image decoding: the texture of the floor, once and many times (decoded by parallel jobs)
+    std::vector<unsigned char> encodedImage;
+    const std::filesystem::path imageFile = nvutils::findFile("tiled_floor.png", nvsamples::getResourcesDirs());
+    if (!imageFile.empty())
+    {
+        std::ifstream file(imageFile, std::ios::binary);
+        encodedImage.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::vector<std::unique_ptr<tinygltf::Model>> imageModels;
+    for (uint32_t imageCount : { 1U, 16U })
+    {
+        if (encodedImage.empty())
+            break;
+        imageModels.push_back(std::make_unique<tinygltf::Model>());
+        tinygltf::Model& model = *imageModels.back();
+        const auto encodeImages = [&model, &encodedImage, imageCount] {
+            model.images.assign(imageCount, {});
+            for (tinygltf::Image& image : model.images)
+            {
+                image.image = encodedImage;
+                image.as_is = true;
+            }
+        };
+        add({ .name = fmt::format("decode/tiled_floor_x{}", imageCount),
+              .setup = encodeImages,
+              .run = [&model] { nvsamples::decodeGltfImages(model); },
+              .reset = encodeImages });
+    }
+
+    if (list)
+    {
+        for (const MicroBenchmark& benchmark : benchmarks)
+            fmt::print("{}\n", benchmark.name);
+        importContext.deinit();
+        vkContext.deinit();
+        return 0;
+    }
+
+    // Run, the loading and import functions log their timings: only the warnings and errors are kept
+    nvutils::Logger::getInstance().setMinimumLogLevel(nvutils::Logger::LogLevel::eWARNING);
+    std::vector<MicroBenchmarkResult> results;
+    fmt::print("{:<44} {:>14} {:>14} {:>14} {:>12}\n", "Benchmark", "Median", "Min", "Max", "Iterations");
+    for (const MicroBenchmark& benchmark : benchmarks)
+    {
+        results.push_back(runMicroBenchmark(benchmark, minTime, repetitions));
+        const MicroBenchmarkResult& result = results.back();
+        fmt::print("{:<44} {:>14} {:>14} {:>14} {:>12}\n", result.name, formatTime(result.medianNs), formatTime(result.minNs),
+                   formatTime(result.maxNs), result.iterations);
+    }
+    nvutils::Logger::getInstance().setMinimumLogLevel(nvutils::Logger::LogLevel::eINFO);
+
+    importContext.deinit();
+    vkContext.deinit();
+
+    // Results, and comparison to the previous ones
+    nlohmann::json json;
+    json["benchmarks"] = nlohmann::json::array();
+    for (const MicroBenchmarkResult& result : results)
+    {
+        json["benchmarks"].push_back({ { "name", result.name },
+                                       { "iterations", result.iterations },
+                                       { "median_ns", result.medianNs },
+                                       { "min_ns", result.minNs },
+                                       { "max_ns", result.maxNs } });
+    }
+    std::ofstream output(outputFile);
+    output << json.dump(2) << '\n';
+    if (!output)
+    {
+        LOGE("Could not write the results to %s\n", nvutils::utf8FromPath(outputFile).c_str());
+        return 1;
+    }
+    LOGI("Results written to %s\n", nvutils::utf8FromPath(outputFile).c_str());
+
+    if (!baselineFile.empty())
+    {
+        std::ifstream  baselineStream(baselineFile);
+        nlohmann::json baseline = nlohmann::json::parse(baselineStream, nullptr, false);
+        if (baseline.is_discarded() || !baseline.contains("benchmarks"))
+        {
+            LOGE("Could not read the baseline %s\n", nvutils::utf8FromPath(baselineFile).c_str());
+            return 1;
+        }
+
+        uint32_t regressions = 0;
+        for (const MicroBenchmarkResult& result : results)
+        {
+            for (const nlohmann::json& reference : baseline["benchmarks"])
+            {
+                if (reference.value("name", "") != result.name || reference.value("median_ns", 0.0) <= 0.0)
+                    continue;
+                const double ratio = result.medianNs / reference.value("median_ns", 0.0);
+                if (ratio > 1.0 + tolerance)
+                {
+                    LOGE("%s regressed: %s instead of %s (%+.1f%%)\n", result.name.c_str(), formatTime(result.medianNs).c_str(),
+                         formatTime(reference.value("median_ns", 0.0)).c_str(), (ratio - 1.0) * 100.0);
+                    regressions++;
+                }
+            }
+        }
+        if (regressions > 0)
+            return 2;
+    }
+
+    return 0;
+}
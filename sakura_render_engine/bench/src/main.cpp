@@ -0,0 +1,369 @@
+#include <sakura/Elements/ElementFoundation.hpp>
+#include "tinygltf/json.hpp"  // nlohmann::json, shipped with tinygltf
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Headless benchmark: renders each scene of a list for a fixed number of frames, the camera following a recorded
+// path (or an orbit around the scene), and writes the frame statistics as JSON.
+//
+// The scene list is a text file, one scene per line: <glTF file> [camera path file], relative to the list.
+// Without list, the default scene of the sandbox is measured.
+//
+// Running without GPU, on the lavapipe software rasterizer:
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json sakura_bench --scenes scenes.txt
+//
+// With --baseline, the statistics are compared to a previous output and the exit code is 2 when a frame time
+// regressed by more than the tolerance.
+
+namespace {
+
+struct BenchScene
+{
+    std::string           name;
+    std::filesystem::path sceneFile;       // Empty for the default scene
+    std::filesystem::path cameraPathFile;  // Empty for an orbit around the scene
+};
+
+// Parse the scene list, returns false when the file cannot be read
+bool loadSceneList(const std::filesystem::path& filename, std::vector<BenchScene>& scenes)
+{
+    std::ifstream file(filename);
+    if (!file)
+        return false;
+
+    const std::filesystem::path directory = filename.parent_path();
+    std::string                 line;
+    while (std::getline(file, line))
+    {
+        std::istringstream stream(line);
+        std::string        sceneName, cameraPathName;
+        if (!(stream >> sceneName) || sceneName[0] == '#')
+            continue;
+        stream >> cameraPathName;
+
+        BenchScene scene{ .name = std::filesystem::path(sceneName).stem().string(), .sceneFile = directory / sceneName };
+        if (!cameraPathName.empty())
+            scene.cameraPathFile = directory / cameraPathName;
+        scenes.push_back(scene);
+    }
+    return true;
+}
+
+// Value at the fraction `p` of the sorted values
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    return sorted[std::min(sorted.size() - 1, size_t(p * double(sorted.size())))];
+}
+
+
+//---------------------------------------------------------------------------------------------------------------
+// Element added after ElementFoundation: moves the camera along the path and collects the statistics of each
+// frame once the warm-up frames are rendered.
+//
+class BenchElement : public nvapp::IAppElement
+{
+public:
+    BenchElement(std::shared_ptr<ElementFoundation> foundation, const nvsamples::CameraPath& cameraPath, uint32_t warmupFrames, uint32_t frameCount)
+        : m_foundation(foundation)
+        , m_cameraPath(cameraPath)
+        , m_warmupFrames(warmupFrames)
+        , m_frameCount(frameCount)
+    {
+    }
+
+    void onAttach(nvapp::Application* app) override
+    {
+        // The scene is created, frame the camera on it
+        const nvutils::Bbox bounds = m_foundation->getSceneBounds();
+        const float         radius = bounds.isEmpty() ? 1.0F : std::max(bounds.radius(), 0.01F);
+        if (m_cameraPath.empty())
+            m_cameraPath = nvsamples::CameraPath::makeOrbit(bounds.isEmpty() ? glm::vec3(0.0F) : bounds.center(), radius * 2.5F, radius * 0.5F, 10.0F);
+        m_foundation->getCameraManipulator()->setClipPlanes({ radius * 0.001F, std::max(100.0F, radius * 10.0F) });
+        setCamera(0);
+        m_frameTimer.reset();
+    }
+
+    void onRender(VkCommandBuffer cmd) override
+    {
+        // ElementFoundation rendered the frame m_frame
+        const double now = m_frameTimer.getMilliseconds();
+        if (m_frame >= m_warmupFrames)
+        {
+            const ElementFoundation::FrameStats stats = m_foundation->getFrameStats();
+            m_frameTimes.push_back(now - m_lastFrameTime);
+            m_recordingTime += stats.recordingMs;
+            m_drawCalls += stats.drawCalls;
+            m_triangles += stats.triangles;
+            m_culledInstances += stats.culledInstances;
+            m_instanceCount = stats.instanceCount;
+            m_gpuMemoryUsage = std::max(m_gpuMemoryUsage, stats.gpuMemoryUsage);
+            for (uint32_t i = 0; i < uint32_t(nvsamples::MemoryCategory::eCount); i++)
+                m_categoryBytes[i] = std::max(m_categoryBytes[i], m_foundation->getMemoryTracker().getCategoryBytes(nvsamples::MemoryCategory(i)));
+        }
+        m_lastFrameTime = now;
+
+        // The GPU timings of the warm-up frames are still pending in the profiler, they must not be collected
+        if (m_frame + 1 == m_warmupFrames)
+            m_foundation->getGpuProfiler().resetStats();
+        setCamera(++m_frame);
+    }
+
+    void onLastHeadlessFrame() override
+    {
+        // Collected by ElementFoundation, attached before
+        m_gpuStats = m_foundation->getGpuProfiler().getStats();
+    }
+
+    nlohmann::json getResults() const
+    {
+        std::vector<double> sorted = m_frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        const double frames = std::max<double>(1.0, double(m_frameTimes.size()));
+
+        nlohmann::json results;
+        results["frames"] = m_frameTimes.size();
+        results["cpu_frame_ms"] = {
+            { "avg", std::accumulate(sorted.begin(), sorted.end(), 0.0) / frames },
+            { "min", sorted.empty() ? 0.0 : sorted.front() },
+            { "p50", percentile(sorted, 0.50) },
+            { "p95", percentile(sorted, 0.95) },
+            { "p99", percentile(sorted, 0.99) },
+            { "max", sorted.empty() ? 0.0 : sorted.back() },
+        };
+        results["recording_ms"] = m_recordingTime / frames;
+        results["gpu_passes"] = nlohmann::json::array();
+        for (const nvsamples::GpuProfiler::Stats& pass : m_gpuStats)
+        {
+            results["gpu_passes"].push_back({ { "name", pass.name },
+                                              { "samples", pass.samples },
+                                              { "avg_ms", pass.avgMs },
+                                              { "min_ms", pass.minMs },
+                                              { "p99_ms", pass.p99Ms } });
+        }
+        results["instances"] = m_instanceCount;
+        results["culled_instances"] = double(m_culledInstances) / frames;
+        results["draw_calls"] = double(m_drawCalls) / frames;
+        results["triangles"] = double(m_triangles) / frames;
+        results["gpu_memory_bytes"] = m_gpuMemoryUsage;
+        for (uint32_t i = 0; i < uint32_t(nvsamples::MemoryCategory::eCount); i++)
+            results["gpu_memory_categories"][nvsamples::MemoryTracker::getCategoryName(nvsamples::MemoryCategory(i))] = m_categoryBytes[i];
+        return results;
+    }
+
+private:
+    // Camera of the frame, the warm-up frames stay at the start of the path
+    void setCamera(uint32_t frame)
+    {
+        const uint32_t measuredFrame = frame > m_warmupFrames ? frame - m_warmupFrames : 0;
+        const float    time = m_cameraPath.getDuration() * float(measuredFrame) / float(std::max(1U, m_frameCount - 1));
+        const nvsamples::CameraKey key = m_cameraPath.evaluate(time);
+        m_foundation->getCameraManipulator()->setLookat(key.eye, key.center, key.up);
+    }
+
+    std::shared_ptr<ElementFoundation> m_foundation;
+    nvsamples::CameraPath              m_cameraPath;
+    uint32_t                           m_warmupFrames{};
+    uint32_t                           m_frameCount{};
+
+    uint32_t                                m_frame{};
+    nvutils::PerformanceTimer               m_frameTimer;
+    double                                  m_lastFrameTime{};
+    std::vector<double>                     m_frameTimes;  // CPU time between two frames, in milliseconds
+    double                                  m_recordingTime{};
+    uint64_t                                m_drawCalls{};
+    uint64_t                                m_triangles{};
+    uint64_t                                m_culledInstances{};
+    uint32_t                                m_instanceCount{};
+    uint64_t                                m_gpuMemoryUsage{};  // Peak
+    std::array<uint64_t, size_t(nvsamples::MemoryCategory::eCount)> m_categoryBytes{};  // Peak of each category
+    std::vector<nvsamples::GpuProfiler::Stats> m_gpuStats;
+};
+
+// Compare the frame times to the baseline, returns the number of regressions
+uint32_t compareToBaseline(const nlohmann::json& results, const nlohmann::json& baseline, double tolerance)
+{
+    uint32_t regressions = 0;
+    auto     check = [&](const std::string& scene, const std::string& metric, double value, double reference) {
+        if (reference <= 0.0)
+            return;
+        const double ratio = value / reference;
+        if (ratio > 1.0 + tolerance)
+        {
+            LOGE("%s: %s regressed, %.3f ms instead of %.3f ms (%+.1f%%)\n", scene.c_str(), metric.c_str(), value, reference, (ratio - 1.0) * 100.0);
+            regressions++;
+        }
+        else
+            LOGI("%s: %s %.3f ms, baseline %.3f ms (%+.1f%%)\n", scene.c_str(), metric.c_str(), value, reference, (ratio - 1.0) * 100.0);
+    };
+
+    for (const nlohmann::json& scene : results["scenes"])
+    {
+        const std::string name = scene["name"];
+        auto              reference = std::find_if(baseline["scenes"].begin(), baseline["scenes"].end(),
+                                                   [&](const nlohmann::json& s) { return s.value("name", "") == name; });
+        if (reference == baseline["scenes"].end())
+        {
+            LOGW("%s: not in the baseline\n", name.c_str());
+            continue;
+        }
+
+        check(name, "CPU frame p50", scene["cpu_frame_ms"]["p50"], (*reference)["cpu_frame_ms"]["p50"]);
+        for (const nlohmann::json& pass : scene["gpu_passes"])
+        {
+            for (const nlohmann::json& referencePass : (*reference)["gpu_passes"])
+            {
+                if (referencePass["name"] == pass["name"])
+                    check(name, "GPU " + pass["name"].get<std::string>(), pass["avg_ms"], referencePass["avg_ms"]);
+            }
+        }
+    }
+    return regressions;
+}
+
+}  // namespace
+
+
+//---------------------------------------------------------------------------------------------------------------
+// The main function, entry point of the benchmark
+int main(int argc, char** argv)
+{
+    std::filesystem::path sceneListFile;
+    std::filesystem::path outputFile = nvutils::getExecutablePath().replace_extension(".json");
+    std::filesystem::path baselineFile;
+    uint32_t              frameCount = 256;  // Matches the history of the GPU profiler
+    uint32_t              warmupFrames = 16;
+    float                 tolerance = 0.1F;
+    glm::uvec2            windowSize{ 1920, 1080 };
+    bool                  validation = false;
+
+    // Parsing the command line
+    nvutils::ParameterParser   cli(nvutils::getExecutablePath().stem().string());
+    nvutils::ParameterRegistry reg;
+    reg.add({ "scenes", "Scene list: one '<glTF file> [camera path file]' per line" }, &sceneListFile);
+    reg.add({ "output", "JSON file of the results" }, &outputFile);
+    reg.add({ "baseline", "JSON results to compare to, the exit code is 2 on a regression" }, &baselineFile);
+    reg.add({ "frames", "Number of measured frames per scene" }, &frameCount);
+    reg.add({ "warmup", "Number of frames rendered before measuring" }, &warmupFrames);
+    reg.add({ "tolerance", "Relative increase of a frame time reported as a regression" }, &tolerance);
+    reg.add({ "width", "Width of the rendered image" }, &windowSize.x);
+    reg.add({ "height", "Height of the rendered image" }, &windowSize.y);
+    reg.add({ "validation", "Enable the validation layers" }, &validation, true);
+    cli.add(reg);
+    cli.parse(argc, argv);
+
+    std::vector<BenchScene> scenes;
+    if (sceneListFile.empty())
+        scenes.push_back({ .name = "default" });
+    else if (!loadSceneList(sceneListFile, scenes) || scenes.empty())
+    {
+        LOGE("No scene in %s\n", nvutils::utf8FromPath(sceneListFile).c_str());
+        return 1;
+    }
+    frameCount = std::max(frameCount, 1U);
+
+    // Setting up the Vulkan context, without surface
+    VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures
+    { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT };
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures
+    { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+    nvvk::ContextInitInfo vkSetup{
+        .instanceExtensions = {VK_EXT_DEBUG_UTILS_EXTENSION_NAME},
+        .deviceExtensions =
+            {
+                {VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME},
+                {VK_EXT_SHADER_OBJECT_EXTENSION_NAME, &shaderObjectFeatures},
+                {VK_EXT_MESH_SHADER_EXTENSION_NAME, &meshShaderFeatures, false},  // Optional, meshlet rendering path
+                {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, nullptr, false},            // Optional, heap budgets from the driver
+            },
+    };
+    vkSetup.enableValidationLayers = validation;
+
+    nvvk::Context vkContext;
+    if (vkContext.init(vkSetup) != VK_SUCCESS)
+    {
+        LOGE("Error in Vulkan context creation\n");
+        return 1;
+    }
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(vkContext.getPhysicalDevice(), &properties);
+
+    nlohmann::json results;
+    results["device"] = properties.deviceName;
+    results["width"] = windowSize.x;
+    results["height"] = windowSize.y;
+    results["warmup_frames"] = warmupFrames;
+    results["scenes"] = nlohmann::json::array();
+
+    for (const BenchScene& scene : scenes)
+    {
+        nvsamples::CameraPath cameraPath;
+        if (!scene.cameraPathFile.empty() && !cameraPath.load(scene.cameraPathFile))
+            LOGW("Could not read the camera path %s, orbiting the scene\n", nvutils::utf8FromPath(scene.cameraPathFile).c_str());
+
+        // One application per scene, all the frames are rendered without window
+        nvapp::ApplicationCreateInfo appInfo{};
+        appInfo.name = "Sakura Benchmark";
+        appInfo.headless = true;
+        appInfo.headlessFrameCount = warmupFrames + frameCount;
+        appInfo.windowSize = windowSize;
+        appInfo.instance = vkContext.getInstance();
+        appInfo.device = vkContext.getDevice();
+        appInfo.physicalDevice = vkContext.getPhysicalDevice();
+        appInfo.queues = vkContext.getQueueInfos();
+
+        nvapp::Application application;
+        application.init(appInfo);
+
+        auto foundation = std::make_shared<ElementFoundation>();
+        foundation->setMeshShaderSupport(meshShaderFeatures.taskShader == VK_TRUE && meshShaderFeatures.meshShader == VK_TRUE);
+        foundation->setMemoryBudgetSupport(vkContext.hasExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME));
+        foundation->setSceneFile(scene.sceneFile);
+        auto bench = std::make_shared<BenchElement>(foundation, cameraPath, warmupFrames, frameCount);
+        application.addElement(foundation);
+        application.addElement(bench);
+
+        LOGI("Benchmarking %s\n", scene.name.c_str());
+        application.run();
+        application.deinit();
+
+        nlohmann::json sceneResults = bench->getResults();
+        sceneResults["name"] = scene.name;
+        results["scenes"].push_back(sceneResults);
+    }
+    vkContext.deinit();
+
+    std::ofstream output(outputFile);
+    output << results.dump(2) << '\n';
+    if (!output)
+    {
+        LOGE("Could not write the results to %s\n", nvutils::utf8FromPath(outputFile).c_str());
+        return 1;
+    }
+    LOGI("Results written to %s\n", nvutils::utf8FromPath(outputFile).c_str());
+
+    // Comparison to the previous results
+    if (!baselineFile.empty())
+    {
+        std::ifstream  baselineStream(baselineFile);
+        nlohmann::json baseline = nlohmann::json::parse(baselineStream, nullptr, false);
+        if (baseline.is_discarded() || !baseline.contains("scenes"))
+        {
+            LOGE("Could not read the baseline %s\n", nvutils::utf8FromPath(baselineFile).c_str());
+            return 1;
+        }
+        if (baseline.value("device", "") != results["device"])
+            LOGW("The baseline was measured on %s\n", baseline.value("device", "").c_str());
+        if (compareToBaseline(results, baseline, tolerance) > 0)
+            return 2;
+    }
+
+    return 0;
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "attribute_convert.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CONVERT_USE_SSE2 1
+#endif
+
+namespace nvsamples {
+
+namespace {
+
+template <typename T>
+T load(const void* src, size_t i)
+{
+  T v;
+  memcpy(&v, static_cast<const uint8_t*>(src) + i * sizeof(T), sizeof(T));
+  return v;
+}
+
+// Scalar conversion of the scalars [begin, count)
+void convertComponentsScalar(float* dst, const void* src, size_t begin, size_t count, ComponentType type, bool normalized)
+{
+  for(size_t i = begin; i < count; i++)
+  {
+    switch(type)
+    {
+      case ComponentType::eInt8:
+        dst[i] = normalized ? std::max(float(load<int8_t>(src, i)) / 127.0F, -1.0F) : float(load<int8_t>(src, i));
+        break;
+      case ComponentType::eUint8:
+        dst[i] = normalized ? float(load<uint8_t>(src, i)) / 255.0F : float(load<uint8_t>(src, i));
+        break;
+      case ComponentType::eInt16:
+        dst[i] = normalized ? std::max(float(load<int16_t>(src, i)) / 32767.0F, -1.0F) : float(load<int16_t>(src, i));
+        break;
+      case ComponentType::eUint16:
+        dst[i] = normalized ? float(load<uint16_t>(src, i)) / 65535.0F : float(load<uint16_t>(src, i));
+        break;
+      case ComponentType::eUint32:
+        dst[i] = float(load<uint32_t>(src, i));
+        break;
+      case ComponentType::eFloat:
+        dst[i] = load<float>(src, i);
+        break;
+    }
+  }
+}
+
+#if defined(CONVERT_USE_SSE2)
+// Convert 4 int32 lanes and store them, normalized by `maxValue` and clamped to -1 for the signed types
+void storeConverted(float* dst, __m128i v, bool normalized, float maxValue, bool isSigned)
+{
+  __m128 f = _mm_cvtepi32_ps(v);
+  if(normalized)
+  {
+    f = _mm_div_ps(f, _mm_set1_ps(maxValue));  // Same rounding as the scalar path
+    if(isSigned)
+      f = _mm_max_ps(f, _mm_set1_ps(-1.0F));
+  }
+  _mm_storeu_ps(dst, f);
+}
+#endif
+
+}  // namespace
+
+size_t componentSize(ComponentType type)
+{
+  switch(type)
+  {
+    case ComponentType::eInt8:
+    case ComponentType::eUint8:
+      return 1;
+    case ComponentType::eInt16:
+    case ComponentType::eUint16:
+      return 2;
+    default:
+      return 4;
+  }
+}
+
+void convertComponentsToFloat(float* dst, const void* src, size_t count, ComponentType type, bool normalized)
+{
+  size_t i = 0;
+#if defined(CONVERT_USE_SSE2)
+  const uint8_t* bytes = static_cast<const uint8_t*>(src);
+  const __m128i  zero  = _mm_setzero_si128();
+  switch(type)
+  {
+    case ComponentType::eInt8:
+    case ComponentType::eUint8: {
+      const bool  isSigned = type == ComponentType::eInt8;
+      const float maxValue = isSigned ? 127.0F : 255.0F;
+      for(; i + 16 <= count; i += 16)
+      {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+        // Widen to 16 bits (sign extension: the byte in the high half, shifted back)
+        const __m128i lo = isSigned ? _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8) : _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = isSigned ? _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8) : _mm_unpackhi_epi8(v, zero);
+        // Widen to 32 bits
+        const __m128i words[2] = {lo, hi};
+        for(int w = 0; w < 2; w++)
+        {
+          const __m128i a = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(words[w], words[w]), 16) : _mm_unpacklo_epi16(words[w], zero);
+          const __m128i b = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(words[w], words[w]), 16) : _mm_unpackhi_epi16(words[w], zero);
+          storeConverted(dst + i + w * 8, a, normalized, maxValue, isSigned);
+          storeConverted(dst + i + w * 8 + 4, b, normalized, maxValue, isSigned);
+        }
+      }
+      break;
+    }
+    case ComponentType::eInt16:
+    case ComponentType::eUint16: {
+      const bool  isSigned = type == ComponentType::eInt16;
+      const float maxValue = isSigned ? 32767.0F : 65535.0F;
+      for(; i + 8 <= count; i += 8)
+      {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i * 2));
+        const __m128i a = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16) : _mm_unpacklo_epi16(v, zero);
+        const __m128i b = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16) : _mm_unpackhi_epi16(v, zero);
+        storeConverted(dst + i, a, normalized, maxValue, isSigned);
+        storeConverted(dst + i + 4, b, normalized, maxValue, isSigned);
+      }
+      break;
+    }
+    case ComponentType::eFloat:
+      memcpy(dst, src, count * sizeof(float));
+      return;
+    default:
+      break;  // Unsigned 32-bit values do not fit the signed conversion
+  }
+#endif
+  convertComponentsScalar(dst, src, i, count, type, normalized);
+}
+
+void convertElementsToFloat(std::span<float> dst,
+                            uint32_t         dstComponents,
+                            const uint8_t*   src,
+                            size_t           srcStride,
+                            uint32_t         srcComponents,
+                            ComponentType    type,
+                            bool             normalized,
+                            size_t           count)
+{
+  const size_t elementSize = componentSize(type) * srcComponents;
+
+  // Gather the elements when they are interleaved or padded, then convert all the components as one stream
+  std::vector<uint8_t> packed;
+  const void*          stream = src;
+  if(srcStride != elementSize)
+  {
+    packed.resize(count * elementSize);
+    for(size_t i = 0; i < count; i++)
+      memcpy(packed.data() + i * elementSize, src + i * srcStride, elementSize);
+    stream = packed.data();
+  }
+
+  if(dstComponents == srcComponents)
+  {
+    convertComponentsToFloat(dst.data(), stream, count * srcComponents, type, normalized);
+    return;
+  }
+
+  std::vector<float> values(count * srcComponents);
+  convertComponentsToFloat(values.data(), stream, values.size(), type, normalized);
+  for(size_t i = 0; i < count; i++)
+  {
+    for(uint32_t c = 0; c < dstComponents; c++)
+      dst[i * dstComponents + c] = c < srcComponents ? values[i * srcComponents + c] : (c == 3 ? 1.0F : 0.0F);
+  }
+}
+
+void convertIndices(uint32_t* dst, const void* src, size_t count, ComponentType type)
+{
+  size_t i = 0;
+#if defined(CONVERT_USE_SSE2)
+  const uint8_t* bytes = static_cast<const uint8_t*>(src);
+  const __m128i  zero  = _mm_setzero_si128();
+  if(type == ComponentType::eUint8)
+  {
+    for(; i + 16 <= count; i += 16)
+    {
+      const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+      const __m128i lo = _mm_unpacklo_epi8(v, zero);
+      const __m128i hi = _mm_unpackhi_epi8(v, zero);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(lo, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(lo, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 8), _mm_unpacklo_epi16(hi, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+  }
+  else if(type == ComponentType::eUint16)
+  {
+    for(; i + 8 <= count; i += 8)
+    {
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i * 2));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(v, zero));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(v, zero));
+    }
+  }
+#endif
+  for(; i < count; i++)
+  {
+    switch(type)
+    {
+      case ComponentType::eUint8:
+        dst[i] = load<uint8_t>(src, i);
+        break;
+      case ComponentType::eUint16:
+        dst[i] = load<uint16_t>(src, i);
+        break;
+      default:
+        dst[i] = load<uint32_t>(src, i);
+        break;
+    }
+  }
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+//--------------------------------------------------------------------------------------------------
+// Conversion of vertex and index data stored in other layouts than the one read by the shaders
+// (integer or normalized components, interleaved or padded elements, small indices).
+// The conversions of the component streams use SSE2 when available, with a scalar fallback.
+
+namespace nvsamples {
+
+enum class ComponentType
+{
+  eInt8,
+  eUint8,
+  eInt16,
+  eUint16,
+  eUint32,
+  eFloat,
+};
+
+size_t componentSize(ComponentType type);
+
+// Convert `count` scalars stored contiguously in `src` to floats.
+// Normalized integers are mapped to [0,1] (unsigned) or [-1,1] (signed), the others are converted as is.
+void convertComponentsToFloat(float* dst, const void* src, size_t count, ComponentType type, bool normalized);
+
+// Convert `count` elements of `srcComponents` components, `srcStride` bytes apart, to tightly packed elements of
+// `dstComponents` floats. Missing components are set to 0 (1 for the 4th one), extra components are dropped.
+void convertElementsToFloat(std::span<float> dst,
+                            uint32_t         dstComponents,
+                            const uint8_t*   src,
+                            size_t           srcStride,
+                            uint32_t         srcComponents,
+                            ComponentType    type,
+                            bool             normalized,
+                            size_t           count);
+
+// Widen `count` unsigned indices (8, 16 or 32 bits), stored contiguously in `src`, to 32 bits
+void convertIndices(uint32_t* dst, const void* src, size_t count, ComponentType type);
+
+}  // namespace nvsamples
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "camera_path.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <fmt/format.h>
+#include <glm/gtc/constants.hpp>
+
+namespace nvsamples {
+
+CameraKey CameraPath::evaluate(float time) const
+{
+  if(m_keys.empty())
+    return {};
+  if(time <= m_keys.front().time)
+    return m_keys.front();
+  if(time >= m_keys.back().time)
+    return m_keys.back();
+
+  // First key after `time`, interpolate with the previous one
+  const auto next = std::upper_bound(m_keys.begin(), m_keys.end(), time, [](float t, const CameraKey& key) { return t < key.time; });
+  const CameraKey& a = *(next - 1);
+  const CameraKey& b = *next;
+  const float      s = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0.0F;
+  return {
+      .time   = time,
+      .eye    = glm::mix(a.eye, b.eye, s),
+      .center = glm::mix(a.center, b.center, s),
+      .up     = glm::normalize(glm::mix(a.up, b.up, s)),
+  };
+}
+
+bool CameraPath::load(const std::filesystem::path& filename)
+{
+  std::ifstream file(filename);
+  if(!file)
+    return false;
+
+  std::vector<CameraKey> keys;
+  std::string            line;
+  while(std::getline(file, line))
+  {
+    if(line.empty() || line[0] == '#')
+      continue;
+    std::istringstream stream(line);
+    CameraKey          key;
+    stream >> key.time >> key.eye.x >> key.eye.y >> key.eye.z >> key.center.x >> key.center.y >> key.center.z >> key.up.x
+        >> key.up.y >> key.up.z;
+    if(stream.fail())
+      return false;
+    keys.push_back(key);
+  }
+  std::stable_sort(keys.begin(), keys.end(), [](const CameraKey& a, const CameraKey& b) { return a.time < b.time; });
+  m_keys = std::move(keys);
+  return true;
+}
+
+bool CameraPath::save(const std::filesystem::path& filename) const
+{
+  std::ofstream file(filename);
+  if(!file)
+    return false;
+
+  file << "# time eye.x eye.y eye.z center.x center.y center.z up.x up.y up.z\n";
+  for(const CameraKey& key : m_keys)
+  {
+    file << fmt::format("{:.4f} {:.6f} {:.6f} {:.6f} {:.6f} {:.6f} {:.6f} {:.6f} {:.6f} {:.6f}\n", key.time, key.eye.x,
+                        key.eye.y, key.eye.z, key.center.x, key.center.y, key.center.z, key.up.x, key.up.y, key.up.z);
+  }
+  return bool(file);
+}
+
+CameraPath CameraPath::makeOrbit(const glm::vec3& center, float radius, float height, float duration, uint32_t keyCount /*= 64*/)
+{
+  CameraPath path;
+  keyCount = std::max(keyCount, 2U);
+  for(uint32_t i = 0; i < keyCount; i++)
+  {
+    const float s     = float(i) / float(keyCount - 1);
+    const float angle = s * glm::two_pi<float>();
+    path.addKey({
+        .time   = s * duration,
+        .eye    = center + glm::vec3(radius * std::sin(angle), height, radius * std::cos(angle)),
+        .center = center,
+    });
+  }
+  return path;
+}
+
+}  // namespace nvsamples
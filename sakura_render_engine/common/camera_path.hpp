@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace nvsamples {
+
+// Camera position at a time of a path
+struct CameraKey
+{
+  float     time = 0.0F;  // Seconds from the start of the path
+  glm::vec3 eye{0.0F};
+  glm::vec3 center{0.0F};
+  glm::vec3 up{0.0F, 1.0F, 0.0F};
+};
+
+//--------------------------------------------------------------------------------------------------
+// Camera path, recorded from the interactive camera or generated, and replayed by the benchmark
+//
+// The keys are sorted by time and interpolated linearly. The file format is text, one key per line:
+//   time eye.x eye.y eye.z center.x center.y center.z up.x up.y up.z
+// Empty lines and lines starting with '#' are ignored.
+class CameraPath
+{
+public:
+  void clear() { m_keys.clear(); }
+
+  // Add a key, after the last one
+  void addKey(const CameraKey& key) { m_keys.push_back(key); }
+
+  bool                          empty() const { return m_keys.empty(); }
+  const std::vector<CameraKey>& getKeys() const { return m_keys; }
+  float                         getDuration() const { return m_keys.empty() ? 0.0F : m_keys.back().time; }
+
+  // Camera at `time`, clamped to the path
+  CameraKey evaluate(float time) const;
+
+  bool load(const std::filesystem::path& filename);
+  bool save(const std::filesystem::path& filename) const;
+
+  // Circle around `center` at `radius` and `height` above it, in `duration` seconds
+  static CameraPath makeOrbit(const glm::vec3& center, float radius, float height, float duration, uint32_t keyCount = 64);
+
+private:
+  std::vector<CameraKey> m_keys;
+};
+
+}  // namespace nvsamples
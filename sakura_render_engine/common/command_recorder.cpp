@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "command_recorder.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#include "nvvk/check_error.hpp"
+
+#include "job_system.hpp"
+#include "trace_recorder.hpp"
+
+namespace nvsamples {
+
+void SecondaryCommandRecorder::init(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount, const Settings& settings /*= {}*/)
+{
+  m_device = device;
+  setSettings(settings);
+
+  // Pools for all the threads of the job system, any of them can run a recording job
+  m_threadPools.resize(JobSystem::getInstance().getThreadCount());
+  for(std::vector<FramePool>& framePools : m_threadPools)
+  {
+    framePools.resize(std::max(frameCount, 1U));
+    for(FramePool& framePool : framePools)
+    {
+      const VkCommandPoolCreateInfo createInfo{
+          .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+          .flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+          .queueFamilyIndex = queueFamilyIndex,
+      };
+      NVVK_CHECK(vkCreateCommandPool(m_device, &createInfo, nullptr, &framePool.pool));
+    }
+  }
+}
+
+void SecondaryCommandRecorder::deinit()
+{
+  for(std::vector<FramePool>& framePools : m_threadPools)
+  {
+    for(FramePool& framePool : framePools)
+      vkDestroyCommandPool(m_device, framePool.pool, nullptr);  // Frees the command buffers
+  }
+  m_threadPools.clear();
+}
+
+void SecondaryCommandRecorder::setSettings(const Settings& settings)
+{
+  m_settings                  = settings;
+  m_settings.minItemsPerRange = std::max(m_settings.minItemsPerRange, 1U);
+  m_settings.rangesPerThread  = std::max(m_settings.rangesPerThread, 1U);
+  if(!m_threadPools.empty())
+    m_settings.numThreads = std::min(m_settings.numThreads, getMaxThreads());
+}
+
+VkCommandBuffer SecondaryCommandRecorder::acquireCommandBuffer(FramePool& framePool)
+{
+  if(framePool.usedCount == framePool.commandBuffers.size())
+  {
+    const VkCommandBufferAllocateInfo allocInfo{
+        .sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool        = framePool.pool,
+        .level              = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandBufferCount = 1,
+    };
+    VkCommandBuffer commandBuffer{};
+    NVVK_CHECK(vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer));
+    framePool.commandBuffers.push_back(commandBuffer);
+  }
+  return framePool.commandBuffers[framePool.usedCount++];
+}
+
+void SecondaryCommandRecorder::recordAndExecute(VkCommandBuffer                                cmd,
+                                                uint32_t                                       frameIndex,
+                                                const VkCommandBufferInheritanceRenderingInfo& renderingInfo,
+                                                uint32_t                                       itemCount,
+                                                const RecordRangeFunc&                         recordRange)
+{
+  m_lastRangeCount  = 0;
+  m_lastThreadCount = 0;
+  if(itemCount == 0)
+    return;
+
+  // Split the items: at most rangesPerThread ranges per thread, and no range smaller than minItemsPerRange
+  const uint32_t maxThreads  = m_settings.numThreads == 0 ? getMaxThreads() : m_settings.numThreads;
+  const uint32_t maxRanges   = (itemCount + m_settings.minItemsPerRange - 1) / m_settings.minItemsPerRange;
+  const uint32_t rangeCount  = std::min(maxThreads * m_settings.rangesPerThread, maxRanges);
+  const uint32_t rangeLength = (itemCount + rangeCount - 1) / rangeCount;
+
+  // The command buffers of the previous use of this frame are done executing
+  for(std::vector<FramePool>& framePools : m_threadPools)
+  {
+    FramePool& framePool = framePools[frameIndex % framePools.size()];
+    if(framePool.usedCount > 0)
+    {
+      NVVK_CHECK(vkResetCommandPool(m_device, framePool.pool, 0));
+      framePool.usedCount = 0;
+    }
+  }
+
+  const VkCommandBufferInheritanceInfo inheritanceInfo{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .pNext = &renderingInfo,
+  };
+  const VkCommandBufferBeginInfo beginInfo{
+      .sType            = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .flags            = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+      .pInheritanceInfo = &inheritanceInfo,
+  };
+
+  // One job per range, the secondaries are stored in the order of the ranges. A thread only runs one job at a
+  // time, so the command pool of the thread running the job is not used concurrently.
+  JobSystem&                   jobs = JobSystem::getInstance();
+  std::vector<VkCommandBuffer> secondaries(rangeCount);
+  std::atomic<uint64_t>        threadMask{0};
+  jobs.parallelFor(rangeCount, 1, [&](uint32_t rangeBegin, uint32_t rangeEnd) {
+    TRACE_SCOPE("SecondaryCommandRecorder::recordRange");
+    const uint32_t threadIndex = jobs.getThreadIndex();
+    FramePool&     framePool   = m_threadPools[threadIndex][frameIndex % m_threadPools[threadIndex].size()];
+    threadMask |= uint64_t(1) << (threadIndex % 64);
+    for(uint32_t range = rangeBegin; range < rangeEnd; range++)
+    {
+      const uint32_t begin = range * rangeLength;
+      const uint32_t end   = std::min(itemCount, begin + rangeLength);
+
+      VkCommandBuffer secondary = acquireCommandBuffer(framePool);
+      NVVK_CHECK(vkBeginCommandBuffer(secondary, &beginInfo));
+      if(begin < end)
+        recordRange(secondary, begin, end);
+      NVVK_CHECK(vkEndCommandBuffer(secondary));
+      secondaries[range] = secondary;
+    }
+  });
+
+  vkCmdExecuteCommands(cmd, rangeCount, secondaries.data());
+  m_lastRangeCount  = rangeCount;
+  m_lastThreadCount = uint32_t(std::popcount(threadMask.load()));
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// Parallel recording of secondary command buffers for a dynamic rendering pass
+//
+// The items to record (e.g. draws) are split in contiguous ranges, each range is recorded in its own
+// secondary command buffer by a job of the JobSystem and the secondaries are executed in the order
+// of the ranges, so the result is the same as recording all items in sequence.
+// Each thread of the job system records with command buffers of its own command pool, one set of pools
+// per frame in flight: the pools of a frame are reset when the frame is recorded again.
+//
+// Usage per frame, between vkCmdBeginRendering(VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT) and
+// vkCmdEndRendering:
+//   recorder.recordAndExecute(cmd, frameIndex, inheritanceRenderingInfo, itemCount, recordRange);
+//
+// Secondary command buffers do not inherit any state from the primary: `recordRange` must bind the
+// shaders, descriptor sets and dynamic states it uses.
+class SecondaryCommandRecorder
+{
+public:
+  struct Settings
+  {
+    uint32_t numThreads       = 0;   // Threads the ranges are sized for (at most the job system threads), 0 means all
+    uint32_t minItemsPerRange = 64;  // Ranges smaller than this are merged, to amortize the state setup of a secondary
+    uint32_t rangesPerThread  = 2;   // Ranges per thread: more ranges balance uneven items, fewer cost less setup
+  };
+
+  // Records a range of items [begin, end) in a secondary command buffer, called from the jobs
+  using RecordRangeFunc = std::function<void(VkCommandBuffer cmd, uint32_t begin, uint32_t end)>;
+
+  void init(VkDevice device, uint32_t queueFamilyIndex, uint32_t frameCount, const Settings& settings = {});
+  void deinit();
+
+  void            setSettings(const Settings& settings);
+  const Settings& getSettings() const { return m_settings; }
+  uint32_t        getMaxThreads() const { return uint32_t(m_threadPools.size()); }
+
+  // Record the items in secondary command buffers with parallel jobs and execute them in `cmd`
+  void recordAndExecute(VkCommandBuffer                                cmd,
+                        uint32_t                                       frameIndex,
+                        const VkCommandBufferInheritanceRenderingInfo& renderingInfo,
+                        uint32_t                                       itemCount,
+                        const RecordRangeFunc&                         recordRange);
+
+  // Statistics of the last recordAndExecute()
+  uint32_t getLastRangeCount() const { return m_lastRangeCount; }
+  uint32_t getLastThreadCount() const { return m_lastThreadCount; }
+
+private:
+  // Command pool of one thread for one frame, with the command buffers allocated so far
+  struct FramePool
+  {
+    VkCommandPool                pool{};
+    std::vector<VkCommandBuffer> commandBuffers;
+    uint32_t                     usedCount = 0;
+  };
+
+  VkCommandBuffer acquireCommandBuffer(FramePool& framePool);
+
+  VkDevice                            m_device{};
+  Settings                            m_settings{};
+  std::vector<std::vector<FramePool>> m_threadPools;  // [JobSystem thread index][frame]
+  uint32_t                            m_lastRangeCount  = 0;
+  uint32_t                            m_lastThreadCount = 0;
+};
+
+}  // namespace nvsamples
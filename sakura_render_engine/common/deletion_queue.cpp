@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "deletion_queue.hpp"
+
+#include <cassert>
+
+namespace nvsamples {
+
+void DeletionQueue::init(VkDevice device, nvvk::ResourceAllocator* allocator)
+{
+  m_device    = device;
+  m_allocator = allocator;
+}
+
+void DeletionQueue::deinit()
+{
+  flushAll();
+  m_device    = VK_NULL_HANDLE;
+  m_allocator = nullptr;
+}
+
+void DeletionQueue::push(uint64_t timelineValue, std::function<void()> destroy)
+{
+  assert(m_entries.empty() || m_entries.back().timelineValue <= timelineValue);
+  m_entries.push_back({.timelineValue = timelineValue, .destroy = std::move(destroy)});
+}
+
+void DeletionQueue::destroyBuffer(uint64_t timelineValue, nvvk::Buffer& buffer)
+{
+  if(buffer.buffer == VK_NULL_HANDLE)
+    return;
+  push(timelineValue, [allocator = m_allocator, buffer]() mutable { allocator->destroyBuffer(buffer); });
+  buffer = {};
+}
+
+void DeletionQueue::destroyImage(uint64_t timelineValue, nvvk::Image& image)
+{
+  if(image.image == VK_NULL_HANDLE)
+    return;
+  push(timelineValue, [allocator = m_allocator, image]() mutable { allocator->destroyImage(image); });
+  image = {};
+}
+
+void DeletionQueue::destroyAccelerationStructure(uint64_t timelineValue, nvvk::AccelerationStructure& accel)
+{
+  if(accel.accel == VK_NULL_HANDLE)
+    return;
+  push(timelineValue, [allocator = m_allocator, accel]() mutable { allocator->destroyAcceleration(accel); });
+  accel = {};
+}
+
+void DeletionQueue::destroyShader(uint64_t timelineValue, VkShaderEXT& shader)
+{
+  if(shader == VK_NULL_HANDLE)
+    return;
+  push(timelineValue, [device = m_device, shader]() { vkDestroyShaderEXT(device, shader, nullptr); });
+  shader = VK_NULL_HANDLE;
+}
+
+void DeletionQueue::destroyPipeline(uint64_t timelineValue, VkPipeline& pipeline)
+{
+  if(pipeline == VK_NULL_HANDLE)
+    return;
+  push(timelineValue, [device = m_device, pipeline]() { vkDestroyPipeline(device, pipeline, nullptr); });
+  pipeline = VK_NULL_HANDLE;
+}
+
+void DeletionQueue::destroyPipelineLayout(uint64_t timelineValue, VkPipelineLayout& pipelineLayout)
+{
+  if(pipelineLayout == VK_NULL_HANDLE)
+    return;
+  push(timelineValue, [device = m_device, pipelineLayout]() { vkDestroyPipelineLayout(device, pipelineLayout, nullptr); });
+  pipelineLayout = VK_NULL_HANDLE;
+}
+
+void DeletionQueue::flush(uint64_t completedValue)
+{
+  while(!m_entries.empty() && m_entries.front().timelineValue <= completedValue)
+  {
+    // Popped before the call, the callback may enqueue
+    std::function<void()> destroy = std::move(m_entries.front().destroy);
+    m_entries.pop_front();
+    destroy();
+  }
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+#include "nvvk/resource_allocator.hpp"
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// Deferred destruction of GPU objects, keyed by timeline values
+//
+// An object still referenced by submitted command buffers is enqueued with the timeline value of the
+// last submission using it (e.g. the FramePacer frame number), and destroyed by flush() once the GPU
+// reached that value. Replacing a resource then never needs to wait for the queue to be idle.
+//
+// The values must be pushed in non-decreasing order: flush() stops at the first pending value.
+// The handles passed to the destroy*() functions are reset, as the nvvk::ResourceAllocator functions do.
+//
+// Usage:
+//   queue.destroyPipeline(pacer.getFrameNumber(), m_pipeline);  // Last used by the current frame
+//   ...
+//   queue.flush(pacer.getCompletedFrame());                     // Once a frame
+class DeletionQueue
+{
+public:
+  void init(VkDevice device, nvvk::ResourceAllocator* allocator);
+  void deinit();  // Destroys everything pending, the GPU must be idle
+
+  // Generic entry: `destroy` is called once `timelineValue` is completed
+  void push(uint64_t timelineValue, std::function<void()> destroy);
+
+  void destroyBuffer(uint64_t timelineValue, nvvk::Buffer& buffer);
+  void destroyImage(uint64_t timelineValue, nvvk::Image& image);
+  void destroyAccelerationStructure(uint64_t timelineValue, nvvk::AccelerationStructure& accel);
+  void destroyShader(uint64_t timelineValue, VkShaderEXT& shader);
+  void destroyPipeline(uint64_t timelineValue, VkPipeline& pipeline);
+  void destroyPipelineLayout(uint64_t timelineValue, VkPipelineLayout& pipelineLayout);
+
+  // Destroy the objects whose value is <= completedValue
+  void flush(uint64_t completedValue);
+
+  // Destroy all the objects, the GPU must be done with them
+  void flushAll() { flush(~0ULL); }
+
+  size_t size() const { return m_entries.size(); }
+  bool   empty() const { return m_entries.empty(); }
+
+private:
+  struct Entry
+  {
+    uint64_t              timelineValue = 0;
+    std::function<void()> destroy;
+  };
+
+  VkDevice                 m_device{};
+  nvvk::ResourceAllocator* m_allocator{};
+  std::deque<Entry>        m_entries;
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "draw_batcher.hpp"
+
+namespace nvsamples {
+
+void DrawBatcher::setInstance(uint32_t instanceIndex, uint32_t meshIndex, uint32_t materialIndex)
+{
+  if(instanceIndex >= m_locations.size())
+    m_locations.resize(instanceIndex + 1);
+
+  const Location& location = m_locations[instanceIndex];
+  if(location.batch != kNoBatch)
+  {
+    const DrawBatch& batch = m_batches[location.batch];
+    if(batch.meshIndex == meshIndex && batch.materialIndex == materialIndex)
+      return;  // Unchanged
+    removeInstance(instanceIndex);
+  }
+
+  const uint64_t key = makeKey(meshIndex, materialIndex);
+  auto           it  = m_batchIndices.find(key);
+  if(it == m_batchIndices.end())
+  {
+    it = m_batchIndices.emplace(key, uint32_t(m_batches.size())).first;
+    m_batches.push_back({.meshIndex = meshIndex, .materialIndex = materialIndex, .instances = {}});
+  }
+
+  DrawBatch& batch           = m_batches[it->second];
+  m_locations[instanceIndex] = {.batch = it->second, .slot = uint32_t(batch.instances.size())};
+  batch.instances.push_back(instanceIndex);
+}
+
+void DrawBatcher::removeInstance(uint32_t instanceIndex)
+{
+  if(instanceIndex >= m_locations.size() || m_locations[instanceIndex].batch == kNoBatch)
+    return;
+
+  // Swap with the last instance of the batch
+  const Location location        = m_locations[instanceIndex];
+  DrawBatch&     batch           = m_batches[location.batch];
+  const uint32_t moved           = batch.instances.back();
+  batch.instances[location.slot] = moved;
+  m_locations[moved].slot        = location.slot;
+  batch.instances.pop_back();
+  m_locations[instanceIndex] = {};
+
+  if(!batch.instances.empty())
+    return;
+
+  // Empty batch: swap with the last batch
+  const uint32_t lastBatch = uint32_t(m_batches.size() - 1);
+  m_batchIndices.erase(makeKey(batch.meshIndex, batch.materialIndex));
+  if(location.batch != lastBatch)
+  {
+    m_batches[location.batch] = std::move(m_batches[lastBatch]);
+    const DrawBatch& relocated = m_batches[location.batch];
+    m_batchIndices[makeKey(relocated.meshIndex, relocated.materialIndex)] = location.batch;
+    for(uint32_t instance : relocated.instances)
+      m_locations[instance].batch = location.batch;
+  }
+  m_batches.pop_back();
+}
+
+void DrawBatcher::resize(uint32_t instanceCount)
+{
+  for(uint32_t i = instanceCount; i < m_locations.size(); i++)
+    removeInstance(i);
+  if(instanceCount < m_locations.size())
+    m_locations.resize(instanceCount);
+}
+
+void DrawBatcher::clear()
+{
+  m_batches.clear();
+  m_batchIndices.clear();
+  m_locations.clear();
+}
+
+}  // namespace nvsamples
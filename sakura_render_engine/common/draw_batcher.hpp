@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace nvsamples {
+
+// Instances sharing a mesh and a material, drawn with a single instanced draw call
+struct DrawBatch
+{
+  uint32_t              meshIndex     = 0;
+  uint32_t              materialIndex = 0;
+  std::vector<uint32_t> instances;  // Indices of the instances, in no particular order
+};
+
+//--------------------------------------------------------------------------------------------------
+// Grouping of the instances by (mesh, material).
+// The groups are maintained incrementally: adding, removing or changing an instance only moves that instance
+// (swap-remove in its previous batch), so calling setInstance() for every instance each frame costs a comparison
+// per unchanged instance.
+class DrawBatcher
+{
+public:
+  // Add the instance, or move it to another batch when its mesh or material changed
+  void setInstance(uint32_t instanceIndex, uint32_t meshIndex, uint32_t materialIndex);
+
+  // Remove the instance from its batch
+  void removeInstance(uint32_t instanceIndex);
+
+  // Remove the instances with an index >= instanceCount (instances removed at the end of the array)
+  void resize(uint32_t instanceCount);
+
+  void clear();
+
+  const std::vector<DrawBatch>& getBatches() const { return m_batches; }
+
+private:
+  static constexpr uint32_t kNoBatch = ~0U;
+
+  struct Location
+  {
+    uint32_t batch = kNoBatch;
+    uint32_t slot  = 0;  // Position in DrawBatch::instances
+  };
+
+  static uint64_t makeKey(uint32_t meshIndex, uint32_t materialIndex) { return (uint64_t(meshIndex) << 32) | materialIndex; }
+
+  std::vector<DrawBatch>                 m_batches;
+  std::unordered_map<uint64_t, uint32_t> m_batchIndices;  // Key to index in m_batches
+  std::vector<Location>                  m_locations;     // Per instance
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "file_watcher.hpp"
+
+#include <system_error>
+
+namespace nvsamples {
+
+void FileWatcher::start(std::vector<std::filesystem::path> files, std::chrono::milliseconds period)
+{
+  stop();
+  m_files   = std::move(files);
+  m_period  = period;
+  m_stop    = false;
+  m_changed = false;
+  m_thread  = std::thread([this]() { watchLoop(); });
+}
+
+void FileWatcher::stop()
+{
+  if(!m_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  m_thread.join();
+}
+
+FileWatcher::FileTimes FileWatcher::readTimes() const
+{
+  FileTimes times(m_files.size());
+  for(size_t i = 0; i < m_files.size(); i++)
+  {
+    std::error_code ec;
+    times[i] = std::filesystem::last_write_time(m_files[i], ec);  // Minimum value when missing (being replaced)
+  }
+  return times;
+}
+
+void FileWatcher::watchLoop()
+{
+  FileTimes reported = readTimes();  // State of the last report
+  FileTimes previous = reported;     // State of the previous poll
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while(!m_wakeUp.wait_for(lock, m_period, [this]() { return m_stop; }))
+  {
+    const FileTimes times = readTimes();
+    if(times == previous && times != reported)  // Modified, and stable since the previous poll
+    {
+      reported = times;
+      m_changed.store(true, std::memory_order_release);
+    }
+    previous = times;
+  }
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// Watch a set of files for modifications, from a thread polling their last write time
+//
+// A modification is reported once the files did not change for one more polling period, so a file saved
+// in several writes (or several files saved together) is reported once, when complete. Polling works on
+// any file system, and the list is a few files (a shader and its includes).
+//
+//   watcher.start(files);
+//   ...
+//   if(watcher.hasChanged())  // Once a frame, resets the flag
+//     reload();
+class FileWatcher
+{
+public:
+  FileWatcher() = default;
+  ~FileWatcher() { stop(); }
+  FileWatcher(const FileWatcher&)            = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+
+  // Start watching `files` (replacing the previous ones), the current state is the reference
+  void start(std::vector<std::filesystem::path> files, std::chrono::milliseconds period = std::chrono::milliseconds(250));
+  void stop();
+
+  bool isRunning() const { return m_thread.joinable(); }
+
+  const std::vector<std::filesystem::path>& getFiles() const { return m_files; }
+
+  // True when a file was modified since the previous call
+  bool hasChanged() { return m_changed.exchange(false, std::memory_order_acq_rel); }
+
+private:
+  using FileTimes = std::vector<std::filesystem::file_time_type>;
+
+  FileTimes readTimes() const;
+  void      watchLoop();
+
+  std::vector<std::filesystem::path> m_files;
+  std::chrono::milliseconds          m_period{250};
+  std::thread                        m_thread;
+  std::mutex                         m_mutex;
+  std::condition_variable            m_wakeUp;
+  bool                               m_stop = false;
+  std::atomic<bool>                  m_changed{false};
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "frame_pacer.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "nvutils/timers.hpp"
+#include "nvvk/check_error.hpp"
+
+#include "trace_recorder.hpp"
+
+namespace nvsamples {
+
+void FramePacer::init(VkDevice device, uint32_t framesInFlight /*= 2*/)
+{
+  m_device         = device;
+  m_framesInFlight = std::clamp(framesInFlight, 1U, kMaxFramesInFlight);
+  m_frameNumber    = 0;
+  m_frameSlot      = 0;
+
+  VkSemaphoreTypeCreateInfo typeInfo{
+      .sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue  = 0,
+  };
+  const VkSemaphoreCreateInfo createInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &typeInfo};
+  NVVK_CHECK(vkCreateSemaphore(m_device, &createInfo, nullptr, &m_timeline));
+}
+
+void FramePacer::deinit()
+{
+  if(m_timeline != VK_NULL_HANDLE)
+    vkDestroySemaphore(m_device, m_timeline, nullptr);
+  m_timeline = VK_NULL_HANDLE;
+}
+
+void FramePacer::setFramesInFlight(uint32_t framesInFlight)
+{
+  framesInFlight = std::clamp(framesInFlight, 1U, kMaxFramesInFlight);
+  if(framesInFlight == m_framesInFlight)
+    return;
+  waitIdle();
+  m_framesInFlight = framesInFlight;
+}
+
+uint32_t FramePacer::beginFrame()
+{
+  m_frameNumber++;
+  m_frameSlot = uint32_t(m_frameNumber % m_framesInFlight);
+
+  // The slot was last used by the frame `framesInFlight` frames ago
+  TRACE_SCOPE("FramePacer::beginFrame");
+  nvutils::PerformanceTimer timer;
+  if(m_frameNumber > m_framesInFlight)
+    waitFrame(m_frameNumber - m_framesInFlight);
+  m_lastWaitTime = timer.getMilliseconds();
+  return m_frameSlot;
+}
+
+VkSemaphoreSubmitInfo FramePacer::getSignalInfo() const
+{
+  return {
+      .sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+      .semaphore = m_timeline,
+      .value     = m_frameNumber,
+      .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+  };
+}
+
+uint64_t FramePacer::getCompletedFrame() const
+{
+  uint64_t value = 0;
+  NVVK_CHECK(vkGetSemaphoreCounterValue(m_device, m_timeline, &value));
+  return value;
+}
+
+void FramePacer::waitIdle()
+{
+  waitFrame(m_frameNumber);
+}
+
+void FramePacer::waitFrame(uint64_t frameNumber)
+{
+  if(frameNumber == 0)
+    return;
+  const VkSemaphoreWaitInfo waitInfo{
+      .sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .semaphoreCount = 1,
+      .pSemaphores    = &m_timeline,
+      .pValues        = &frameNumber,
+  };
+  NVVK_CHECK(vkWaitSemaphores(m_device, &waitInfo, std::numeric_limits<uint64_t>::max()));
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan_core.h>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// Pacing of the frames in flight with a timeline semaphore
+//
+// The per-frame resources (dynamic buffers, command pools) are allocated for kMaxFramesInFlight slots
+// and frame N uses slot N % framesInFlight. Each frame signals its number on the timeline when the GPU
+// is done with it, so before writing the resources of a slot, beginFrame() only waits for the frame
+// which used that slot `framesInFlight` frames ago: the CPU records frame N+1 while the GPU executes N.
+//
+// Usage per frame:
+//   const uint32_t slot = pacer.beginFrame();             // Waits until the slot is free
+//   ... write the resources of `slot`, record the commands ...
+//   app->addSignalSemaphore(pacer.getSignalInfo());      // The submission of the frame signals its number
+class FramePacer
+{
+public:
+  static constexpr uint32_t kMaxFramesInFlight = 4;
+
+  void init(VkDevice device, uint32_t framesInFlight = 2);
+  void deinit();
+
+  // Change the depth of the pipelining, waits for the frames in flight (the slots are reassigned).
+  // To call between frames, when the last begun frame has been submitted.
+  void     setFramesInFlight(uint32_t framesInFlight);
+  uint32_t getFramesInFlight() const { return m_framesInFlight; }
+
+  // Start a new frame: wait until the GPU is done with the previous use of its slot and return the slot
+  uint32_t beginFrame();
+
+  // Signal operation of the current frame, to add to the submission of its command buffers
+  VkSemaphoreSubmitInfo getSignalInfo() const;
+
+  uint32_t getFrameSlot() const { return m_frameSlot; }
+  uint64_t getFrameNumber() const { return m_frameNumber; }
+
+  // Last frame the GPU is done with, without waiting (resources used up to this frame can be destroyed)
+  uint64_t getCompletedFrame() const;
+
+  // Wait until the GPU is done with all the frames begun so far
+  void waitIdle();
+
+  // CPU time blocked in the last beginFrame(), in milliseconds (0 when the GPU keeps up)
+  double getLastWaitTime() const { return m_lastWaitTime; }
+
+private:
+  void waitFrame(uint64_t frameNumber);
+
+  VkDevice    m_device{};
+  VkSemaphore m_timeline{};           // Value N is signaled when the GPU is done with frame N
+  uint32_t    m_framesInFlight = 2;
+  uint64_t    m_frameNumber    = 0;   // Current frame, numbered from 1
+  uint32_t    m_frameSlot      = 0;   // Slot of the current frame
+  double      m_lastWaitTime   = 0.0;
+};
+
+}  // namespace nvsamples
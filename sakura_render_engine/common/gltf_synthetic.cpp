@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "gltf_synthetic.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+
+#include <glm/glm.hpp>
+
+namespace nvsamples {
+
+namespace {
+
+// Append the data to the buffer with a buffer view and an accessor, returns the accessor index
+template <typename T>
+int appendAccessor(tinygltf::Model& model, std::span<const T> data, int type, int componentType, int target)
+{
+  std::vector<unsigned char>& buffer = model.buffers[0].data;
+  const size_t                offset = buffer.size();
+  buffer.resize(offset + data.size_bytes());
+  memcpy(buffer.data() + offset, data.data(), data.size_bytes());
+
+  tinygltf::BufferView bufferView;
+  bufferView.buffer     = 0;
+  bufferView.byteOffset = offset;
+  bufferView.byteLength = data.size_bytes();
+  bufferView.target     = target;
+  model.bufferViews.push_back(bufferView);
+
+  tinygltf::Accessor accessor;
+  accessor.bufferView    = int(model.bufferViews.size() - 1);
+  accessor.componentType = componentType;
+  accessor.count = data.size_bytes() / (tinygltf::GetComponentSizeInBytes(componentType) * tinygltf::GetNumComponentsInType(type));
+  accessor.type  = type;
+  model.accessors.push_back(accessor);
+  return int(model.accessors.size() - 1);
+}
+
+}  // namespace
+
+tinygltf::Model makeSyntheticGltf(const SyntheticGltfSettings& settings)
+{
+  tinygltf::Model model;
+  model.asset.version = "2.0";
+  model.buffers.resize(1);
+
+  const uint32_t gridSize  = std::max(settings.gridSize, 2U);
+  const uint32_t meshCount = std::max(settings.meshCount, 1U);
+  for(uint32_t meshIndex = 0; meshIndex < meshCount; meshIndex++)
+  {
+    // Grid in the XZ plane, slightly different for each mesh
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    const float            height = float(meshIndex) * 0.01F;
+    for(uint32_t z = 0; z < gridSize; z++)
+    {
+      for(uint32_t x = 0; x < gridSize; x++)
+      {
+        const glm::vec2 uv = glm::vec2(float(x), float(z)) / float(gridSize - 1);
+        positions.emplace_back(uv.x - 0.5F, height, uv.y - 0.5F);
+        normals.emplace_back(0.0F, 1.0F, 0.0F);
+        texCoords.push_back(uv);
+      }
+    }
+    std::vector<uint32_t> indices;
+    for(uint32_t z = 0; z + 1 < gridSize; z++)
+    {
+      for(uint32_t x = 0; x + 1 < gridSize; x++)
+      {
+        const uint32_t i = z * gridSize + x;
+        indices.insert(indices.end(), {i, i + gridSize, i + 1, i + 1, i + gridSize, i + gridSize + 1});
+      }
+    }
+
+    tinygltf::Primitive primitive;
+    primitive.mode                   = TINYGLTF_MODE_TRIANGLES;
+    primitive.indices                = appendAccessor(model, std::span<const uint32_t>(indices), TINYGLTF_TYPE_SCALAR,
+                                                      TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT, TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER);
+    primitive.attributes["POSITION"] = appendAccessor(model, std::span<const glm::vec3>(positions), TINYGLTF_TYPE_VEC3,
+                                                      TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TARGET_ARRAY_BUFFER);
+    primitive.attributes["NORMAL"]   = appendAccessor(model, std::span<const glm::vec3>(normals), TINYGLTF_TYPE_VEC3,
+                                                      TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TARGET_ARRAY_BUFFER);
+    primitive.attributes["TEXCOORD_0"] = appendAccessor(model, std::span<const glm::vec2>(texCoords), TINYGLTF_TYPE_VEC2,
+                                                        TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TARGET_ARRAY_BUFFER);
+    model.accessors[primitive.attributes["POSITION"]].minValues = {-0.5, height, -0.5};
+    model.accessors[primitive.attributes["POSITION"]].maxValues = {0.5, height, 0.5};
+
+    tinygltf::Mesh mesh;
+    mesh.primitives.push_back(primitive);
+    model.meshes.push_back(mesh);
+  }
+  model.buffers[0].data.resize((model.buffers[0].data.size() + 3) & ~size_t(3));
+
+  // Hierarchy of nodes, each one offset from its parent
+  const uint32_t nodeCount = std::max(settings.nodeCount, 1U);
+  const uint32_t fanOut    = std::max(settings.fanOut, 1U);
+  model.nodes.resize(nodeCount);
+  for(uint32_t i = 0; i < nodeCount; i++)
+  {
+    tinygltf::Node& node = model.nodes[i];
+    node.mesh            = int(i % meshCount);
+    if(i > 0)
+    {
+      node.translation = {double(i % fanOut) - 0.5 * (fanOut - 1), 0.0, 1.0};
+      model.nodes[(i - 1) / fanOut].children.push_back(int(i));
+    }
+  }
+
+  tinygltf::Scene scene;
+  scene.nodes = {0};
+  model.scenes.push_back(scene);
+  model.defaultScene = 0;
+  return model;
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <cstdint>
+
+#include "tinygltf/tiny_gltf.h"
+
+namespace nvsamples {
+
+// Size of a generated glTF model
+struct SyntheticGltfSettings
+{
+  uint32_t nodeCount = 1;   // Nodes of the hierarchy, each one instancing a mesh
+  uint32_t meshCount = 1;   // Meshes, of one triangle primitive each
+  uint32_t gridSize  = 16;  // Vertices per side of the grid of each mesh (gridSize^2 vertices)
+  uint32_t fanOut    = 4;   // Children per node, the depth of the hierarchy is log(nodeCount) in this base
+};
+
+//--------------------------------------------------------------------------------------------------
+// glTF model made of grids, with the layout importGltfData reads in place (float attributes, 32-bit indices)
+// and a node hierarchy, to measure the loading and the import at sizes not covered by the assets.
+// The node i is the child of the node (i - 1) / fanOut and instances the mesh i % meshCount.
+tinygltf::Model makeSyntheticGltf(const SyntheticGltfSettings& settings);
+
+}  // namespace nvsamples
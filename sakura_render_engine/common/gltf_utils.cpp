@@ -21,17 +21,367 @@
 
 #include <span>
 #include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <functional>
 
 #include <glm/gtc/type_ptr.hpp>  // glm::make_vec3
 #include <vulkan/vulkan_core.h>
 #include <fmt/format.h>
+#include <stb/stb_image.h>
 
 #include "nvutils/timers.hpp"
 #include "nvutils/logger.hpp"
 #include "nvvk/check_error.hpp"
 #include "nvvk/debug_util.hpp"
 
+#include "attribute_convert.hpp"
+#include "job_system.hpp"
+#include "mesh_optimize.hpp"
+#include "mesh_simplify.hpp"
+#include "meshopt_decoder.hpp"
+#include "meshlet_builder.hpp"
+#include "trace_recorder.hpp"
+#include "vertex_quantize.hpp"
+
+// Append data to the generated part of the mesh buffer, returns its offset in the buffer
+using AppendDataFunc = std::function<uint32_t(const void* data, size_t size)>;
+
+// Store a triangle list with the index type of the mesh
+static shaderio::BufferView appendIndexData(const AppendDataFunc& appendData, std::span<const uint32_t> indices, int indexType)
+{
+  shaderio::BufferView view{.count = uint32_t(indices.size())};
+  if(indexType == VK_INDEX_TYPE_UINT16)
+  {
+    std::vector<uint16_t> indices16(indices.begin(), indices.end());
+    view.offset     = appendData(indices16.data(), std::span(indices16).size_bytes());
+    view.byteStride = sizeof(uint16_t);
+  }
+  else
+  {
+    view.offset     = appendData(indices.data(), indices.size_bytes());
+    view.byteStride = sizeof(uint32_t);
+  }
+  return view;
+}
+
+static nvsamples::ComponentType toComponentType(int gltfComponentType)
+{
+  switch(gltfComponentType)
+  {
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+      return nvsamples::ComponentType::eInt8;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+      return nvsamples::ComponentType::eUint8;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+      return nvsamples::ComponentType::eInt16;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+      return nvsamples::ComponentType::eUint16;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+      return nvsamples::ComponentType::eUint32;
+    default:
+      return nvsamples::ComponentType::eFloat;
+  }
+}
+
+// True if the accessor can be read in place by the shaders: `numComponents` floats per element, without sparse substitution
+static bool isGpuLayoutAccessor(const tinygltf::Accessor& acc, uint32_t numComponents)
+{
+  return acc.bufferView >= 0 && !acc.sparse.isSparse && acc.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT
+         && uint32_t(tinygltf::GetNumComponentsInType(acc.type)) == numComponents;
+}
+
+// Read an accessor (VEC2, VEC3, ...) into a tightly packed float array, honoring the buffer view stride.
+// Integer components are converted as in KHR_mesh_quantization: normalized ones to [0,1] or [-1,1], the others as is.
+// Missing components are set to 0 (1 for the 4th one), extra components are ignored.
+// Accessors without buffer view are zeros, sparse accessors have their substituted elements applied.
+static std::vector<float> readAccessorAsFloat(const tinygltf::Model& model, int accessorIndex, uint32_t numComponents)
+{
+  const tinygltf::Accessor&     acc           = model.accessors[accessorIndex];
+  const nvsamples::ComponentType type          = toComponentType(acc.componentType);
+  const uint32_t                srcComponents = uint32_t(tinygltf::GetNumComponentsInType(acc.type));
+
+  std::vector<float> result(acc.count * numComponents, 0.0F);
+  if(acc.bufferView >= 0)
+  {
+    const tinygltf::BufferView& bv   = model.bufferViews[acc.bufferView];
+    const unsigned char*        data = model.buffers[bv.buffer].data.data() + bv.byteOffset + acc.byteOffset;
+    nvsamples::convertElementsToFloat(result, numComponents, data, acc.ByteStride(bv), srcComponents, type, acc.normalized, acc.count);
+  }
+  else if(numComponents == 4)
+  {
+    for(size_t i = 0; i < acc.count; i++)
+      result[i * 4 + 3] = 1.0F;
+  }
+
+  if(acc.sparse.isSparse)
+  {
+    const tinygltf::BufferView& indexView = model.bufferViews[acc.sparse.indices.bufferView];
+    const tinygltf::BufferView& valueView = model.bufferViews[acc.sparse.values.bufferView];
+
+    std::vector<uint32_t> indices(acc.sparse.count);
+    nvsamples::convertIndices(indices.data(),
+                              model.buffers[indexView.buffer].data.data() + indexView.byteOffset + acc.sparse.indices.byteOffset,
+                              indices.size(), toComponentType(acc.sparse.indices.componentType));
+
+    // The substituted values are tightly packed, with the component type of the accessor
+    std::vector<float> values(indices.size() * numComponents);
+    const unsigned char* data = model.buffers[valueView.buffer].data.data() + valueView.byteOffset + acc.sparse.values.byteOffset;
+    nvsamples::convertElementsToFloat(values, numComponents, data, nvsamples::componentSize(type) * srcComponents,
+                                      srcComponents, type, acc.normalized, indices.size());
+    for(size_t i = 0; i < indices.size(); i++)
+    {
+      if(indices[i] < acc.count)
+        memcpy(&result[size_t(indices[i]) * numComponents], &values[i * numComponents], numComponents * sizeof(float));
+    }
+  }
+  return result;
+}
+
+// Read a scalar index accessor (8, 16 or 32 bits) as 32-bit indices, sparse substitution included
+static std::vector<uint32_t> readIndexAccessor(const tinygltf::Model& model, int accessorIndex)
+{
+  const tinygltf::Accessor& acc = model.accessors[accessorIndex];
+  const size_t              size = tinygltf::GetComponentSizeInBytes(acc.componentType);
+
+  // Reads `count` indices `stride` bytes apart
+  auto read = [&](const unsigned char* data, size_t stride, size_t count, int componentType) {
+    std::vector<uint32_t> result(count);
+    std::vector<uint8_t>  packed;
+    if(stride != size_t(tinygltf::GetComponentSizeInBytes(componentType)))
+    {
+      const size_t packedSize = tinygltf::GetComponentSizeInBytes(componentType);
+      packed.resize(count * packedSize);
+      for(size_t i = 0; i < count; i++)
+        memcpy(packed.data() + i * packedSize, data + i * stride, packedSize);
+      data = packed.data();
+    }
+    nvsamples::convertIndices(result.data(), data, count, toComponentType(componentType));
+    return result;
+  };
+
+  std::vector<uint32_t> indices(acc.count, 0);
+  if(acc.bufferView >= 0)
+  {
+    const tinygltf::BufferView& bv = model.bufferViews[acc.bufferView];
+    indices = read(model.buffers[bv.buffer].data.data() + bv.byteOffset + acc.byteOffset, acc.ByteStride(bv), acc.count,
+                   acc.componentType);
+  }
+
+  if(acc.sparse.isSparse)
+  {
+    const tinygltf::BufferView& indexView = model.bufferViews[acc.sparse.indices.bufferView];
+    const tinygltf::BufferView& valueView = model.bufferViews[acc.sparse.values.bufferView];
+    const size_t indexSize = tinygltf::GetComponentSizeInBytes(acc.sparse.indices.componentType);
+    const std::vector<uint32_t> targets =
+        read(model.buffers[indexView.buffer].data.data() + indexView.byteOffset + acc.sparse.indices.byteOffset,
+             indexSize, acc.sparse.count, acc.sparse.indices.componentType);
+    const std::vector<uint32_t> values =
+        read(model.buffers[valueView.buffer].data.data() + valueView.byteOffset + acc.sparse.values.byteOffset, size,
+             acc.sparse.count, acc.componentType);
+    for(size_t i = 0; i < targets.size(); i++)
+    {
+      if(targets[i] < acc.count)
+        indices[targets[i]] = values[i];
+    }
+  }
+  return indices;
+}
+
+// Build the levels of detail of a mesh. The simplification preserves the normal and texture coordinate
+// discontinuities, and the attribute differences are weighted to stay below the geometric error.
+static std::vector<nvsamples::MeshLod> generateGltfMeshLods(const tinygltf::Model&                model,
+                                                            int                                   meshIndex,
+                                                            std::span<const glm::vec3>            positions,
+                                                            std::span<const uint32_t>             indices,
+                                                            const nvsamples::GltfImportSettings& settings)
+{
+  const tinygltf::Primitive& primitive = model.meshes[meshIndex].primitives.front();
+
+  // Interleave the normals (3 floats) and texture coordinates (2 floats) when present
+  std::vector<float> normals, texCoords;
+  if(primitive.attributes.contains("NORMAL"))
+    normals = readAccessorAsFloat(model, primitive.attributes.at("NORMAL"), 3);
+  if(primitive.attributes.contains("TEXCOORD_0"))
+    texCoords = readAccessorAsFloat(model, primitive.attributes.at("TEXCOORD_0"), 2);
+
+  std::vector<float> weights;
+  weights.insert(weights.end(), normals.empty() ? 0 : 3, 0.01F);
+  weights.insert(weights.end(), texCoords.empty() ? 0 : 2, 0.01F);
+
+  std::vector<float> attributes;
+  attributes.reserve(positions.size() * weights.size());
+  for(size_t v = 0; v < positions.size() && !weights.empty(); v++)
+  {
+    if(!normals.empty())
+      attributes.insert(attributes.end(), &normals[v * 3], &normals[v * 3] + 3);
+    if(!texCoords.empty())
+      attributes.insert(attributes.end(), &texCoords[v * 2], &texCoords[v * 2] + 2);
+  }
+
+  return nvsamples::generateMeshLods(indices, positions, {attributes, weights}, settings.maxLodCount, settings.lodReduction);
+}
+
+// Optimize a mesh for the GPU: the triangles are reordered for the post-transform cache and the overdraw, then the
+// vertices are reordered in the order of the index buffer, since the vertex shader pulls the attributes itself.
+// The positions, indices and levels of detail are remapped to the new vertex order, the vertices only used by the
+// levels of detail follow the ones of the full resolution mesh. `remap` gives the new index of each original vertex
+// (the attributes are written later).
+static void optimizeGltfMesh(int meshIndex, nvsamples::GltfMeshGeometry& geometry)
+{
+  std::vector<glm::vec3>& positions = geometry.positions;
+  std::vector<uint32_t>&  indices   = geometry.indices;
+  const nvsamples::VertexCacheStats before = nvsamples::analyzeVertexCache(indices, positions.size());
+
+  nvsamples::optimizeVertexCache(indices, positions.size());
+  nvsamples::optimizeOverdraw(indices, positions);
+  std::vector<std::span<uint32_t>> lodIndices;
+  for(nvsamples::MeshLod& lod : geometry.lods)
+    lodIndices.push_back(lod.indices);
+  size_t usedVertexCount = 0;
+  geometry.remap         = nvsamples::optimizeVertexFetch(indices, positions.size(), usedVertexCount, lodIndices);
+
+  const nvsamples::VertexCacheStats after = nvsamples::analyzeVertexCache(indices, usedVertexCount);
+  LOGI("Mesh %d: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, %zu -> %zu vertices\n", meshIndex, before.acmr, after.acmr,
+       before.atvr, after.atvr, positions.size(), usedVertexCount);
+
+  for(nvsamples::MeshLod& lod : geometry.lods)
+    nvsamples::optimizeVertexCache(lod.indices, usedVertexCount);
+
+  std::vector<glm::vec3> reorderedPositions(usedVertexCount);
+  for(size_t v = 0; v < positions.size(); v++)
+  {
+    if(geometry.remap[v] != ~0U)
+      reorderedPositions[geometry.remap[v]] = positions[v];
+  }
+  positions = std::move(reorderedPositions);
+}
+
+// Write the vertex attributes of a mesh in the generated data when they cannot be used in place from the glTF buffer:
+// when the vertices were reordered (remap), when they are compressed (quantize), or when they are not in the layout read
+// by the shaders (integer or normalized components as in KHR_mesh_quantization, other component counts, sparse
+// accessors), in which case they are converted to floats or to the compact encodings.
+static void writeGltfVertexAttributes(const tinygltf::Model&    model,
+                                      int                       meshIndex,
+                                      shaderio::GltfMesh&       mesh,
+                                      std::span<const uint32_t> remap,
+                                      bool                      quantize,
+                                      const AppendDataFunc&     appendData)
+{
+  const tinygltf::Primitive& primitive = model.meshes[meshIndex].primitives.front();
+
+  // Vertex count after the reordering (unused vertices are dropped)
+  size_t vertexCount = model.accessors[primitive.attributes.at("POSITION")].count;
+  if(!remap.empty())
+    vertexCount = std::count_if(remap.begin(), remap.end(), [](uint32_t r) { return r != ~0U; });
+
+  // Read an attribute as floats, in the new vertex order
+  auto readAttribute = [&](int accessorIndex, uint32_t numComponents) {
+    std::vector<float> values = readAccessorAsFloat(model, accessorIndex, numComponents);
+    if(remap.empty())
+      return values;
+    std::vector<float> reordered(vertexCount * numComponents);
+    for(size_t v = 0; v < remap.size(); v++)
+    {
+      if(remap[v] != ~0U)
+        memcpy(&reordered[remap[v] * numComponents], &values[v * numComponents], numComponents * sizeof(float));
+    }
+    return reordered;
+  };
+
+  auto writeAttribute = [&](const char* name, shaderio::BufferView& attr, uint32_t numComponents, auto&& encode) {
+    if(!primitive.attributes.contains(name))
+      return;
+    const int                 accessorIndex = primitive.attributes.at(name);
+    const tinygltf::Accessor& acc           = model.accessors[accessorIndex];
+    if(isGpuLayoutAccessor(acc, numComponents) && remap.empty() && !quantize)
+      return;  // Used in place
+
+    const std::vector<float> values = readAttribute(accessorIndex, numComponents);
+    if(quantize)
+    {
+      encode(values, attr);
+    }
+    else
+    {
+      attr = {.offset     = appendData(values.data(), std::span(values).size_bytes()),
+              .count      = uint32_t(vertexCount),
+              .byteStride = uint32_t(numComponents * sizeof(float)),
+              .format     = shaderio::eVertexFloat};
+    }
+  };
+
+  auto appendEncoded = [&](const auto& encoded, uint32_t format) {
+    return shaderio::BufferView{.offset     = appendData(encoded.data(), std::span(encoded).size_bytes()),
+                                .count      = uint32_t(vertexCount),
+                                .byteStride = uint32_t(std::span(encoded).size_bytes() / std::max<size_t>(vertexCount, 1)),
+                                .format     = format};
+  };
+
+  writeAttribute("POSITION", mesh.triMesh.positions, 3, [&](const std::vector<float>& values, shaderio::BufferView& attr) {
+    const std::span<const glm::vec3> positions(reinterpret_cast<const glm::vec3*>(values.data()), vertexCount);
+    glm::vec3                        offset, scale;
+    nvsamples::computePositionQuantization(positions, offset, scale);
+    mesh.positionOffset = offset;
+    mesh.positionScale  = scale;
+    attr                = appendEncoded(nvsamples::encodePositionsSnorm16(positions, offset, scale), shaderio::eVertexSnorm16);
+  });
+  writeAttribute("NORMAL", mesh.triMesh.normals, 3, [&](const std::vector<float>& values, shaderio::BufferView& attr) {
+    const std::span<const glm::vec3> normals(reinterpret_cast<const glm::vec3*>(values.data()), vertexCount);
+    attr = appendEncoded(nvsamples::encodeNormalsOctahedral(normals), shaderio::eVertexOctahedral16);
+  });
+  writeAttribute("COLOR_0", mesh.triMesh.colorVert, 4, [&](const std::vector<float>& values, shaderio::BufferView& attr) {
+    const std::span<const glm::vec4> colors(reinterpret_cast<const glm::vec4*>(values.data()), vertexCount);
+    attr = appendEncoded(nvsamples::encodeColorsUnorm8(colors), shaderio::eVertexUnorm8);
+  });
+  writeAttribute("TEXCOORD_0", mesh.triMesh.texCoords, 2, [&](const std::vector<float>& values, shaderio::BufferView& attr) {
+    const std::span<const glm::vec2> texCoords(reinterpret_cast<const glm::vec2*>(values.data()), vertexCount);
+    attr = appendEncoded(nvsamples::encodeTexCoordsHalf(texCoords), shaderio::eVertexHalf);
+  });
+  writeAttribute("TANGENT", mesh.triMesh.tangents, 4, [&](const std::vector<float>& values, shaderio::BufferView& attr) {
+    const std::span<const glm::vec4> tangents(reinterpret_cast<const glm::vec4*>(values.data()), vertexCount);
+    attr = appendEncoded(nvsamples::encodeTangentsOctahedral(tangents), shaderio::eVertexOctahedral16);
+  });
+}
+
+// Partition the mesh in meshlets for the task/mesh shader path, and store the meshlets, their vertex indices and
+// their local triangles in the generated data
+static void buildGltfMeshlets(std::span<const glm::vec3> positions,
+                              std::span<const uint32_t>  indices,
+                              shaderio::GltfMesh&        mesh,
+                              const AppendDataFunc&      appendData)
+{
+  static_assert(nvsamples::kMeshletMaxVertices == MESHLET_MAX_VERTICES && nvsamples::kMeshletMaxTriangles == MESHLET_MAX_TRIANGLES);
+  const nvsamples::MeshletMesh meshletMesh = nvsamples::buildMeshlets(indices, positions);
+
+  std::vector<shaderio::GltfMeshlet> meshlets;
+  meshlets.reserve(meshletMesh.meshlets.size());
+  for(const nvsamples::Meshlet& meshlet : meshletMesh.meshlets)
+  {
+    meshlets.push_back({
+        .center         = meshlet.bounds.center,
+        .radius         = meshlet.bounds.radius,
+        .coneApex       = meshlet.bounds.coneApex,
+        .coneCutoff     = meshlet.bounds.coneCutoff,
+        .coneAxis       = meshlet.bounds.coneAxis,
+        .vertexOffset   = meshlet.vertexOffset,
+        .triangleOffset = meshlet.triangleOffset,
+        .vertexCount    = meshlet.vertexCount,
+        .triangleCount  = meshlet.triangleCount,
+    });
+  }
+
+  mesh.meshlets = {.offset     = appendData(meshlets.data(), std::span(meshlets).size_bytes()),
+                   .count      = uint32_t(meshlets.size()),
+                   .byteStride = sizeof(shaderio::GltfMeshlet)};
+  mesh.meshletVertices  = {.offset     = appendData(meshletMesh.vertices.data(), std::span(meshletMesh.vertices).size_bytes()),
+                           .count      = uint32_t(meshletMesh.vertices.size()),
+                           .byteStride = sizeof(uint32_t)};
+  mesh.meshletTriangles = {.offset     = appendData(meshletMesh.triangles.data(), meshletMesh.triangles.size()),
+                           .count      = uint32_t(meshletMesh.triangles.size() / 3),
+                           .byteStride = 3};
+}
+
 
 // This is a utility function to convert a primitive mesh to a GltfMeshResource.
 void nvsamples::primitiveMeshToResource(GltfSceneResource&            sceneResource,
@@ -59,7 +409,7 @@ void nvsamples::primitiveMeshToResource(GltfSceneResource&            sceneResou
   stagingUploader.appendBuffer(gltfData, verticesSize, std::span(primMesh.triangles));
 
   // Set up the TriangleMesh structure with proper BufferView offsets
-  shaderio::GltfMesh mesh;
+  shaderio::GltfMesh mesh{};
   mesh.triMesh.positions = {.offset     = 0,
                             .count      = static_cast<uint32_t>(primMesh.vertices.size()),
                             .byteStride = sizeof(nvutils::PrimitiveVertex)};
@@ -81,15 +431,191 @@ void nvsamples::primitiveMeshToResource(GltfSceneResource&            sceneResou
   mesh.gltfBuffer = (uint8_t*)gltfData.address;
   mesh.indexType  = VK_INDEX_TYPE_UINT32;  // Assuming uint32_t indices
   sceneResource.meshes.push_back(mesh);
+
+  nvutils::Bbox bounds;
+  for(const nvutils::PrimitiveVertex& vertex : primMesh.vertices)
+    bounds.insert(vertex.pos);
+  sceneResource.meshBounds.push_back(bounds);
+  sceneResource.meshLods.emplace_back();
+  sceneResource.meshBufferIndex.push_back(uint32_t(sceneResource.bGltfDatas.size() - 1));
+}
+
+// Decode the buffer views compressed with EXT_meshopt_compression into their fallback buffer, which then holds the
+// data of an uncompressed file. The streams are independent and decoded by parallel jobs.
+// The buffers holding only compressed data are released, so they are not uploaded by importGltfData.
+static bool decodeGltfMeshoptCompression(tinygltf::Model& model, const std::string& indent)
+{
+  constexpr const char* kExtensionName = "EXT_meshopt_compression";
+
+  struct Stream
+  {
+    std::span<const uint8_t> source;
+    uint8_t*                 destination = nullptr;
+    size_t                   count       = 0;
+    size_t                   byteStride  = 0;
+    nvsamples::MeshoptMode   mode        = nvsamples::MeshoptMode::eAttributes;
+    nvsamples::MeshoptFilter filter      = nvsamples::MeshoptFilter::eNone;
+  };
+
+  // Fallback buffers have no data in the file, allocate them
+  std::vector<size_t> bufferSizes(model.buffers.size());
+  for(size_t i = 0; i < model.buffers.size(); i++)
+    bufferSizes[i] = model.buffers[i].data.size();
+  for(const tinygltf::BufferView& bv : model.bufferViews)
+  {
+    if(bv.extensions.contains(kExtensionName))
+      bufferSizes[bv.buffer] = std::max(bufferSizes[bv.buffer], bv.byteOffset + bv.byteLength);
+  }
+  for(size_t i = 0; i < model.buffers.size(); i++)
+    model.buffers[i].data.resize(bufferSizes[i]);
+
+  std::vector<Stream> streams;
+  std::vector<bool>   isSourceBuffer(model.buffers.size(), false);
+  size_t              compressedSize = 0;
+  size_t              decodedSize    = 0;
+  for(tinygltf::BufferView& bv : model.bufferViews)
+  {
+    auto it = bv.extensions.find(kExtensionName);
+    if(it == bv.extensions.end())
+      continue;
+    const tinygltf::Value& ext = it->second;
+
+    const int    sourceBuffer = ext.Get("buffer").GetNumberAsInt();
+    const size_t byteOffset   = ext.Has("byteOffset") ? size_t(ext.Get("byteOffset").GetNumberAsInt()) : 0;
+    const size_t byteLength   = size_t(ext.Get("byteLength").GetNumberAsInt());
+    const std::string mode    = ext.Get("mode").Get<std::string>();
+    const std::string filter  = ext.Has("filter") ? ext.Get("filter").Get<std::string>() : "NONE";
+
+    Stream stream;
+    stream.count      = size_t(ext.Get("count").GetNumberAsInt());
+    stream.byteStride = size_t(ext.Get("byteStride").GetNumberAsInt());
+    stream.mode       = mode == "TRIANGLES" ? nvsamples::MeshoptMode::eTriangles :
+                        mode == "INDICES"   ? nvsamples::MeshoptMode::eIndices :
+                                              nvsamples::MeshoptMode::eAttributes;
+    stream.filter     = filter == "OCTAHEDRAL"  ? nvsamples::MeshoptFilter::eOctahedral :
+                        filter == "QUATERNION"  ? nvsamples::MeshoptFilter::eQuaternion :
+                        filter == "EXPONENTIAL" ? nvsamples::MeshoptFilter::eExponential :
+                                                  nvsamples::MeshoptFilter::eNone;
+
+    if(sourceBuffer < 0 || size_t(sourceBuffer) >= model.buffers.size()
+       || byteOffset + byteLength > model.buffers[sourceBuffer].data.size() || stream.count * stream.byteStride > bv.byteLength)
+    {
+      LOGE("Invalid %s buffer view\n", kExtensionName);
+      return false;
+    }
+    stream.source      = std::span<const uint8_t>(model.buffers[sourceBuffer].data).subspan(byteOffset, byteLength);
+    stream.destination = model.buffers[bv.buffer].data.data() + bv.byteOffset;
+    streams.push_back(stream);
+
+    isSourceBuffer[sourceBuffer] = true;
+    compressedSize += byteLength;
+    decodedSize += stream.count * stream.byteStride;
+    bv.extensions.erase(it);
+  }
+  if(streams.empty())
+    return true;
+
+  nvutils::PerformanceTimer timer;
+  std::atomic<bool>         success{true};
+  nvsamples::JobSystem&     jobs = nvsamples::JobSystem::getInstance();
+  jobs.parallelFor(uint32_t(streams.size()), 1, [&](uint32_t begin, uint32_t end) {
+    for(uint32_t i = begin; i < end; i++)
+    {
+      const Stream& stream = streams[i];
+      if(!nvsamples::decodeMeshoptStream(stream.destination, stream.count, stream.byteStride, stream.mode, stream.filter, stream.source))
+        success = false;
+    }
+  });
+  const uint32_t numThreads = std::min(jobs.getThreadCount(), uint32_t(streams.size()));
+  const double   seconds    = timer.getSeconds();
+
+  if(!success)
+  {
+    LOGE("Corrupted %s data\n", kExtensionName);
+    return false;
+  }
+  LOGI("%s", fmt::format("{}Decoded {} meshopt streams on {} threads: {:.2f} MB -> {:.2f} MB in {:.2f} ms ({:.0f} MB/s)\n",
+                         indent, streams.size(), numThreads, double(compressedSize) / (1024.0 * 1024.0),
+                         double(decodedSize) / (1024.0 * 1024.0), seconds * 1000.0,
+                         double(decodedSize) / (1024.0 * 1024.0) / std::max(seconds, 1e-9))
+                 .c_str());
+
+  // Release the compressed data, unless the buffer also holds uncompressed views (e.g. images)
+  std::vector<bool> isReferenced(model.buffers.size(), false);
+  for(const tinygltf::BufferView& bv : model.bufferViews)
+    isReferenced[bv.buffer] = true;
+  for(size_t i = 0; i < model.buffers.size(); i++)
+  {
+    if(isSourceBuffer[i] && !isReferenced[i])
+      model.buffers[i].data = {};
+  }
+
+  std::erase(model.extensionsUsed, kExtensionName);
+  std::erase(model.extensionsRequired, kExtensionName);
+  return true;
+}
+
+// Image loader of tinygltf keeping the encoded image (PNG, JPEG, ...), decoded after the load by decodeGltfImages()
+static bool storeEncodedGltfImage(tinygltf::Image* image, const int, std::string*, std::string*, int, int, const unsigned char* bytes, int size, void*)
+{
+  image->image.assign(bytes, bytes + size);
+  image->as_is = true;
+  return true;
+}
+
+// Decode the images kept encoded by storeEncodedGltfImage(), in parallel, to 4 components of 8 or 16 bits
+bool nvsamples::decodeGltfImages(tinygltf::Model& model, const std::string& indent /*= {}*/)
+{
+  std::vector<uint32_t> encodedImages;
+  for(size_t i = 0; i < model.images.size(); i++)
+  {
+    if(model.images[i].as_is && !model.images[i].image.empty())
+      encodedImages.push_back(uint32_t(i));
+  }
+  if(encodedImages.empty())
+    return true;
+
+  nvutils::PerformanceTimer timer;
+  std::atomic<bool>         success{true};
+  nvsamples::JobSystem::getInstance().parallelFor(uint32_t(encodedImages.size()), 1, [&](uint32_t begin, uint32_t end) {
+    for(uint32_t i = begin; i < end; i++)
+    {
+      tinygltf::Image& image = model.images[encodedImages[i]];
+      const stbi_uc*   bytes = image.image.data();
+      const int        size  = int(image.image.size());
+      const bool       is16  = stbi_is_16_bit_from_memory(bytes, size) != 0;
+      int              w = 0, h = 0, comp = 0;
+      void*            pixels = is16 ? static_cast<void*>(stbi_load_16_from_memory(bytes, size, &w, &h, &comp, 4)) :
+                                       static_cast<void*>(stbi_load_from_memory(bytes, size, &w, &h, &comp, 4));
+      if(pixels == nullptr)
+      {
+        success = false;
+        continue;
+      }
+      const size_t pixelSize = is16 ? 8 : 4;
+      image.width            = w;
+      image.height           = h;
+      image.component        = 4;
+      image.bits             = is16 ? 16 : 8;
+      image.pixel_type       = is16 ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+      image.image.assign(static_cast<const unsigned char*>(pixels), static_cast<const unsigned char*>(pixels) + size_t(w) * h * pixelSize);
+      image.as_is = false;
+      stbi_image_free(pixels);
+    }
+  });
+  LOGI("%s", fmt::format("{}Decoded {} images in {:.2f} ms\n", indent, encodedImages.size(), timer.getMilliseconds()).c_str());
+  return success;
 }
 
 tinygltf::Model nvsamples::loadGltfResources(const std::filesystem::path& filename)
 {
   nvutils::ScopedTimer _st(__FUNCTION__);
+  TRACE_SCOPE("loadGltfResources");
 
   tinygltf::TinyGLTF tinyLoader;
   tinygltf::Model    model;
   std::string        err, warn;
+  tinyLoader.SetImageLoader(storeEncodedGltfImage, nullptr);  // The images are decoded in parallel after the load
   if(filename.extension() == ".gltf")
   {
     if(!tinyLoader.LoadASCIIFromFile(&model, &err, &warn, filename.string()))
@@ -114,6 +640,12 @@ tinygltf::Model nvsamples::loadGltfResources(const std::filesystem::path& filena
     assert(0 && "No fallback");
     return {};
   }
+  if(!decodeGltfMeshoptCompression(model, _st.indent()) || !decodeGltfImages(model, _st.indent()))
+  {
+    LOGE("Error decoding glTF file: %s\n", filename.string().c_str());
+    assert(0 && "No fallback");
+    return {};
+  }
   LOGI("%s", fmt::format("\n{}Loaded glTF file: {}", _st.indent(), filename.string()).c_str());
   return model;
 }
@@ -122,52 +654,161 @@ tinygltf::Model nvsamples::loadGltfResources(const std::filesystem::path& filena
 // It is a very simple function that just imports the GLTF data into the scene resource.
 // It has strong limitations, like the mesh must have only one primitive, and the primitive must be a triangle primitive.
 // But it allow to import the GLTF data into the scene resource with a single function call, and call it again to import another scene.
-void nvsamples::importGltfData(GltfSceneResource&     sceneResource,
-                               const tinygltf::Model& model,
-                               nvvk::StagingUploader& stagingUploader,
-                               bool                   importInstance /*= false*/)
+//
+// Data generated at import time (e.g. the levels of detail) is appended after the glTF buffers, in the same GPU buffer,
+// so every BufferView of a mesh refers to bGltfData.
+void nvsamples::importGltfData(GltfSceneResource&        sceneResource,
+                               const tinygltf::Model&    model,
+                               nvvk::StagingUploader&    stagingUploader,
+                               bool                      importInstance /*= false*/,
+                               const GltfImportSettings& settings /*= {}*/)
 {
   SCOPED_TIMER(__FUNCTION__);
+  TRACE_SCOPE("importGltfData");
 
   const uint32_t meshOffset = uint32_t(sceneResource.meshes.size());
 
-  // Lambda for element byte size calculation
-  auto getElementByteSize = [](int type) -> uint32_t {
-    return type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? 2U :
-           type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT   ? 4U :
-           type == TINYGLTF_COMPONENT_TYPE_FLOAT          ? 4U :
-                                                            0U;
-  };
-
-  // Lambda for type size calculation
-  auto getTypeSize = [](int type) -> uint32_t {
-    return type == TINYGLTF_TYPE_VEC2 ? 2U :
-           type == TINYGLTF_TYPE_VEC3 ? 3U :
-           type == TINYGLTF_TYPE_VEC4 ? 4U :
-           type == TINYGLTF_TYPE_MAT2 ? 4U * 2U :
-           type == TINYGLTF_TYPE_MAT3 ? 4U * 3U :
-           type == TINYGLTF_TYPE_MAT4 ? 4U * 4U :
-                                        0U;
-  };
+  // The glTF buffers are stored back to back in the GPU buffer, each aligned to 16 bytes.
+  // Buffers left empty (e.g. the compressed data of EXT_meshopt_compression, once decoded) take no space.
+  std::vector<size_t> bufferOffsets(model.buffers.size());
+  size_t              gltfDataSize = 0;
+  for(size_t i = 0; i < model.buffers.size(); i++)
+  {
+    bufferOffsets[i] = gltfDataSize;
+    gltfDataSize += (model.buffers[i].data.size() + 15) & ~size_t(15);
+  }
 
   // Lambda for extracting attributes, like positions, normals, colors, etc.
-  auto extractAttribute = [&](const std::string& name, shaderio::BufferView& attr, const tinygltf::Primitive& primitive) {
+  // Attributes in another layout than the one read by the shaders are converted by writeGltfVertexAttributes.
+  auto extractAttribute = [&](const std::string& name, shaderio::BufferView& attr, const tinygltf::Primitive& primitive,
+                              uint32_t numComponents) {
     if(!primitive.attributes.contains(name))
     {
       attr.offset = -1;
       return;
     }
-    const tinygltf::Accessor&   acc = model.accessors[primitive.attributes.at(name)];
-    const tinygltf::BufferView& bv  = model.bufferViews[acc.bufferView];
-    assert((acc.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) && "Should be floats");
+    const tinygltf::Accessor& acc = model.accessors[primitive.attributes.at(name)];
+    if(!isGpuLayoutAccessor(acc, numComponents))
+    {
+      attr = {.offset = ~0U, .count = uint32_t(acc.count), .byteStride = 0, .format = shaderio::eVertexFloat};
+      return;
+    }
+    const tinygltf::BufferView& bv = model.bufferViews[acc.bufferView];
     attr = {
-        .offset = uint32_t(bv.byteOffset + acc.byteOffset),
-        .count  = uint32_t(acc.count),
-        .byteStride = uint32_t(bv.byteStride ? uint32_t(bv.byteStride) : getTypeSize(acc.type) * getElementByteSize(acc.componentType)),
+        .offset     = uint32_t(bufferOffsets[bv.buffer] + bv.byteOffset + acc.byteOffset),
+        .count      = uint32_t(acc.count),
+        .byteStride = uint32_t(acc.ByteStride(bv)),
+        .format     = shaderio::eVertexFloat,
     };
   };
 
 
+  // Generated data is stored after the glTF buffers, each block aligned to 16 bytes
+  std::vector<unsigned char> generatedData;
+  auto                       appendGeneratedData = [&](const void* data, size_t size) -> uint32_t {
+    const size_t offset = generatedData.size();
+    generatedData.resize((offset + size + 15) & ~size_t(15));
+    memcpy(generatedData.data() + offset, data, size);
+    return uint32_t(gltfDataSize + offset);
+  };
+
+  // CPU copy of the geometry and levels of detail of the meshes, for the data generated at import.
+  // The meshes are independent and processed by parallel jobs, their data is then appended in order.
+  std::vector<GltfMeshGeometry> geometries(model.meshes.size());
+  if(settings.generateLods || settings.optimizeMeshes || settings.buildMeshlets)
+  {
+    JobSystem::getInstance().parallelFor(uint32_t(model.meshes.size()), 1, [&](uint32_t begin, uint32_t end) {
+      for(uint32_t meshIdx = begin; meshIdx < end; meshIdx++)
+        geometries[meshIdx] = prepareGltfMeshGeometry(model, int(meshIdx), settings);
+    });
+  }
+
+  std::vector<shaderio::GltfMesh> meshes;
+  for(size_t meshIdx = 0; meshIdx < model.meshes.size(); ++meshIdx)
+  {
+    shaderio::GltfMesh mesh{};
+
+    const tinygltf::Mesh&      tinyMesh  = model.meshes[meshIdx];
+    const tinygltf::Primitive& primitive = tinyMesh.primitives.front();
+    assert((tinyMesh.primitives.size() == 1 && primitive.mode == TINYGLTF_MODE_TRIANGLES) && "Must have one triangle primitive");
+
+
+    // Extract indices: 16 and 32-bit indices are used in place when tightly packed, the others are converted
+    // (8-bit indices are widened to 16 bits, which does not require VK_KHR_index_type_uint8)
+    const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
+    assert((accessor.count % 3 == 0) && "Should be a multiple of 3");
+    mesh.indexType = accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+    const size_t indexSize = mesh.indexType == VK_INDEX_TYPE_UINT32 ? 4 : 2;
+    if(accessor.bufferView >= 0 && !accessor.sparse.isSparse && accessor.componentType != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
+       && size_t(accessor.ByteStride(model.bufferViews[accessor.bufferView])) == indexSize)
+    {
+      const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+      mesh.triMesh.indices = {
+          .offset     = uint32_t(bufferOffsets[bufferView.buffer] + bufferView.byteOffset + accessor.byteOffset),
+          .count      = uint32_t(accessor.count),
+          .byteStride = uint32_t(indexSize),
+      };
+    }
+    else
+    {
+      mesh.triMesh.indices = appendIndexData(appendGeneratedData, readIndexAccessor(model, primitive.indices), mesh.indexType);
+    }
+
+    // Extract attributes
+    extractAttribute("POSITION", mesh.triMesh.positions, primitive, 3);
+    extractAttribute("NORMAL", mesh.triMesh.normals, primitive, 3);
+    extractAttribute("COLOR_0", mesh.triMesh.colorVert, primitive, 4);
+    extractAttribute("TEXCOORD_0", mesh.triMesh.texCoords, primitive, 2);
+    extractAttribute("TANGENT", mesh.triMesh.tangents, primitive, 4);
+
+    // Geometry and levels of detail computed above, the levels index the vertices of the mesh
+    std::vector<glm::vec3>& positions = geometries[meshIdx].positions;
+    std::vector<uint32_t>&  indices   = geometries[meshIdx].indices;
+    std::vector<MeshLod>&   lods      = geometries[meshIdx].lods;
+    if(settings.generateLods)
+    {
+      LOGI("Mesh %zu: %zu LODs, %u triangles -> %zu triangles\n", meshIdx, lods.size(), mesh.triMesh.indices.count / 3,
+           lods.empty() ? size_t(mesh.triMesh.indices.count / 3) : lods.back().indices.size() / 3);
+    }
+
+    // Triangle and vertex order optimization (done above), replaces the index data of the mesh
+    const std::vector<uint32_t>& remap = geometries[meshIdx].remap;
+    if(settings.optimizeMeshes)
+      mesh.triMesh.indices = appendIndexData(appendGeneratedData, indices, mesh.indexType);
+
+    // Vertex data in the new order, compressed, or converted to floats
+    writeGltfVertexAttributes(model, int(meshIdx), mesh, remap, settings.quantizeVertices, appendGeneratedData);
+
+    // Meshlets of the full resolution mesh (after the optimization, which reorders the vertices)
+    if(settings.buildMeshlets)
+      buildGltfMeshlets(positions, indices, mesh, appendGeneratedData);
+
+    meshes.emplace_back(mesh);
+
+    // The index buffers of the levels of detail are stored with the same index type as the mesh
+    std::vector<GltfMeshLod> meshLods;
+    for(const MeshLod& lod : lods)
+      meshLods.push_back({.indices = appendIndexData(appendGeneratedData, lod.indices, mesh.indexType), .error = lod.error});
+    sceneResource.meshLods.emplace_back(std::move(meshLods));
+
+    // The POSITION accessor must have min and max (glTF specification), but they are the raw values of quantized
+    // accessors and do not include the sparse substitutions: the bounds are computed from the converted positions then
+    const tinygltf::Accessor& posAccessor = model.accessors[primitive.attributes.at("POSITION")];
+    nvutils::Bbox             bounds;
+    if(isGpuLayoutAccessor(posAccessor, 3) && posAccessor.minValues.size() == 3 && posAccessor.maxValues.size() == 3)
+    {
+      bounds.insert(glm::vec3(glm::make_vec3(posAccessor.minValues.data())));
+      bounds.insert(glm::vec3(glm::make_vec3(posAccessor.maxValues.data())));
+    }
+    else
+    {
+      const std::vector<float> values = readAccessorAsFloat(model, primitive.attributes.at("POSITION"), 3);
+      for(size_t i = 0; i + 2 < values.size(); i += 3)
+        bounds.insert(glm::vec3(values[i], values[i + 1], values[i + 2]));
+    }
+    sceneResource.meshBounds.emplace_back(bounds);
+  }
+
   // Upload the scene resource to the GPU
   nvvk::Buffer bGltfData;
   {
@@ -176,46 +817,27 @@ void nvsamples::importGltfData(GltfSceneResource&     sceneResource,
 
     // The GLTF buffer is used to store the geometry data (indices, positions, normals, etc.)
     // The flags are set to allow the buffer to be used as a vertex buffer, index buffer, storage buffer, and for acceleration structure build input read-only.
-    NVVK_CHECK(allocator->createBuffer(bGltfData, std::span<const unsigned char>(model.buffers[0].data).size_bytes(),
+    NVVK_CHECK(allocator->createBuffer(bGltfData, gltfDataSize + generatedData.size(),
                                        VK_BUFFER_USAGE_2_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_2_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT
                                            | VK_BUFFER_USAGE_2_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR));  // #RT
-    NVVK_CHECK(stagingUploader.appendBuffer(bGltfData, 0, std::span<const unsigned char>(model.buffers[0].data)));
+    for(size_t i = 0; i < model.buffers.size(); i++)
+    {
+      if(!model.buffers[i].data.empty())
+        NVVK_CHECK(stagingUploader.appendBuffer(bGltfData, bufferOffsets[i], std::span<const unsigned char>(model.buffers[i].data)));
+    }
+    if(!generatedData.empty())
+      NVVK_CHECK(stagingUploader.appendBuffer(bGltfData, gltfDataSize, std::span<const unsigned char>(generatedData)));
     NVVK_DBG_NAME(bGltfData.buffer);
 
     sceneResource.bGltfDatas.push_back(bGltfData);
   }
 
-  for(size_t meshIdx = 0; meshIdx < model.meshes.size(); ++meshIdx)
+  // Set the buffer address
+  for(shaderio::GltfMesh& mesh : meshes)
   {
-    shaderio::GltfMesh mesh{};
-
-    const tinygltf::Mesh&      tinyMesh  = model.meshes[meshIdx];
-    const tinygltf::Primitive& primitive = tinyMesh.primitives.front();
-    assert((tinyMesh.primitives.size() == 1 && primitive.mode == TINYGLTF_MODE_TRIANGLES) && "Must have one triangle primitive");
-
-
-    // Extract indices
-    auto& accessor   = model.accessors[primitive.indices];
-    auto& bufferView = model.bufferViews[accessor.bufferView];
-    assert((accessor.count % 3 == 0) && "Should be a multiple of 3");
-    mesh.triMesh.indices = {
-        .offset = uint32_t(bufferView.byteOffset + accessor.byteOffset),
-        .count  = uint32_t(accessor.count),
-        .byteStride = uint32_t(bufferView.byteStride ? bufferView.byteStride : getElementByteSize(accessor.componentType)),
-    };
-    mesh.indexType = accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
-
-    // Set the buffer address
     mesh.gltfBuffer = (uint8_t*)bGltfData.address;
-
-    // Extract attributes
-    extractAttribute("POSITION", mesh.triMesh.positions, primitive);
-    extractAttribute("NORMAL", mesh.triMesh.normals, primitive);
-    extractAttribute("COLOR_0", mesh.triMesh.colorVert, primitive);
-    extractAttribute("TEXCOORD_0", mesh.triMesh.texCoords, primitive);
-    extractAttribute("TANGENT", mesh.triMesh.tangents, primitive);
-
     sceneResource.meshes.emplace_back(mesh);
+    sceneResource.meshBufferIndex.push_back(uint32_t(sceneResource.bGltfDatas.size() - 1));  // One buffer for all the meshes of the file
   }
 
   if(importInstance)
@@ -258,10 +880,7 @@ void nvsamples::importGltfData(GltfSceneResource&     sceneResource,
         const tinygltf::Mesh&      tinyMesh  = model.meshes[node.mesh];
         const tinygltf::Primitive& primitive = tinyMesh.primitives.front();
         assert((tinyMesh.primitives.size() == 1 && primitive.mode == TINYGLTF_MODE_TRIANGLES) && "Must have one triangle primitive");
-        shaderio::GltfInstance instance{};
-        instance.meshIndex = node.mesh + meshOffset;
-        instance.transform = nodeTransform;
-        sceneResource.instances.push_back(instance);
+        sceneResource.instances.add(nodeTransform, node.mesh + meshOffset);
       }
 
       // Process children
@@ -302,6 +921,34 @@ void nvsamples::importGltfData(GltfSceneResource&     sceneResource,
   }
 }
 
+// Read the positions and the indices of the first primitive of a mesh.
+// The data is read from the CPU copy of the buffers, honoring the accessor strides and index types.
+nvsamples::GltfMeshGeometry nvsamples::prepareGltfMeshGeometry(const tinygltf::Model& model, int meshIndex, const GltfImportSettings& settings)
+{
+  GltfMeshGeometry geometry;
+  extractGltfMeshGeometry(model, meshIndex, geometry.positions, geometry.indices);
+  if(settings.generateLods)
+    geometry.lods = generateGltfMeshLods(model, meshIndex, geometry.positions, geometry.indices, settings);
+  if(settings.optimizeMeshes)
+    optimizeGltfMesh(meshIndex, geometry);
+  return geometry;
+}
+
+void nvsamples::extractGltfMeshGeometry(const tinygltf::Model& model, int meshIndex, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices)
+{
+  const tinygltf::Primitive& primitive = model.meshes[meshIndex].primitives.front();
+
+  // Positions
+  {
+    const std::vector<float> values = readAccessorAsFloat(model, primitive.attributes.at("POSITION"), 3);
+    positions.resize(values.size() / 3);
+    memcpy(positions.data(), values.data(), values.size() * sizeof(float));
+  }
+
+  // Indices
+  indices = readIndexAccessor(model, primitive.indices);
+}
+
 // This function creates the scene info buffer
 // It is consolidating all the mesh information into a single buffer, the same for the instances and materials.
 // This is to avoid having to create multiple buffers for the scene.
@@ -323,11 +970,12 @@ void nvsamples::createGltfSceneInfoBuffer(GltfSceneResource& sceneResource, nvvk
   NVVK_CHECK(stagingUploader.appendBuffer(sceneResource.bMeshes, 0, std::span<const shaderio::GltfMesh>(sceneResource.meshes)));
 
   // Create all instance buffers
-  allocator->createBuffer(sceneResource.bInstances, std::span(sceneResource.instances).size_bytes(),
+  std::vector<shaderio::GltfInstance> gpuInstances(sceneResource.instances.size());
+  sceneResource.instances.writeGpuInstances(gpuInstances);
+  allocator->createBuffer(sceneResource.bInstances, std::span(gpuInstances).size_bytes(),
                           VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_2_TRANSFER_DST_BIT | VK_BUFFER_USAGE_2_TRANSFER_SRC_BIT);
   NVVK_DBG_NAME(sceneResource.bInstances.buffer);
-  NVVK_CHECK(stagingUploader.appendBuffer(sceneResource.bInstances, 0,
-                                          std::span<const shaderio::GltfInstance>(sceneResource.instances)));
+  NVVK_CHECK(stagingUploader.appendBuffer(sceneResource.bInstances, 0, std::span<const shaderio::GltfInstance>(gpuInstances)));
 
   // Create all material buffers
   allocator->createBuffer(sceneResource.bMaterials, std::span(sceneResource.materials).size_bytes(),
@@ -21,10 +21,13 @@
 #pragma once
 
 #include <filesystem>
+#include <span>
 
 #include <glm/glm.hpp>
 
 #include "io_gltf.h"  // Contains definitions for GLTF GltfMesh, BufferView, TriangleMesh and more
+#include "instance_store.hpp"
+#include "mesh_simplify.hpp"
 
 #include "nvutils/bounding_box.hpp"
 #include "nvvk/resources.hpp"
@@ -34,12 +37,33 @@
 
 namespace nvsamples {
 
+// Options of importGltfData, for the data generated at import time
+struct GltfImportSettings
+{
+  bool     generateLods     = false;  // Build a chain of simplified index buffers for each mesh
+  uint32_t maxLodCount      = 5;      // Maximum number of levels, in addition to the full resolution mesh
+  float    lodReduction     = 0.5F;   // Triangle count ratio between two consecutive levels
+  bool     optimizeMeshes   = false;  // Reorder the triangles (vertex cache, overdraw) and the vertices (fetch locality)
+  bool     buildMeshlets    = false;  // Partition the meshes in meshlets, for the task/mesh shader path
+  bool     quantizeVertices = false;  // Store the vertex attributes in compact formats (see vertex_quantize.hpp)
+};
+
+// A simplified index buffer of a mesh, using the same vertices and index type as the full resolution mesh
+struct GltfMeshLod
+{
+  shaderio::BufferView indices;      // Indices, in the same buffer as the mesh (bGltfDatas)
+  float                error = 0.0F;  // Object space RMS distance to the full resolution mesh (MeshLod::error)
+};
+
 // Simple scene resource that holds meshes, instances, and materials
 struct GltfSceneResource
 {
   std::vector<shaderio::GltfMesh>              meshes;     // All meshes in the scene
-  std::vector<shaderio::GltfInstance>          instances;  // All instances in the scene
+  InstanceStore                                instances;  // All instances in the scene (structure of arrays)
   std::vector<shaderio::GltfMetallicRoughness> materials;  // All materials in the scene
+  std::vector<nvutils::Bbox>                   meshBounds; // Object space bounding box of each mesh
+  std::vector<std::vector<GltfMeshLod>>        meshLods;   // Levels of detail of each mesh (LOD 1..n), empty when not generated
+  std::vector<uint32_t>                        meshBufferIndex;  // Index in bGltfDatas of the buffer holding each mesh
   shaderio::GltfSceneInfo sceneInfo;  // Scene information (camera matrices, meshes, instances, materials, etc.)
 
   // GPU buffers for the scene data
@@ -51,13 +75,36 @@ struct GltfSceneResource
 };
 
 // This is a utility function to load a GLTF file and return the model data.
+// Buffer views compressed with EXT_meshopt_compression are decoded, the model is then the same as an uncompressed one.
 tinygltf::Model loadGltfResources(const std::filesystem::path& filename);
 
+// Decode the images of the model still holding their encoded file (image.as_is), to 4 components of 8 or 16 bits.
+// Called by loadGltfResources(), returns false when an image cannot be decoded.
+bool decodeGltfImages(tinygltf::Model& model, const std::string& indent = {});
+
 // This is a utility function to import the GLTF data into the scene resource.
-void importGltfData(GltfSceneResource&     sceneResource,
-                    const tinygltf::Model& model,
-                    nvvk::StagingUploader& stagingUploader,
-                    bool                   importInstance = false);
+void importGltfData(GltfSceneResource&        sceneResource,
+                    const tinygltf::Model&    model,
+                    nvvk::StagingUploader&    stagingUploader,
+                    bool                      importInstance = false,
+                    const GltfImportSettings& settings       = {});
+
+// This is a utility function to read back the positions and triangle indices of a mesh on the CPU.
+// (e.g. for occluders, which are rasterized by the CPU occlusion culler)
+void extractGltfMeshGeometry(const tinygltf::Model& model, int meshIndex, std::vector<glm::vec3>& positions, std::vector<uint32_t>& indices);
+
+// CPU geometry of a mesh as importGltfData prepares it for the generated data: levels of detail, then triangle and
+// vertex order optimization, depending on the settings. The indices of the mesh and of its levels address
+// `positions`; `remap` gives the new index of each vertex of the accessors (~0U when no list uses it), it is empty
+// when the vertices are not reordered.
+struct GltfMeshGeometry
+{
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t>  indices;
+  std::vector<MeshLod>   lods;
+  std::vector<uint32_t>  remap;
+};
+GltfMeshGeometry prepareGltfMeshGeometry(const tinygltf::Model& model, int meshIndex, const GltfImportSettings& settings);
 
 // This is a utility function to create the scene info buffer.
 void createGltfSceneInfoBuffer(GltfSceneResource& sceneResource, nvvk::StagingUploader& stagingUploader);
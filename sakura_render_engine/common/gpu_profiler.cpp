@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "gpu_profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include <fmt/format.h>
+
+#include "nvvk/check_error.hpp"
+
+#include "trace_recorder.hpp"
+
+namespace nvsamples {
+
+GpuProfiler::Section::Section(GpuProfiler& profiler, VkCommandBuffer cmd, const char* name)
+    : m_profiler(profiler)
+    , m_cmd(cmd)
+    , m_query(profiler.beginSection(cmd, name))
+{
+}
+
+GpuProfiler::Section::~Section()
+{
+  m_profiler.endSection(m_cmd, m_query);
+}
+
+void GpuProfiler::init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t maxSections /*= 32*/)
+{
+  m_device      = device;
+  m_maxSections = maxSections;
+
+  VkPhysicalDeviceProperties properties{};
+  vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+  m_timestampPeriod = double(properties.limits.timestampPeriod);
+
+  uint32_t familyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> families(familyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+  const uint32_t validBits = queueFamilyIndex < familyCount ? families[queueFamilyIndex].timestampValidBits : 64;
+  m_timestampMask          = validBits >= 64 ? ~0ULL : (uint64_t(1) << validBits) - 1;
+
+  m_frames.resize(std::max(frameCount, 1U));
+  for(FrameQueries& frame : m_frames)
+  {
+    const VkQueryPoolCreateInfo createInfo{
+        .sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .queryType  = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = 2 * m_maxSections,
+    };
+    NVVK_CHECK(vkCreateQueryPool(m_device, &createInfo, nullptr, &frame.pool));
+  }
+}
+
+void GpuProfiler::deinit()
+{
+  for(FrameQueries& frame : m_frames)
+    vkDestroyQueryPool(m_device, frame.pool, nullptr);
+  m_frames.clear();
+  m_sections.clear();
+  m_currentFrame = nullptr;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer cmd, uint32_t frameSlot)
+{
+  m_currentFrame = &m_frames[frameSlot % m_frames.size()];
+  collectFrame(*m_currentFrame);
+
+  vkCmdResetQueryPool(cmd, m_currentFrame->pool, 0, 2 * m_maxSections);
+  m_currentFrame->sections.clear();
+  m_currentFrame->pending = true;
+  m_currentFrame->cpuTime = TraceRecorder::now();
+}
+
+uint32_t GpuProfiler::beginSection(VkCommandBuffer cmd, const char* name)
+{
+  if(m_currentFrame == nullptr || m_currentFrame->sections.size() >= m_maxSections)
+    return ~0U;  // Not profiled
+
+  const uint32_t query = uint32_t(m_currentFrame->sections.size()) * 2;
+  m_currentFrame->sections.push_back(findSection(name));
+  vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, m_currentFrame->pool, query);
+  return query;
+}
+
+void GpuProfiler::endSection(VkCommandBuffer cmd, uint32_t query)
+{
+  if(query == ~0U)
+    return;
+  vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, m_currentFrame->pool, query + 1);
+}
+
+void GpuProfiler::collect()
+{
+  for(FrameQueries& frame : m_frames)
+    collectFrame(frame);
+}
+
+void GpuProfiler::collectFrame(FrameQueries& frame)
+{
+  if(!frame.pending || frame.sections.empty())
+    return;
+
+  // Pairs of (timestamp, availability), without waiting
+  const uint32_t        queryCount = uint32_t(frame.sections.size()) * 2;
+  std::vector<uint64_t> results(queryCount * 2);
+  const VkResult        result = vkGetQueryPoolResults(m_device, frame.pool, 0, queryCount, results.size() * sizeof(uint64_t),
+                                                       results.data(), 2 * sizeof(uint64_t),
+                                                       VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+  if(result != VK_SUCCESS && result != VK_NOT_READY)
+    return;
+
+  // Trace: the GPU starts the frame after the CPU began recording it, the offset is the smallest satisfying all frames
+  TraceRecorder& trace = TraceRecorder::getInstance();
+  if(trace.isEnabled() && results[1] != 0)
+  {
+    const int64_t frameOffset = int64_t(frame.cpuTime) - int64_t(double(results[0] & m_timestampMask) * m_timestampPeriod);
+    if(!m_offsetValid || frameOffset > m_gpuToCpuOffset)
+      m_gpuToCpuOffset = frameOffset;
+    m_offsetValid = true;
+  }
+
+  for(size_t i = 0; i < frame.sections.size(); i++)
+  {
+    const uint64_t* begin = &results[i * 4];
+    const uint64_t* end   = &results[i * 4 + 2];
+    if(begin[1] == 0 || end[1] == 0)
+      continue;  // Not available, or the section was never ended
+
+    History&     history  = m_sections[frame.sections[i]];
+    const double duration = double((end[0] - begin[0]) & m_timestampMask) * m_timestampPeriod * 1e-6;
+    if(history.durations.size() < kHistorySize)
+      history.durations.push_back(duration);
+    else
+      history.durations[history.next] = duration;
+    history.next = (history.next + 1) % kHistorySize;
+    history.last = duration;
+
+    if(trace.isEnabled())
+    {
+      const int64_t  gpuBegin   = int64_t(double(begin[0] & m_timestampMask) * m_timestampPeriod);
+      const uint64_t traceBegin = uint64_t(std::max<int64_t>(gpuBegin + m_gpuToCpuOffset, 0));
+      trace.addGpuEvent(history.name, traceBegin, traceBegin + uint64_t(duration * 1e6));
+    }
+  }
+  frame.pending = false;
+}
+
+uint32_t GpuProfiler::findSection(const char* name)
+{
+  for(size_t i = 0; i < m_sections.size(); i++)
+  {
+    if(m_sections[i].name == name)
+      return uint32_t(i);
+  }
+  m_sections.push_back({.name = name});
+  return uint32_t(m_sections.size() - 1);
+}
+
+void GpuProfiler::resetStats()
+{
+  for(FrameQueries& frame : m_frames)
+    frame.pending = false;  // Queries reset when the slot is used again
+  for(History& history : m_sections)
+  {
+    history.durations.clear();
+    history.next = 0;
+    history.last = 0.0;
+  }
+}
+
+std::vector<GpuProfiler::Stats> GpuProfiler::getStats() const
+{
+  std::vector<Stats>  stats;
+  std::vector<double> sorted;
+  for(const History& history : m_sections)
+  {
+    Stats& s = stats.emplace_back(Stats{.name = history.name, .samples = uint32_t(history.durations.size()), .lastMs = history.last});
+    if(history.durations.empty())
+      continue;
+
+    sorted = history.durations;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for(double duration : sorted)
+      sum += duration;
+    s.minMs = sorted.front();
+    s.avgMs = sum / double(sorted.size());
+    s.p99Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+  }
+  return stats;
+}
+
+bool GpuProfiler::exportStats(const std::filesystem::path& filename) const
+{
+  std::ofstream file(filename);
+  if(!file)
+    return false;
+
+  file << "section,samples,last_ms,min_ms,avg_ms,p99_ms\n";
+  for(const Stats& s : getStats())
+    file << fmt::format("{},{},{:.4f},{:.4f},{:.4f},{:.4f}\n", s.name, s.samples, s.lastMs, s.minMs, s.avgMs, s.p99Ms);
+  return bool(file);
+}
+
+}  // namespace nvsamples
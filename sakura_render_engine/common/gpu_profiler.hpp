@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// GPU timings of the render passes, with timestamp queries
+//
+// Each frame slot has its own query pool: the sections of a frame write a timestamp at their start and
+// end, and the results are read when the slot is used again, a few frames later, once the GPU is done
+// with it (see FramePacer). Reading never waits, unavailable results are skipped.
+// The durations of each section are kept for the last kHistorySize frames, for the rolling statistics.
+// When the TraceRecorder is enabled, the sections are also added to its GPU track: the GPU timestamps are
+// moved to the CPU time base with an offset making every frame start after it was recorded (approximate,
+// without calibrated timestamps).
+//
+// Usage per frame, outside of a rendering pass for beginFrame():
+//   profiler.beginFrame(cmd, frameSlot);  // Collects the results of the previous use of the slot
+//   {
+//     GpuProfiler::Section section(profiler, cmd, "Raster");
+//     ... commands ...
+//   }
+class GpuProfiler
+{
+public:
+  static constexpr uint32_t kHistorySize = 256;
+
+  struct Stats
+  {
+    std::string name;
+    uint32_t    samples = 0;  // Number of durations in the history
+    double      lastMs  = 0.0;
+    double      minMs   = 0.0;
+    double      avgMs   = 0.0;
+    double      p99Ms   = 0.0;  // 99th percentile
+  };
+
+  // Brackets the commands recorded during its lifetime
+  class Section
+  {
+  public:
+    Section(GpuProfiler& profiler, VkCommandBuffer cmd, const char* name);
+    ~Section();
+
+  private:
+    GpuProfiler&    m_profiler;
+    VkCommandBuffer m_cmd;
+    uint32_t        m_query;
+  };
+
+  void init(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t maxSections = 32);
+  void deinit();
+
+  // Collect the timings of the previous use of the slot and reset its queries
+  void beginFrame(VkCommandBuffer cmd, uint32_t frameSlot);
+
+  // Timestamps at the start and end of a section, prefer Section
+  uint32_t beginSection(VkCommandBuffer cmd, const char* name);
+  void     endSection(VkCommandBuffer cmd, uint32_t query);
+
+  // Collect the timings of all the slots whose results are available (e.g. after the GPU is idle)
+  void collect();
+
+  // Forget the durations collected so far and the results not collected yet, including the sections of the
+  // frame being recorded, e.g. at the end of warm-up frames. The sections keep their order.
+  void resetStats();
+
+  // Rolling statistics of the sections, in the order they were first recorded
+  std::vector<Stats> getStats() const;
+
+  // Write the statistics as CSV, returns false when the file cannot be written
+  bool exportStats(const std::filesystem::path& filename) const;
+
+private:
+  struct FrameQueries
+  {
+    VkQueryPool           pool{};
+    std::vector<uint32_t> sections;  // Section of each timestamp pair
+    bool                  pending = false;
+    uint64_t              cpuTime = 0;  // TraceRecorder time of beginFrame()
+  };
+
+  struct History
+  {
+    std::string         name;
+    std::vector<double> durations;  // Ring buffer of kHistorySize durations, in milliseconds
+    uint32_t            next = 0;
+    double              last = 0.0;
+  };
+
+  void     collectFrame(FrameQueries& frame);
+  uint32_t findSection(const char* name);
+
+  VkDevice                  m_device{};
+  double                    m_timestampPeriod = 1.0;   // Nanoseconds per tick
+  uint64_t                  m_timestampMask   = ~0ULL;  // Valid bits of the timestamps
+  uint32_t                  m_maxSections     = 0;
+  std::vector<FrameQueries> m_frames;
+  FrameQueries*             m_currentFrame = nullptr;
+  std::vector<History>      m_sections;
+  int64_t                   m_gpuToCpuOffset = 0;  // Nanoseconds added to the GPU timestamps for the trace
+  bool                      m_offsetValid    = false;
+};
+
+}  // namespace nvsamples
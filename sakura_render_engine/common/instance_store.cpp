@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "instance_store.hpp"
+
+namespace nvsamples {
+
+uint32_t InstanceStore::add(const glm::mat4& transform, uint32_t meshIndex, uint32_t materialIndex, uint32_t flags)
+{
+  const uint32_t instanceIndex = uint32_t(size());
+  m_transforms.emplace_back(transform);
+  m_normalMatrices.emplace_back(glm::transpose(glm::inverse(glm::mat3(transform))));
+  m_meshIndices.push_back(meshIndex);
+  m_materialIndices.push_back(materialIndex);
+  m_flags.push_back(flags);
+  m_revision++;
+  return instanceIndex;
+}
+
+void InstanceStore::reserve(size_t count)
+{
+  m_transforms.reserve(count);
+  m_normalMatrices.reserve(count);
+  m_meshIndices.reserve(count);
+  m_materialIndices.reserve(count);
+  m_flags.reserve(count);
+}
+
+void InstanceStore::clear()
+{
+  m_transforms.clear();
+  m_normalMatrices.clear();
+  m_meshIndices.clear();
+  m_materialIndices.clear();
+  m_flags.clear();
+  m_revision++;
+}
+
+void InstanceStore::setTransform(uint32_t instanceIndex, const glm::mat4& transform)
+{
+  m_transforms[instanceIndex]     = glm::mat4x3(transform);
+  m_normalMatrices[instanceIndex] = glm::transpose(glm::inverse(glm::mat3(transform)));
+  m_revision++;
+}
+
+void InstanceStore::setMeshIndex(uint32_t instanceIndex, uint32_t meshIndex)
+{
+  m_meshIndices[instanceIndex] = meshIndex;
+  m_revision++;
+}
+
+void InstanceStore::setMaterialIndex(uint32_t instanceIndex, uint32_t materialIndex)
+{
+  m_materialIndices[instanceIndex] = materialIndex;
+  m_revision++;
+}
+
+void InstanceStore::setFlags(uint32_t instanceIndex, uint32_t flags)
+{
+  m_flags[instanceIndex] = flags;
+  m_revision++;
+}
+
+void InstanceStore::writeGpuInstances(std::span<shaderio::GltfInstance> dst, uint32_t first) const
+{
+  for(size_t i = 0; i < dst.size(); i++)
+  {
+    const glm::mat4x3&      transform = m_transforms[first + i];
+    shaderio::GltfInstance& instance  = dst[i];
+    // The GPU record stores the rows of the transform
+    for(int row = 0; row < 3; row++)
+      instance.transform[row] = glm::vec4(transform[0][row], transform[1][row], transform[2][row], transform[3][row]);
+    instance.normalMatrix  = m_normalMatrices[first + i];
+    instance.materialIndex = m_materialIndices[first + i];
+    instance.meshIndex     = m_meshIndices[first + i];
+    instance.padding       = 0;
+  }
+}
+
+}  // namespace nvsamples
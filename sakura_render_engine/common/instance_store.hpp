@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "io_gltf.h"
+
+namespace nvsamples {
+
+enum InstanceFlags : uint32_t
+{
+  eInstanceNone   = 0,
+  eInstanceHidden = 1 << 0,  // Not drawn and not added to the acceleration structure
+};
+
+//--------------------------------------------------------------------------------------------------
+// CPU storage of the instances, as a structure of arrays
+//
+// Each property is a separate array, so the loops over the instances (culling, batching, TLAS build)
+// only touch the data they use. The transforms are affine (3x4, the projective row is always
+// (0,0,0,1)) and the normal matrices are computed when a transform is set, not per frame.
+// The GPU records (shaderio::GltfInstance) are written from the arrays in a single pass, and the revision
+// tells the owners of GPU copies when they are outdated.
+class InstanceStore
+{
+public:
+  // Add an instance and return its index
+  uint32_t add(const glm::mat4& transform, uint32_t meshIndex, uint32_t materialIndex = 0, uint32_t flags = eInstanceNone);
+
+  void reserve(size_t count);
+  void clear();
+
+  size_t size() const { return m_meshIndices.size(); }
+  bool   empty() const { return m_meshIndices.empty(); }
+
+  glm::mat4 getTransform(uint32_t instanceIndex) const { return glm::mat4(m_transforms[instanceIndex]); }
+  uint32_t  getMeshIndex(uint32_t instanceIndex) const { return m_meshIndices[instanceIndex]; }
+  uint32_t  getMaterialIndex(uint32_t instanceIndex) const { return m_materialIndices[instanceIndex]; }
+  uint32_t  getFlags(uint32_t instanceIndex) const { return m_flags[instanceIndex]; }
+
+  void setTransform(uint32_t instanceIndex, const glm::mat4& transform);
+  void setMeshIndex(uint32_t instanceIndex, uint32_t meshIndex);
+  void setMaterialIndex(uint32_t instanceIndex, uint32_t materialIndex);
+  void setFlags(uint32_t instanceIndex, uint32_t flags);
+
+  // Incremented by every modification
+  uint64_t getRevision() const { return m_revision; }
+
+  std::span<const glm::mat4x3> getTransforms() const { return m_transforms; }
+  std::span<const uint32_t>    getMeshIndices() const { return m_meshIndices; }
+  std::span<const uint32_t>    getMaterialIndices() const { return m_materialIndices; }
+  std::span<const uint32_t>    getFlags() const { return m_flags; }
+
+  // Write the GPU records of the instances [first, first + dst.size())
+  void writeGpuInstances(std::span<shaderio::GltfInstance> dst, uint32_t first = 0) const;
+
+private:
+  std::vector<glm::mat4x3> m_transforms;       // Affine transforms (local to world), 4 columns of 3 floats
+  std::vector<glm::mat3>   m_normalMatrices;   // Inverse transpose of the upper 3x3 of the transforms
+  std::vector<uint32_t>    m_meshIndices;      // Index in GltfSceneResource::meshes
+  std::vector<uint32_t>    m_materialIndices;  // Index in GltfSceneResource::materials
+  std::vector<uint32_t>    m_flags;            // InstanceFlags
+  uint64_t                 m_revision = 0;
+};
+
+}  // namespace nvsamples
@@ -46,11 +46,22 @@
 
 NAMESPACE_SHADERIO_BEGIN()
 // GLTF
+// Encoding of the vertex attributes, see vertex_quantize.hpp
+enum VertexFormat
+{
+  eVertexFloat        = 0,  // 32-bit floats (default, also used for the non-vertex data)
+  eVertexSnorm16      = 1,  // 4 x snorm16, positions relative to the mesh bounds (GltfMesh::positionOffset/Scale)
+  eVertexOctahedral16 = 2,  // Unit vector in 2 x snorm16 octahedral encoding, tangents add the bitangent sign in a 3rd snorm16
+  eVertexHalf         = 3,  // 2 x half float, texture coordinates
+  eVertexUnorm8       = 4,  // 4 x unorm8, colors
+};
+
 struct BufferView
 {
   uint32_t offset;      // Offset in the buffer where the data starts (in bytes)
   uint32_t count;       // Number of elements in the buffer view
   uint32_t byteStride;  // Stride in bytes between consecutive elements (0 if tightly packed)
+  uint32_t format;      // Encoding of the elements (VertexFormat)
 };
 
 struct TriangleMesh
@@ -71,12 +82,40 @@ struct GltfMetallicRoughness
   int    baseColorTextureIndex;  // Index of the base color texture in the GLTF file (optional)
 };
 
+// Meshlet limits (mesh shader outputs) and number of meshlets culled by a task shader workgroup
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_TASK_GROUP_SIZE 32
+
+// Meshlet for the task/mesh shader path, with its culling data (object space)
+struct GltfMeshlet
+{
+  float3   center;          // Bounding sphere center
+  float    radius;          // Bounding sphere radius
+  float3   coneApex;        // Normal cone apex
+  float    coneCutoff;      // Sine of the normal cone half angle (1: never backface culled)
+  float3   coneAxis;        // Normal cone axis
+  uint32_t vertexOffset;    // First vertex in GltfMesh::meshletVertices
+  uint32_t triangleOffset;  // First triangle in GltfMesh::meshletTriangles
+  uint32_t vertexCount;     // Number of vertices (up to 64)
+  uint32_t triangleCount;   // Number of triangles (up to 124)
+  uint32_t padding;
+};
+CHECK_STRUCT_ALIGNMENT(GltfMeshlet)
+
 struct GltfMesh
 {
   uint8_t*     gltfBuffer = nullptr;  // Buffer to the data (index, position, normal, ...)
   TriangleMesh triMesh;               // Mesh data
   int          indexType;             // Index type (uint16_t or uint32_t)
+  BufferView   meshlets;              // GltfMeshlet array (count 0 when the mesh has no meshlets)
+  BufferView   meshletVertices;       // uint32_t mesh vertex index of each meshlet vertex
+  BufferView   meshletTriangles;      // Three uint8_t meshlet-local vertex indices per triangle
+  float3       positionOffset;        // Dequantization of eVertexSnorm16 positions: offset + q * scale
+  float3       positionScale;         //   (center and half extent of the mesh bounds)
+  uint32_t     padding;
 };
+CHECK_STRUCT_ALIGNMENT(GltfMesh)
 
 enum GltfLightType
 {
@@ -98,9 +137,11 @@ struct GltfPunctual
 
 struct GltfInstance
 {
-  float4x4 transform;      // Transform matrix for the instance (local to world)
+  float4   transform[3];   // Rows of the affine transform (local to world), the projective row is (0,0,0,1)
+  float3x3 normalMatrix;   // Inverse transpose of the upper 3x3 of the transform
   uint32_t materialIndex;  // Material properties for the instance
   uint32_t meshIndex;      // Index of the mesh in the GltfMesh vector
+  uint32_t padding;
 };
 CHECK_STRUCT_ALIGNMENT(GltfInstance)
 
@@ -116,8 +157,12 @@ struct GltfSceneInfo
   GltfInstance*          instances;          // Address of the instance buffer containing GltfInstance data
   GltfMesh*              meshes;             // Address of the mesh buffer containing GltfMesh data
   GltfMetallicRoughness* materials;          // Material properties for the instance
+  uint32_t*              drawInstances;      // Instance index of each entry of the instanced draws (firstInstance + SV_InstanceID)
   GltfPunctual           punctualLights[2];  // Array of punctual lights in the scene (up to 2)
   SkySimpleParameters    skySimpleParam;     // Parameters for the sky rendering
+  float4                 frustumPlanes[6];   // World space frustum planes (xyz: inward normal, w: distance), for meshlet culling
+  int                    meshletConeCulling; // Cull the back facing meshlets with their normal cone
+  int                    padding;
 };
 CHECK_STRUCT_ALIGNMENT(GltfSceneInfo)
 
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "job_system.hpp"
+
+#include <algorithm>
+
+namespace nvsamples {
+
+namespace {
+// Job system and worker index of the calling thread (a thread is a worker of at most one job system)
+thread_local const JobSystem* t_jobSystem   = nullptr;
+thread_local uint32_t         t_threadIndex = 0;
+}  // namespace
+
+JobSystem& JobSystem::getInstance()
+{
+  static JobSystem jobSystem;
+  return jobSystem;
+}
+
+JobSystem::JobSystem(uint32_t numWorkers /*= 0*/)
+{
+  if(numWorkers == 0)
+    numWorkers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+
+  for(uint32_t i = 0; i <= numWorkers; i++)
+    m_queues.emplace_back(std::make_unique<Queue>());
+  for(uint32_t i = 1; i <= numWorkers; i++)
+    m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  for(std::thread& worker : m_workers)
+    worker.join();
+}
+
+uint32_t JobSystem::getThreadIndex() const
+{
+  return t_jobSystem == this ? t_threadIndex : 0;
+}
+
+void JobSystem::schedule(JobFunc job, JobCounter* counter /*= nullptr*/)
+{
+  if(counter)
+    counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+  push({std::move(job), counter});
+}
+
+void JobSystem::scheduleAfter(JobCounter& dependency, JobFunc job, JobCounter* counter /*= nullptr*/)
+{
+  if(counter)
+    counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(dependency.m_mutex);
+    if(dependency.m_pending.load(std::memory_order_acquire) != 0)
+    {
+      dependency.m_continuations.push_back({std::move(job), counter});
+      return;
+    }
+  }
+  push({std::move(job), counter});
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+  const uint32_t threadIndex = getThreadIndex();
+  while(!counter.isDone())
+  {
+    if(!runOneJob(threadIndex))
+      std::this_thread::yield();  // The remaining jobs are running on other threads
+  }
+  // The last job may still be releasing the counter
+  std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& func)
+{
+  grainSize             = std::max(grainSize, 1U);
+  const uint32_t ranges = (count + grainSize - 1) / grainSize;
+  if(ranges <= 1)
+  {
+    if(count > 0)
+      func(0, count);
+    return;
+  }
+
+  JobCounter counter;
+  for(uint32_t range = 1; range < ranges; range++)
+  {
+    const uint32_t begin = range * grainSize;
+    const uint32_t end   = std::min(count, begin + grainSize);
+    schedule([&func, begin, end] { func(begin, end); }, &counter);
+  }
+  func(0, grainSize);
+  wait(counter);
+}
+
+void JobSystem::push(Job&& job)
+{
+  Queue& queue = *m_queues[getThreadIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  m_queuedJobs.fetch_add(1, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);  // A worker may be between its check and its wait
+  }
+  m_wakeUp.notify_one();
+}
+
+bool JobSystem::popOrSteal(uint32_t threadIndex, Job& job)
+{
+  if(m_queuedJobs.load(std::memory_order_acquire) == 0)
+    return false;
+
+  // Most recent job of the own queue
+  {
+    Queue&                      queue = *m_queues[threadIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(!queue.jobs.empty())
+    {
+      job = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+      m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // Oldest job of another queue, starting with the next one to spread the thieves
+  const uint32_t queueCount = uint32_t(m_queues.size());
+  for(uint32_t i = 1; i < queueCount; i++)
+  {
+    Queue&                      queue = *m_queues[(threadIndex + i) % queueCount];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(!queue.jobs.empty())
+    {
+      job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+      m_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool JobSystem::runOneJob(uint32_t threadIndex)
+{
+  Job job;
+  if(!popOrSteal(threadIndex, job))
+    return false;
+  job.func();
+  finish(job.counter);
+  return true;
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+  if(!counter)
+    return;
+
+  // The continuations are taken under the lock, the counter must not be touched once it is released
+  std::vector<JobCounter::Continuation> continuations;
+  {
+    std::lock_guard<std::mutex> lock(counter->m_mutex);
+    if(counter->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      continuations.swap(counter->m_continuations);
+  }
+  for(JobCounter::Continuation& continuation : continuations)
+    push({std::move(continuation.func), continuation.counter});
+}
+
+void JobSystem::workerLoop(uint32_t threadIndex)
+{
+  t_jobSystem   = this;
+  t_threadIndex = threadIndex;
+  while(true)
+  {
+    if(runOneJob(threadIndex))
+      continue;
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wakeUp.wait(lock, [this] { return m_stop || m_queuedJobs.load(std::memory_order_acquire) > 0; });
+    if(m_stop)
+      return;
+  }
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// Counter of the unfinished jobs of a group
+// Jobs can be scheduled to start when the counter reaches zero (JobSystem::scheduleAfter), and any
+// thread can wait for it (JobSystem::wait). The counter must outlive the jobs referencing it.
+class JobCounter
+{
+public:
+  JobCounter() = default;
+  JobCounter(const JobCounter&)            = delete;
+  JobCounter& operator=(const JobCounter&) = delete;
+
+  bool isDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+  friend class JobSystem;
+
+  struct Continuation
+  {
+    std::function<void()> func;
+    JobCounter*           counter;
+  };
+
+  std::atomic<uint32_t>     m_pending{0};
+  std::mutex                m_mutex;
+  std::vector<Continuation> m_continuations;  // Jobs scheduled when m_pending reaches zero
+};
+
+//--------------------------------------------------------------------------------------------------
+// Work-stealing job scheduler
+//
+// Each worker thread owns a deque of jobs: it pushes and pops its own jobs at the back (the most recent
+// job, whose data is still in cache) and, when its deque is empty, steals the oldest job at the front of
+// another deque. Threads which are not workers push their jobs to a shared deque, and help running jobs
+// while they wait for a counter instead of blocking.
+//
+//   JobCounter counter;
+//   jobs.schedule([] { ... }, &counter);
+//   jobs.scheduleAfter(counter, [] { ... });  // Runs when the first job is done
+//   jobs.wait(counter);
+//
+//   jobs.parallelFor(count, 64, [](uint32_t begin, uint32_t end) { ... });
+//
+// The engine uses the process wide instance (getInstance()) for the import, the texture decoding,
+// the culling and the command recording.
+class JobSystem
+{
+public:
+  using JobFunc = std::function<void()>;
+
+  // Process wide job system, with one worker thread per hardware thread but the calling one
+  static JobSystem& getInstance();
+
+  // 0 threads means automatic: one worker per hardware thread but one
+  explicit JobSystem(uint32_t numWorkers = 0);
+  ~JobSystem();
+  JobSystem(const JobSystem&)            = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  // Number of threads running jobs: the workers and the threads waiting for jobs (index 0)
+  uint32_t getThreadCount() const { return uint32_t(m_workers.size()) + 1; }
+
+  // Index of the calling thread in [0, getThreadCount()): 1..n for the workers, 0 for the other threads
+  uint32_t getThreadIndex() const;
+
+  // Run `job`, the counter (optional) is incremented now and decremented when the job is done
+  void schedule(JobFunc job, JobCounter* counter = nullptr);
+
+  // Run `job` when `dependency` reaches zero (immediately if it is already zero)
+  void scheduleAfter(JobCounter& dependency, JobFunc job, JobCounter* counter = nullptr);
+
+  // Run jobs until `counter` reaches zero
+  void wait(JobCounter& counter);
+
+  // Call `func` on the ranges [begin, end) of at most `grainSize` items covering [0, count), in parallel,
+  // and return when all are done. The calling thread runs ranges too.
+  void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)>& func);
+
+private:
+  struct Job
+  {
+    JobFunc     func;
+    JobCounter* counter = nullptr;
+  };
+
+  struct Queue
+  {
+    std::mutex      mutex;
+    std::deque<Job> jobs;
+  };
+
+  void push(Job&& job);
+  bool popOrSteal(uint32_t threadIndex, Job& job);
+  bool runOneJob(uint32_t threadIndex);
+  void finish(JobCounter* counter);
+  void workerLoop(uint32_t threadIndex);
+
+  std::vector<std::unique_ptr<Queue>> m_queues;   // [0] is shared by the non-worker threads, [i] belongs to worker i
+  std::vector<std::thread>            m_workers;
+  std::atomic<uint32_t>               m_queuedJobs{0};
+  std::mutex                          m_sleepMutex;
+  std::condition_variable             m_wakeUp;
+  bool                                m_stop = false;
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "job_system_benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "nvutils/logger.hpp"
+#include "nvutils/timers.hpp"
+
+#include "job_system.hpp"
+
+namespace nvsamples {
+
+namespace {
+
+// Schedule `jobCount` empty jobs from the calling thread and wait for them
+double measureThroughput(JobSystem& jobs, uint32_t jobCount)
+{
+  nvutils::PerformanceTimer timer;
+  JobCounter                counter;
+  for(uint32_t i = 0; i < jobCount; i++)
+    jobs.schedule([] {}, &counter);
+  jobs.wait(counter);
+  return double(jobCount) / std::max(timer.getSeconds(), 1e-9);
+}
+
+// Chains of `length` jobs, each one scheduled after the previous one
+double measureDependencies(JobSystem& jobs, uint32_t chainCount, uint32_t length)
+{
+  nvutils::PerformanceTimer                timer;
+  std::vector<std::unique_ptr<JobCounter>> counters;
+  counters.reserve(size_t(chainCount) * length);
+  JobCounter done;
+  for(uint32_t chain = 0; chain < chainCount; chain++)
+  {
+    counters.push_back(std::make_unique<JobCounter>());
+    jobs.schedule([] {}, counters.back().get());
+    for(uint32_t i = 1; i < length; i++)
+    {
+      JobCounter* previous = counters.back().get();
+      counters.push_back(std::make_unique<JobCounter>());
+      jobs.scheduleAfter(*previous, [] {}, counters.back().get());
+    }
+    jobs.scheduleAfter(*counters.back(), [] {}, &done);
+  }
+  jobs.wait(done);
+  return double(chainCount) * length / std::max(timer.getSeconds(), 1e-9);
+}
+
+// Compute bound work of the parallelFor measure
+void computeValues(std::vector<float>& values, uint32_t begin, uint32_t end)
+{
+  for(uint32_t i = begin; i < end; i++)
+  {
+    float x = float(i) * 1e-4F;
+    for(int k = 0; k < 16; k++)
+      x = std::sin(x) * 0.5F + std::cos(x * 1.5F);
+    values[i] = x;
+  }
+}
+
+// The loop on the calling thread alone, without the job system: the reference of the speedup, in milliseconds
+double measureSerialLoop(std::vector<float>& values)
+{
+  nvutils::PerformanceTimer timer;
+  computeValues(values, 0, uint32_t(values.size()));
+  return timer.getMilliseconds();
+}
+
+// Compute bound loop, returns the duration in milliseconds
+double measureParallelFor(JobSystem& jobs, std::vector<float>& values, uint32_t grainSize)
+{
+  nvutils::PerformanceTimer timer;
+  jobs.parallelFor(uint32_t(values.size()), grainSize,
+                   [&](uint32_t begin, uint32_t end) { computeValues(values, begin, end); });
+  return timer.getMilliseconds();
+}
+
+}  // namespace
+
+void runJobSystemBenchmark(uint32_t maxWorkers /*= 0*/)
+{
+  if(maxWorkers == 0)
+    maxWorkers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+
+  std::vector<float> values(1 << 20);
+  measureSerialLoop(values);  // Warm up the memory
+  const double baseTime = measureSerialLoop(values);
+  LOGI("Job system benchmark (%u hardware threads)\n", std::thread::hardware_concurrency());
+  LOGI("%s", fmt::format("  single-threaded loop without jobs: {:.2f} ms, the reference of the speedup\n", baseTime).c_str());
+  LOGI("  threads |   empty jobs/s | chained jobs/s | parallelFor ms | speedup\n");
+  for(uint32_t workers = 1; workers <= maxWorkers; workers = workers < maxWorkers ? std::min(workers * 2, maxWorkers) : workers + 1)
+  {
+    JobSystem jobs(workers);
+    measureParallelFor(jobs, values, 4096);  // Warm up the threads and the memory
+
+    const double throughput   = measureThroughput(jobs, 200000);
+    const double dependencies = measureDependencies(jobs, 64, 256);
+    const double loopTime     = measureParallelFor(jobs, values, 4096);
+    LOGI("%s", fmt::format("  {:7} | {:14.0f} | {:14.0f} | {:14.2f} | {:6.2f}x\n", jobs.getThreadCount(), throughput,
+                           dependencies, loopTime, baseTime / std::max(loopTime, 1e-6))
+                   .c_str());
+  }
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "memory_tracker.hpp"
+
+#include <fstream>
+
+#include <fmt/format.h>
+
+#include "nvutils/logger.hpp"
+
+namespace nvsamples {
+
+const char* MemoryTracker::getCategoryName(MemoryCategory category)
+{
+  switch(category)
+  {
+    case MemoryCategory::eGeometry:
+      return "Geometry";
+    case MemoryCategory::eTextures:
+      return "Textures";
+    case MemoryCategory::eGBuffers:
+      return "G-Buffers";
+    case MemoryCategory::eSceneData:
+      return "Scene Data";
+    case MemoryCategory::eStaging:
+      return "Staging & Other";
+    default:
+      return "Unknown";
+  }
+}
+
+void MemoryTracker::init(VmaAllocator allocator)
+{
+  m_allocator = allocator;
+  update();
+}
+
+void MemoryTracker::deinit()
+{
+  m_allocations.clear();
+  m_trackedBytes  = {};
+  m_externalBytes = {};
+  m_categoryBytes = {};
+  m_heaps.clear();
+  m_heapUnderPressure.clear();
+  m_allocator = {};
+}
+
+void MemoryTracker::track(VmaAllocation allocation, MemoryCategory category)
+{
+  if(allocation == nullptr)
+    return;
+  untrack(allocation);  // Tracked again, e.g. with another category
+
+  VmaAllocationInfo info{};
+  vmaGetAllocationInfo(m_allocator, allocation, &info);
+  m_allocations[allocation] = {.category = category, .size = info.size};
+  m_trackedBytes[uint32_t(category)] += info.size;
+}
+
+void MemoryTracker::untrack(VmaAllocation allocation)
+{
+  auto it = m_allocations.find(allocation);
+  if(it == m_allocations.end())
+    return;
+  m_trackedBytes[uint32_t(it->second.category)] -= it->second.size;
+  m_allocations.erase(it);
+}
+
+void MemoryTracker::setExternalBytes(MemoryCategory category, uint64_t bytes)
+{
+  m_externalBytes[uint32_t(category)] = bytes;
+}
+
+void MemoryTracker::update()
+{
+  if(m_allocator == nullptr)
+    return;
+
+  const VkPhysicalDeviceMemoryProperties* memoryProperties{};
+  vmaGetMemoryProperties(m_allocator, &memoryProperties);
+  std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+  vmaGetHeapBudgets(m_allocator, budgets.data());
+
+  m_heaps.resize(memoryProperties->memoryHeapCount);
+  m_heapUnderPressure.resize(memoryProperties->memoryHeapCount, false);
+  uint64_t allocationBytes = 0;
+  for(uint32_t heap = 0; heap < memoryProperties->memoryHeapCount; heap++)
+  {
+    m_heaps[heap] = {.usage           = budgets[heap].usage,
+                     .budget          = budgets[heap].budget,
+                     .blockBytes      = budgets[heap].statistics.blockBytes,
+                     .allocationBytes = budgets[heap].statistics.allocationBytes,
+                     .deviceLocal = (memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0};
+    allocationBytes += budgets[heap].statistics.allocationBytes;
+  }
+
+  // Categories, the remainder of the allocations is staging
+  uint64_t taggedBytes = 0;
+  for(uint32_t i = 0; i < kCategoryCount; i++)
+  {
+    m_categoryBytes[i] = m_trackedBytes[i] + m_externalBytes[i];
+    taggedBytes += m_categoryBytes[i];
+  }
+  m_categoryBytes[uint32_t(MemoryCategory::eStaging)] += allocationBytes > taggedBytes ? allocationBytes - taggedBytes : 0;
+
+  // Budget pressure of the device local heaps
+  for(uint32_t heap = 0; heap < uint32_t(m_heaps.size()); heap++)
+  {
+    const HeapBudget& budget = m_heaps[heap];
+    if(!budget.deviceLocal || budget.budget == 0)
+      continue;
+    const float ratio = float(double(budget.usage) / double(budget.budget));
+    if(!m_heapUnderPressure[heap] && ratio > m_pressureThreshold)
+    {
+      m_heapUnderPressure[heap] = true;
+      LOGW("Memory heap %u over budget threshold: %.1f of %.1f MB\n", heap, double(budget.usage) / (1024.0 * 1024.0),
+           double(budget.budget) / (1024.0 * 1024.0));
+      const BudgetPressure pressure{.heapIndex = heap, .usage = budget.usage, .budget = budget.budget, .ratio = ratio};
+      for(const PressureCallback& callback : m_pressureCallbacks)
+        callback(pressure);
+    }
+    else if(m_heapUnderPressure[heap] && ratio < m_pressureThreshold * 0.95F)
+    {
+      m_heapUnderPressure[heap] = false;
+    }
+  }
+}
+
+bool MemoryTracker::exportJson(const std::filesystem::path& filename) const
+{
+  std::ofstream file(filename);
+  if(!file)
+    return false;
+
+  file << "{\n  \"categories\": {\n";
+  for(uint32_t i = 0; i < kCategoryCount; i++)
+    file << fmt::format("    \"{}\": {}{}\n", getCategoryName(MemoryCategory(i)), m_categoryBytes[i], i + 1 < kCategoryCount ? "," : "");
+  file << "  },\n  \"heaps\": [\n";
+  for(size_t heap = 0; heap < m_heaps.size(); heap++)
+  {
+    const HeapBudget& h = m_heaps[heap];
+    file << fmt::format(
+        "    {{ \"device_local\": {}, \"usage\": {}, \"budget\": {}, \"block_bytes\": {}, \"allocation_bytes\": {} }}{}\n",
+        h.deviceLocal, h.usage, h.budget, h.blockBytes, h.allocationBytes, heap + 1 < m_heaps.size() ? "," : "");
+  }
+  file << "  ]\n}\n";
+  return bool(file);
+}
+
+}  // namespace nvsamples
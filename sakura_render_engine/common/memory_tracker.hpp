@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <vk_mem_alloc.h>
+
+namespace nvsamples {
+
+enum class MemoryCategory : uint32_t
+{
+  eGeometry,   // Vertex, index and meshlet data (bGltfDatas)
+  eTextures,   // Material textures
+  eGBuffers,   // Render targets
+  eSceneData,  // Meshes, materials, instances, per-frame buffers
+  eStaging,    // Allocations not tagged: staging buffers of the uploads, and anything else
+  eCount,
+};
+
+//--------------------------------------------------------------------------------------------------
+// Memory usage per category and per heap, from the VMA statistics
+//
+// The allocations are tagged with track() when created and untrack() before being destroyed, their size is
+// read from VMA. Resources allocated by other objects (e.g. the G-buffers) are accounted with
+// setExternalBytes(). What the allocator holds beyond the tagged allocations is reported as staging.
+//
+// update(), once a frame, reads the heap budgets: with VK_EXT_memory_budget (the allocator created with
+// VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT) they are the values of the driver, otherwise VMA estimates them.
+// When the usage of a device local heap goes over the pressure threshold, the pressure callbacks are called once;
+// they are called again after the usage went back under 95% of the threshold.
+class MemoryTracker
+{
+public:
+  struct HeapBudget
+  {
+    uint64_t usage           = 0;  // Bytes used by the process, from the driver (or estimated)
+    uint64_t budget          = 0;  // Bytes available to the process
+    uint64_t blockBytes      = 0;  // Device memory blocks allocated by VMA
+    uint64_t allocationBytes = 0;  // Part of the blocks used by allocations
+    bool     deviceLocal     = false;
+  };
+
+  struct BudgetPressure
+  {
+    uint32_t heapIndex = 0;
+    uint64_t usage     = 0;
+    uint64_t budget    = 0;
+    float    ratio     = 0.0F;  // usage / budget
+  };
+  using PressureCallback = std::function<void(const BudgetPressure&)>;
+
+  static const char* getCategoryName(MemoryCategory category);
+
+  void init(VmaAllocator allocator);
+  void deinit();
+
+  void track(VmaAllocation allocation, MemoryCategory category);
+  void untrack(VmaAllocation allocation);
+  void setExternalBytes(MemoryCategory category, uint64_t bytes);
+
+  // Read the budgets, update the categories and call the pressure callbacks
+  void update();
+
+  uint64_t                       getCategoryBytes(MemoryCategory category) const { return m_categoryBytes[uint32_t(category)]; }
+  const std::vector<HeapBudget>& getHeapBudgets() const { return m_heaps; }
+
+  void  setPressureThreshold(float ratio) { m_pressureThreshold = ratio; }
+  float getPressureThreshold() const { return m_pressureThreshold; }
+  void  addPressureCallback(PressureCallback callback) { m_pressureCallbacks.push_back(std::move(callback)); }
+
+  // Write the categories and the heaps as JSON, returns false when the file cannot be written
+  bool exportJson(const std::filesystem::path& filename) const;
+
+private:
+  static constexpr uint32_t kCategoryCount = uint32_t(MemoryCategory::eCount);
+
+  struct TrackedAllocation
+  {
+    MemoryCategory category;
+    uint64_t       size;
+  };
+
+  VmaAllocator                                         m_allocator{};
+  std::unordered_map<VmaAllocation, TrackedAllocation> m_allocations;
+  std::array<uint64_t, kCategoryCount>                 m_trackedBytes{};   // Sum of the tracked allocations
+  std::array<uint64_t, kCategoryCount>                 m_externalBytes{};  // Set with setExternalBytes()
+  std::array<uint64_t, kCategoryCount>                 m_categoryBytes{};  // Totals, with the staging, at the last update
+  std::vector<HeapBudget>                              m_heaps;
+  std::vector<bool>                                    m_heapUnderPressure;
+  std::vector<PressureCallback>                        m_pressureCallbacks;
+  float                                                m_pressureThreshold = 0.9F;
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mesh_optimize.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace nvsamples {
+
+namespace {
+
+// FIFO cache simulation, returns the number of misses of each triangle
+class FifoCache
+{
+public:
+  FifoCache(size_t vertexCount, uint32_t cacheSize)
+      : m_timestamps(vertexCount, 0)
+      , m_time(cacheSize + 1)
+      , m_cacheSize(cacheSize)
+  {
+  }
+
+  // A vertex is in the cache if it was inserted less than cacheSize insertions ago
+  uint32_t addTriangle(const uint32_t* tri)
+  {
+    uint32_t misses = 0;
+    for(int k = 0; k < 3; k++)
+    {
+      if(m_time - m_timestamps[tri[k]] > m_cacheSize)
+      {
+        m_timestamps[tri[k]] = m_time++;
+        misses++;
+      }
+    }
+    return misses;
+  }
+
+  void flush() { m_time += m_cacheSize + 1; }
+
+private:
+  std::vector<uint32_t> m_timestamps;
+  uint32_t              m_time;
+  uint32_t              m_cacheSize;
+};
+
+}  // namespace
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize /*= kVertexCacheSize*/)
+{
+  VertexCacheStats stats;
+  if(indices.empty())
+    return stats;
+
+  FifoCache             cache(vertexCount, cacheSize);
+  std::vector<uint8_t>  referenced(vertexCount, 0);
+  size_t                misses         = 0;
+  size_t                referenceCount = 0;
+  for(size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    misses += cache.addTriangle(&indices[i]);
+    for(int k = 0; k < 3; k++)
+    {
+      referenceCount += referenced[indices[i + k]] == 0;
+      referenced[indices[i + k]] = 1;
+    }
+  }
+
+  stats.acmr = float(misses) / float(indices.size() / 3);
+  stats.atvr = float(misses) / float(referenceCount);
+  return stats;
+}
+
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize /*= kVertexCacheSize*/)
+{
+  const size_t triangleCount = indices.size() / 3;
+  if(triangleCount == 0)
+    return;
+
+  // Triangles around each vertex (compressed adjacency)
+  std::vector<uint32_t> liveTriangles(vertexCount, 0);
+  for(size_t i = 0; i < triangleCount * 3; i++)
+    liveTriangles[indices[i]]++;
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for(size_t v = 0; v < vertexCount; v++)
+    adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+      adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+  }
+
+  std::vector<uint32_t> cacheTime(vertexCount, 0);
+  std::vector<uint8_t>  emitted(triangleCount, 0);
+  std::vector<uint32_t> deadEnd;  // Stack of the recently referenced vertices
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> result;
+  result.reserve(triangleCount * 3);
+
+  uint32_t time   = cacheSize + 1;
+  size_t   cursor = 0;  // Next vertex to check when all else fails
+  int64_t  fanning = indices[0];
+  while(fanning >= 0)
+  {
+    // Emit all the triangles around the fanning vertex
+    candidates.clear();
+    for(uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+    {
+      const uint32_t t = adjacency[a];
+      if(emitted[t])
+        continue;
+      emitted[t] = 1;
+      for(int k = 0; k < 3; k++)
+      {
+        const uint32_t v = indices[t * 3 + k];
+        result.push_back(v);
+        deadEnd.push_back(v);
+        candidates.push_back(v);
+        liveTriangles[v]--;
+        if(time - cacheTime[v] > cacheSize)
+          cacheTime[v] = time++;
+      }
+    }
+
+    // Next fanning vertex: the oldest candidate that stays in the cache while its remaining triangles are emitted
+    fanning       = -1;
+    int bestScore = -1;
+    for(uint32_t v : candidates)
+    {
+      if(liveTriangles[v] == 0)
+        continue;
+      int score = 0;
+      if(time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+        score = int(time - cacheTime[v]);
+      if(score > bestScore)
+      {
+        bestScore = score;
+        fanning   = v;
+      }
+    }
+
+    // Dead end: a recently used vertex with triangles left, or the next vertex in the input order
+    while(fanning < 0 && !deadEnd.empty())
+    {
+      const uint32_t v = deadEnd.back();
+      deadEnd.pop_back();
+      if(liveTriangles[v] > 0)
+        fanning = v;
+    }
+    while(fanning < 0 && cursor < vertexCount)
+    {
+      if(liveTriangles[cursor] > 0)
+        fanning = int64_t(cursor);
+      cursor++;
+    }
+  }
+
+  std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimizeOverdraw(std::span<uint32_t>        indices,
+                      std::span<const glm::vec3> positions,
+                      float                      threshold /*= 1.05F*/,
+                      uint32_t                   cacheSize /*= kVertexCacheSize*/)
+{
+  const size_t triangleCount = indices.size() / 3;
+  if(triangleCount == 0)
+    return;
+
+  // Cluster boundaries: where the cache restarts (triangle with 3 misses). The first triangle always starts a
+  // cluster, it has less than 3 misses when degenerate.
+  std::vector<uint32_t> clusterStarts = {0};
+  {
+    FifoCache cache(positions.size(), cacheSize);
+    for(size_t t = 0; t < triangleCount; t++)
+      if(cache.addTriangle(&indices[t * 3]) == 3 && t > 0)
+        clusterStarts.push_back(uint32_t(t));
+  }
+
+  // Split the clusters further, while each part keeps a cache efficiency close to the whole mesh
+  const float           meshAcmr = analyzeVertexCache(indices, positions.size(), cacheSize).acmr;
+  std::vector<uint32_t> clusters;
+  for(size_t c = 0; c < clusterStarts.size(); c++)
+  {
+    const uint32_t begin = clusterStarts[c];
+    const uint32_t end   = c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : uint32_t(triangleCount);
+
+    FifoCache cache(positions.size(), cacheSize);
+    uint32_t  start  = begin;
+    uint32_t  misses = 0;
+    clusters.push_back(begin);
+    for(uint32_t t = begin; t < end; t++)
+    {
+      misses += cache.addTriangle(&indices[t * 3]);
+      const uint32_t count = t - start + 1;
+      if(count >= cacheSize && float(misses) / float(count) <= meshAcmr * threshold && t + 1 < end)
+      {
+        cache.flush();
+        start  = t + 1;
+        misses = 0;
+        clusters.push_back(start);
+      }
+    }
+  }
+
+  // Sort key of each cluster: how much it faces away from the mesh center
+  glm::vec3 meshCenter(0.0F);
+  float     meshArea = 0.0F;
+  for(size_t t = 0; t < triangleCount; t++)
+  {
+    const glm::vec3& p0   = positions[indices[t * 3 + 0]];
+    const glm::vec3& p1   = positions[indices[t * 3 + 1]];
+    const glm::vec3& p2   = positions[indices[t * 3 + 2]];
+    const float      area = glm::length(glm::cross(p1 - p0, p2 - p0));
+    meshCenter += (p0 + p1 + p2) * (area / 3.0F);
+    meshArea += area;
+  }
+  meshCenter = meshArea > 0.0F ? meshCenter / meshArea : meshCenter;
+
+  std::vector<float> sortKeys(clusters.size());
+  for(size_t c = 0; c < clusters.size(); c++)
+  {
+    const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : uint32_t(triangleCount);
+    glm::vec3      center(0.0F), normal(0.0F);
+    float          area = 0.0F;
+    for(uint32_t t = clusters[c]; t < end; t++)
+    {
+      const glm::vec3& p0 = positions[indices[t * 3 + 0]];
+      const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+      const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+      const glm::vec3  n  = glm::cross(p1 - p0, p2 - p0);  // Area weighted
+      const float      a  = glm::length(n);
+      center += (p0 + p1 + p2) * (a / 3.0F);
+      normal += n;
+      area += a;
+    }
+    // Only the direction counts, a large cluster does not face away more. Opposite triangles cancel out: no preference
+    const float normalLength = glm::length(normal);
+    center                   = area > 0.0F ? center / area : center;
+    sortKeys[c]              = normalLength > 0.0F ? glm::dot(center - meshCenter, normal / normalLength) : 0.0F;
+  }
+
+  std::vector<uint32_t> order(clusters.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+  std::vector<uint32_t> result;
+  result.reserve(indices.size());
+  for(uint32_t c : order)
+  {
+    const uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : uint32_t(triangleCount);
+    result.insert(result.end(), indices.begin() + size_t(clusters[c]) * 3, indices.begin() + size_t(end) * 3);
+  }
+  std::copy(result.begin(), result.end(), indices.begin());
+}
+
+std::vector<uint32_t> optimizeVertexFetch(std::span<uint32_t>                  indices,
+                                          size_t                               vertexCount,
+                                          size_t&                              usedVertexCount,
+                                          std::span<const std::span<uint32_t>> extraIndices /*= {}*/)
+{
+  std::vector<uint32_t> remap(vertexCount, ~0U);
+  uint32_t              next    = 0;
+  auto                  rewrite = [&](std::span<uint32_t> list) {
+    for(uint32_t& index : list)
+    {
+      if(remap[index] == ~0U)
+        remap[index] = next++;
+      index = remap[index];
+    }
+  };
+  rewrite(indices);
+  for(std::span<uint32_t> list : extraIndices)
+    rewrite(list);
+  usedVertexCount = next;
+  return remap;
+}
+
+}  // namespace nvsamples
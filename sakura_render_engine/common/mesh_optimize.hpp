@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace nvsamples {
+
+// Size of the simulated post-transform vertex cache (FIFO), a conservative value for current GPUs
+constexpr uint32_t kVertexCacheSize = 16;
+
+// Post-transform vertex cache efficiency of a triangle list
+struct VertexCacheStats
+{
+  float acmr = 0.0F;  // Average cache miss ratio: transformed vertices per triangle (0.5 is ideal, 3 is the worst)
+  float atvr = 0.0F;  // Average transformed vertex ratio: transformed vertices per referenced vertex (1 is ideal)
+};
+
+// Simulate a FIFO vertex cache on the index list
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t cacheSize = kVertexCacheSize);
+
+//--------------------------------------------------------------------------------------------------
+// Reorder the triangles for the post-transform vertex cache, with Tipsify (Sander, Nehab, Barczak 2007).
+// The triangles are emitted in fans around the vertices, the next fan being a vertex still in the cache.
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, uint32_t cacheSize = kVertexCacheSize);
+
+// Reorder clusters of triangles to reduce overdraw, the triangles must already be optimized for the vertex cache.
+// The index list is split in clusters at the cache boundaries (and where the cluster cache efficiency stays within
+// `threshold` of the whole mesh), then the clusters facing outward are drawn first, occluding the others.
+void optimizeOverdraw(std::span<uint32_t>        indices,
+                      std::span<const glm::vec3> positions,
+                      float                      threshold = 1.05F,
+                      uint32_t                   cacheSize = kVertexCacheSize);
+
+// Reorder the vertices in the order of their first use, for the locality of the vertex fetch.
+// The indices are rewritten, and the returned table gives the new index of each old vertex (~0U when unused).
+// Returns the number of used vertices in `usedVertexCount`.
+// `extraIndices` are other index lists sharing the vertices (e.g. levels of detail), rewritten too: the vertices
+// only they use are placed after the vertices of `indices`, so that no index of any list is left unmapped.
+std::vector<uint32_t> optimizeVertexFetch(std::span<uint32_t>                  indices,
+                                          size_t                               vertexCount,
+                                          size_t&                              usedVertexCount,
+                                          std::span<const std::span<uint32_t>> extraIndices = {});
+
+}  // namespace nvsamples
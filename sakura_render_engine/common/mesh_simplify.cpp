@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "mesh_simplify.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <unordered_map>
+
+namespace nvsamples {
+
+namespace {
+
+// Symmetric 4x4 matrix of the plane quadric, with the accumulated area (weight)
+struct Quadric
+{
+  double a00{}, a01{}, a02{}, a11{}, a12{}, a22{};
+  double b0{}, b1{}, b2{};
+  double c{};
+  double weight{};
+
+  void addPlane(const glm::vec3& n, float d, float w)
+  {
+    a00 += w * n.x * n.x;
+    a01 += w * n.x * n.y;
+    a02 += w * n.x * n.z;
+    a11 += w * n.y * n.y;
+    a12 += w * n.y * n.z;
+    a22 += w * n.z * n.z;
+    b0 += w * n.x * d;
+    b1 += w * n.y * d;
+    b2 += w * n.z * d;
+    c += w * double(d) * d;
+    weight += w;
+  }
+
+  void add(const Quadric& q)
+  {
+    a00 += q.a00, a01 += q.a01, a02 += q.a02, a11 += q.a11, a12 += q.a12, a22 += q.a22;
+    b0 += q.b0, b1 += q.b1, b2 += q.b2;
+    c += q.c;
+    weight += q.weight;
+  }
+
+  // Mean squared distance of p to the accumulated planes
+  double error(const glm::vec3& p) const
+  {
+    const double x = p.x, y = p.y, z = p.z;
+    const double e = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + a11 * y * y + 2.0 * a12 * y * z + a22 * z * z
+                     + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    return weight > 0.0 ? std::max(0.0, e / weight) : 0.0;
+  }
+};
+
+struct Collapse
+{
+  float    cost;
+  uint32_t from, to;
+  uint32_t versionFrom, versionTo;
+  bool     operator<(const Collapse& other) const { return cost > other.cost; }  // min-heap
+};
+
+struct PositionHash
+{
+  size_t operator()(const glm::vec3& p) const
+  {
+    uint32_t h[3];
+    memcpy(h, &p, sizeof(h));
+    return size_t((h[0] * 73856093U) ^ (h[1] * 19349663U) ^ (h[2] * 83492791U));
+  }
+};
+
+struct PositionEqual
+{
+  bool operator()(const glm::vec3& a, const glm::vec3& b) const { return memcmp(&a, &b, sizeof(glm::vec3)) == 0; }
+};
+
+}  // namespace
+
+std::vector<uint32_t> simplifyMesh(std::span<const uint32_t>  indices,
+                                   std::span<const glm::vec3> positions,
+                                   const SimplifyAttributes&  attributes,
+                                   size_t                     targetIndexCount,
+                                   float                      targetError,
+                                   float*                     resultError /*= nullptr*/)
+{
+  const size_t   vertexCount   = positions.size();
+  const size_t   triangleCount = indices.size() / 3;
+  const uint32_t numAttributes = uint32_t(attributes.weights.size());
+  if(resultError)
+    *resultError = 0.0F;
+  if(indices.size() <= targetIndexCount || triangleCount == 0)
+    return {indices.begin(), indices.end()};
+
+  auto attribute = [&](uint32_t vertex) { return attributes.data.data() + size_t(vertex) * numAttributes; };
+
+  // Weld the vertices sharing the same position: the canonical vertex is the first one found. Only the vertices of
+  // the triangles are welded, the others (e.g. used by another primitive of the accessor) must never be output.
+  std::vector<uint32_t> canonical(vertexCount);
+  {
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    for(uint32_t index : indices)
+      referenced[index] = 1;
+    std::unordered_map<glm::vec3, uint32_t, PositionHash, PositionEqual> positionMap;
+    positionMap.reserve(vertexCount);
+    for(uint32_t v = 0; v < vertexCount; v++)
+      canonical[v] = referenced[v] ? positionMap.try_emplace(positions[v], v).first->second : v;
+  }
+
+  // Lock the vertices on attribute seams: welded vertices with different attributes
+  std::vector<uint8_t> locked(vertexCount, 0);
+  for(uint32_t v = 0; v < vertexCount; v++)
+  {
+    const uint32_t c = canonical[v];
+    if(c != v && numAttributes > 0 && memcmp(attribute(v), attribute(c), numAttributes * sizeof(float)) != 0)
+      locked[c] = 1;
+  }
+
+  // Triangles on welded vertices, and the triangles around each vertex
+  std::vector<uint32_t>              triangles(triangleCount * 3);
+  std::vector<uint8_t>               triangleAlive(triangleCount, 1);
+  std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+  size_t                             aliveCount = 0;
+  for(size_t t = 0; t < triangleCount; t++)
+  {
+    for(int k = 0; k < 3; k++)
+      triangles[t * 3 + k] = canonical[indices[t * 3 + k]];
+    const uint32_t* tri = &triangles[t * 3];
+    if(tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2])
+    {
+      triangleAlive[t] = 0;
+      continue;
+    }
+    for(int k = 0; k < 3; k++)
+      vertexTriangles[tri[k]].push_back(uint32_t(t));
+    aliveCount++;
+  }
+
+  // Lock the vertices on borders and non-manifold edges (edges not shared by exactly two triangles)
+  std::vector<uint64_t> edges;
+  edges.reserve(aliveCount * 3);
+  for(size_t t = 0; t < triangleCount; t++)
+  {
+    if(!triangleAlive[t])
+      continue;
+    for(int k = 0; k < 3; k++)
+    {
+      const uint32_t a = triangles[t * 3 + k];
+      const uint32_t b = triangles[t * 3 + (k + 1) % 3];
+      edges.push_back((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  for(size_t i = 0; i < edges.size();)
+  {
+    size_t j = i;
+    while(j < edges.size() && edges[j] == edges[i])
+      j++;
+    if(j - i != 2)
+    {
+      locked[uint32_t(edges[i] >> 32)]         = 1;
+      locked[uint32_t(edges[i] & 0xFFFFFFFFU)] = 1;
+    }
+    i = j;
+  }
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+  // Area weighted plane quadrics
+  std::vector<Quadric> quadrics(vertexCount);
+  for(size_t t = 0; t < triangleCount; t++)
+  {
+    if(!triangleAlive[t])
+      continue;
+    const uint32_t* tri    = &triangles[t * 3];
+    const glm::vec3 normal = glm::cross(positions[tri[1]] - positions[tri[0]], positions[tri[2]] - positions[tri[0]]);
+    const float     len    = glm::length(normal);
+    if(len <= 0.0F)
+      continue;
+    const glm::vec3 n = normal / len;
+    const float     d = -glm::dot(n, positions[tri[0]]);
+    for(int k = 0; k < 3; k++)
+      quadrics[tri[k]].addPlane(n, d, len * 0.5F);
+  }
+
+  // Attribute differences are expressed relative to the mesh size, to be comparable with distances
+  glm::vec3 bboxMin(FLT_MAX), bboxMax(-FLT_MAX);
+  for(const glm::vec3& p : positions)
+  {
+    bboxMin = glm::min(bboxMin, p);
+    bboxMax = glm::max(bboxMax, p);
+  }
+  const double meshScale2 = double(glm::dot(bboxMax - bboxMin, bboxMax - bboxMin));
+
+  auto collapseCost = [&](uint32_t from, uint32_t to, double& geometricError) {
+    Quadric q = quadrics[from];
+    q.add(quadrics[to]);
+    geometricError   = q.error(positions[to]);
+    double attribute = 0.0;
+    for(uint32_t i = 0; i < numAttributes; i++)
+    {
+      const double diff = double(attributes.data[size_t(from) * numAttributes + i]) - attributes.data[size_t(to) * numAttributes + i];
+      attribute += attributes.weights[i] * diff * diff;
+    }
+    return geometricError + attribute * meshScale2;
+  };
+
+  std::vector<uint32_t> version(vertexCount, 0);
+  std::vector<uint8_t>  removed(vertexCount, 0);
+
+  std::priority_queue<Collapse> heap;
+  auto                          pushEdge = [&](uint32_t a, uint32_t b) {
+    double     unused = 0.0;
+    const bool canAB  = !locked[a];
+    const bool canBA  = !locked[b];
+    if(!canAB && !canBA)
+      return;
+    const double costAB = canAB ? collapseCost(a, b, unused) : DBL_MAX;
+    const double costBA = canBA ? collapseCost(b, a, unused) : DBL_MAX;
+    if(costAB <= costBA)
+      heap.push({float(costAB), a, b, version[a], version[b]});
+    else
+      heap.push({float(costBA), b, a, version[b], version[a]});
+  };
+  for(uint64_t edge : edges)
+    pushEdge(uint32_t(edge >> 32), uint32_t(edge & 0xFFFFFFFFU));
+
+  // Collapse validity: keep the surface manifold and do not flip triangles
+  std::vector<uint32_t> neighborsFrom, neighborsTo;
+  auto                  collectNeighbors = [&](uint32_t v, std::vector<uint32_t>& result) {
+    result.clear();
+    for(uint32_t t : vertexTriangles[v])
+    {
+      if(!triangleAlive[t])
+        continue;
+      for(int k = 0; k < 3; k++)
+        if(triangles[t * 3 + k] != v)
+          result.push_back(triangles[t * 3 + k]);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+  };
+  auto isValidCollapse = [&](uint32_t from, uint32_t to) {
+    // Link condition: an edge collapse keeps the surface manifold when the endpoints share at most 2 neighbors.
+    // The sorted neighbor lists are merged in place, without allocation in this hot loop.
+    collectNeighbors(from, neighborsFrom);
+    collectNeighbors(to, neighborsTo);
+    uint32_t sharedCount = 0;
+    for(size_t i = 0, j = 0; i < neighborsFrom.size() && j < neighborsTo.size();)
+    {
+      if(neighborsFrom[i] < neighborsTo[j])
+        i++;
+      else if(neighborsTo[j] < neighborsFrom[i])
+        j++;
+      else
+      {
+        sharedCount++;
+        i++;
+        j++;
+      }
+    }
+    if(sharedCount > 2)
+      return false;
+
+    for(uint32_t t : vertexTriangles[from])
+    {
+      const uint32_t* tri = &triangles[t * 3];
+      if(!triangleAlive[t] || tri[0] == to || tri[1] == to || tri[2] == to)
+        continue;
+      glm::vec3 p[3], q[3];
+      for(int k = 0; k < 3; k++)
+      {
+        p[k] = positions[tri[k]];
+        q[k] = tri[k] == from ? positions[to] : p[k];
+      }
+      const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+      const glm::vec3 after  = glm::cross(q[1] - q[0], q[2] - q[0]);
+      if(glm::dot(before, after) <= 0.2F * glm::length(before) * glm::length(after))
+        return false;
+    }
+    return true;
+  };
+
+  const size_t targetTriangles = targetIndexCount / 3;
+  const double maxCost         = double(targetError) * targetError;
+  double       reachedError    = 0.0;
+  while(aliveCount > targetTriangles && !heap.empty())
+  {
+    const Collapse collapse = heap.top();
+    heap.pop();
+
+    const uint32_t from = collapse.from;
+    const uint32_t to   = collapse.to;
+    if(removed[from] || removed[to] || version[from] != collapse.versionFrom || version[to] != collapse.versionTo)
+      continue;  // Stale entry
+    if(collapse.cost > maxCost)
+      break;
+    if(!isValidCollapse(from, to))
+      continue;
+
+    double geometricError = 0.0;
+    collapseCost(from, to, geometricError);
+    reachedError = std::max(reachedError, geometricError);
+
+    // Move the triangles of `from` to `to`, the ones on the collapsed edge disappear
+    for(uint32_t t : vertexTriangles[from])
+    {
+      if(!triangleAlive[t])
+        continue;
+      uint32_t* tri = &triangles[t * 3];
+      if(tri[0] == to || tri[1] == to || tri[2] == to)
+      {
+        triangleAlive[t] = 0;
+        aliveCount--;
+        continue;
+      }
+      for(int k = 0; k < 3; k++)
+        tri[k] = tri[k] == from ? to : tri[k];
+      vertexTriangles[to].push_back(t);
+    }
+    vertexTriangles[from].clear();
+    std::erase_if(vertexTriangles[to], [&](uint32_t t) { return !triangleAlive[t]; });
+    quadrics[to].add(quadrics[from]);
+    removed[from] = 1;
+    version[to]++;
+
+    // Update the cost of the edges around the merged vertex
+    collectNeighbors(to, neighborsTo);
+    for(uint32_t n : neighborsTo)
+      pushEdge(to, n);
+  }
+
+  if(resultError)
+    *resultError = float(std::sqrt(reachedError));
+
+  // Write the remaining triangles with the original vertices. When a corner moved to a welded vertex,
+  // pick the original vertex of that position with the closest attributes (the proper side of a seam).
+  std::unordered_map<uint32_t, std::vector<uint32_t>> seamVertices;
+  for(uint32_t v = 0; v < vertexCount; v++)
+    if(locked[canonical[v]] && canonical[v] != v)
+      seamVertices[canonical[v]].push_back(v);
+
+  std::vector<uint32_t> result;
+  result.reserve(aliveCount * 3);
+  for(size_t t = 0; t < triangleCount; t++)
+  {
+    if(!triangleAlive[t])
+      continue;
+    for(int k = 0; k < 3; k++)
+    {
+      const uint32_t original = indices[t * 3 + k];
+      const uint32_t current  = triangles[t * 3 + k];
+      if(canonical[original] == current)
+      {
+        result.push_back(original);
+        continue;
+      }
+
+      uint32_t best = current;
+      auto     it   = seamVertices.find(current);
+      if(it != seamVertices.end() && numAttributes > 0)
+      {
+        auto distance = [&](uint32_t v) {
+          float d = 0.0F;
+          for(uint32_t i = 0; i < numAttributes; i++)
+          {
+            const float diff = attribute(v)[i] - attribute(original)[i];
+            d += attributes.weights[i] * diff * diff;
+          }
+          return d;
+        };
+        float bestDistance = distance(current);
+        for(uint32_t v : it->second)
+        {
+          const float d = distance(v);
+          if(d < bestDistance)
+          {
+            bestDistance = d;
+            best         = v;
+          }
+        }
+      }
+      result.push_back(best);
+    }
+  }
+  return result;
+}
+
+std::vector<MeshLod> generateMeshLods(std::span<const uint32_t>  indices,
+                                      std::span<const glm::vec3> positions,
+                                      const SimplifyAttributes&  attributes,
+                                      uint32_t                   maxLodCount /*= 5*/,
+                                      float                      reduction /*= 0.5F*/)
+{
+  std::vector<MeshLod>      lods;
+  std::span<const uint32_t> previous      = indices;
+  float                     previousError = 0.0F;
+  for(uint32_t lod = 0; lod < maxLodCount; lod++)
+  {
+    const size_t target = std::max<size_t>(3, size_t(float(previous.size() / 3) * reduction) * 3);
+
+    MeshLod level;
+    float   error = 0.0F;
+    level.indices = simplifyMesh(previous, positions, attributes, target, FLT_MAX, &error);
+
+    // Stop when the mesh cannot be simplified anymore (locked borders and seams)
+    if(level.indices.empty() || float(level.indices.size()) > float(previous.size()) * 0.9F)
+      break;
+
+    // Each level is simplified from the previous one, errors accumulate
+    level.error   = previousError + error;
+    previousError = level.error;
+    lods.push_back(std::move(level));
+    previous = lods.back().indices;
+  }
+  return lods;
+}
+
+}  // namespace nvsamples
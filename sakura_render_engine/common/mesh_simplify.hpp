@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace nvsamples {
+
+// Vertex attributes taken into account by the simplification, in addition to the positions.
+// The attributes are interleaved floats (e.g. normal + texcoord = 5 floats per vertex), each one with a weight.
+struct SimplifyAttributes
+{
+  std::span<const float> data;     // vertexCount * weights.size() floats
+  std::span<const float> weights;  // Importance of each attribute component, relative to the position error
+};
+
+// A level of detail: triangle list indexing the original vertices, and its object space error
+struct MeshLod
+{
+  std::vector<uint32_t> indices;
+  float                 error = 0.0F;  // RMS distance to the full resolution mesh, in object space (not a maximum)
+};
+
+//--------------------------------------------------------------------------------------------------
+// Simplify a triangle mesh with quadric error metrics (Garland & Heckbert).
+//
+// Edges are collapsed onto one of their vertices (half-edge collapse), so the result only references
+// existing vertices: the simplified index buffer can be used with the original vertex data.
+// Vertices sharing the same position are welded while simplifying; vertices on the mesh border or on
+// attribute seams (UV or normal discontinuities) never move, which keeps the silhouette and the texture
+// mapping intact. The cost of a collapse is the quadric error plus the weighted attribute difference.
+//
+// Stops when the index count reaches targetIndexCount or when the next collapse exceeds targetError.
+// Returns the new index list, and the reached error in resultError (optional).
+//
+// Errors are RMS distances in object space, not relative to the mesh extent: the area weighted root mean square
+// distance of a collapsed vertex to the planes of the original triangles merged into it, the largest one over the
+// collapses. Individual points of the surface can move further. targetError also includes the attribute cost.
+std::vector<uint32_t> simplifyMesh(std::span<const uint32_t>  indices,
+                                   std::span<const glm::vec3> positions,
+                                   const SimplifyAttributes&  attributes,
+                                   size_t                     targetIndexCount,
+                                   float                      targetError,
+                                   float*                     resultError = nullptr);
+
+// Generate a chain of levels of detail, each one having about `reduction` times the triangles of the previous one.
+// LOD 0 (the input) is not part of the result. The chain stops early when a level cannot be simplified further.
+// The error of a level is the sum of the RMS errors of the simplifications leading to it.
+std::vector<MeshLod> generateMeshLods(std::span<const uint32_t>  indices,
+                                      std::span<const glm::vec3> positions,
+                                      const SimplifyAttributes&  attributes,
+                                      uint32_t                   maxLodCount = 5,
+                                      float                      reduction   = 0.5F);
+
+}  // namespace nvsamples
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "meshlet_builder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+
+namespace nvsamples {
+
+MeshletMesh buildMeshlets(std::span<const uint32_t>  indices,
+                          std::span<const glm::vec3> positions,
+                          uint32_t                   maxVertices /*= kMeshletMaxVertices*/,
+                          uint32_t                   maxTriangles /*= kMeshletMaxTriangles*/)
+{
+  assert(maxVertices >= 3 && maxVertices <= 255 && maxTriangles >= 1);
+
+  const size_t vertexCount   = positions.size();
+  const size_t triangleCount = indices.size() / 3;
+  MeshletMesh  result;
+
+  // Triangles around each vertex
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for(size_t i = 0; i < triangleCount * 3; i++)
+    adjacencyOffsets[indices[i] + 1]++;
+  for(size_t v = 0; v < vertexCount; v++)
+    adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(size_t i = 0; i < triangleCount * 3; i++)
+      adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+  }
+
+  auto triangleCenter = [&](uint32_t t) {
+    return (positions[indices[t * 3 + 0]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]]) / 3.0F;
+  };
+
+  constexpr uint8_t     kNotInMeshlet = 0xFF;
+  std::vector<uint8_t>  localIndex(vertexCount, kNotInMeshlet);  // Index of the vertex in the current meshlet
+  std::vector<uint8_t>  emitted(triangleCount, 0);
+  std::vector<uint32_t> meshletVertices;
+  std::vector<uint8_t>  meshletTriangles;
+  glm::vec3             centerSum(0.0F);
+
+  auto addTriangle = [&](uint32_t t) {
+    for(int k = 0; k < 3; k++)
+    {
+      const uint32_t v = indices[t * 3 + k];
+      if(localIndex[v] == kNotInMeshlet)
+      {
+        localIndex[v] = uint8_t(meshletVertices.size());
+        meshletVertices.push_back(v);
+      }
+      meshletTriangles.push_back(localIndex[v]);
+    }
+    centerSum += triangleCenter(t);
+    emitted[t] = 1;
+  };
+
+  auto flushMeshlet = [&]() {
+    Meshlet meshlet;
+    meshlet.vertexOffset   = uint32_t(result.vertices.size());
+    meshlet.triangleOffset = uint32_t(result.triangles.size() / 3);
+    meshlet.vertexCount    = uint32_t(meshletVertices.size());
+    meshlet.triangleCount  = uint32_t(meshletTriangles.size() / 3);
+    meshlet.bounds         = computeMeshletBounds(meshletVertices, meshletTriangles, positions);
+    result.meshlets.push_back(meshlet);
+    result.vertices.insert(result.vertices.end(), meshletVertices.begin(), meshletVertices.end());
+    result.triangles.insert(result.triangles.end(), meshletTriangles.begin(), meshletTriangles.end());
+
+    for(uint32_t v : meshletVertices)
+      localIndex[v] = kNotInMeshlet;
+    meshletVertices.clear();
+    meshletTriangles.clear();
+    centerSum = glm::vec3(0.0F);
+  };
+
+  size_t seed = 0;
+  while(true)
+  {
+    // Seed: the first triangle left, in the index order (which is usually already spatially coherent)
+    while(seed < triangleCount && emitted[seed])
+      seed++;
+    if(seed == triangleCount)
+      break;
+    addTriangle(uint32_t(seed));
+
+    // Grow with the adjacent triangle adding the fewest vertices, then the closest to the meshlet center
+    while(meshletTriangles.size() / 3 < maxTriangles)
+    {
+      const glm::vec3 center       = centerSum / float(meshletTriangles.size() / 3);
+      int64_t         best         = -1;
+      uint32_t        bestNew      = 4;
+      float           bestDistance = FLT_MAX;
+      for(uint32_t v : meshletVertices)
+      {
+        for(uint32_t a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; a++)
+        {
+          const uint32_t t = adjacency[a];
+          if(emitted[t])
+            continue;
+          uint32_t newVertices = 0;
+          for(int k = 0; k < 3; k++)
+            newVertices += localIndex[indices[t * 3 + k]] == kNotInMeshlet;
+          if(meshletVertices.size() + newVertices > maxVertices || newVertices > bestNew)
+            continue;
+          const glm::vec3 d        = triangleCenter(t) - center;
+          const float     distance = glm::dot(d, d);
+          if(newVertices < bestNew || distance < bestDistance)
+          {
+            best         = t;
+            bestNew      = newVertices;
+            bestDistance = distance;
+          }
+        }
+      }
+      if(best < 0)
+        break;
+      addTriangle(uint32_t(best));
+    }
+    flushMeshlet();
+  }
+
+  return result;
+}
+
+MeshletBounds computeMeshletBounds(std::span<const uint32_t>  vertices,
+                                   std::span<const uint8_t>   triangles,
+                                   std::span<const glm::vec3> positions)
+{
+  MeshletBounds bounds;
+  if(vertices.empty())
+    return bounds;
+
+  // Sphere around the center of the bounding box
+  glm::vec3 bboxMin(FLT_MAX), bboxMax(-FLT_MAX);
+  for(uint32_t v : vertices)
+  {
+    bboxMin = glm::min(bboxMin, positions[v]);
+    bboxMax = glm::max(bboxMax, positions[v]);
+  }
+  bounds.center = (bboxMin + bboxMax) * 0.5F;
+  for(uint32_t v : vertices)
+    bounds.radius = std::max(bounds.radius, glm::length(positions[v] - bounds.center));
+  bounds.coneApex = bounds.center;
+
+  // Normal cone: average of the triangle normals, and the widest deviation from it
+  std::vector<glm::vec3> normals;
+  normals.reserve(triangles.size() / 3);
+  glm::vec3 axis(0.0F);
+  for(size_t i = 0; i + 2 < triangles.size(); i += 3)
+  {
+    const glm::vec3& p0     = positions[vertices[triangles[i + 0]]];
+    const glm::vec3& p1     = positions[vertices[triangles[i + 1]]];
+    const glm::vec3& p2     = positions[vertices[triangles[i + 2]]];
+    const glm::vec3  normal = glm::cross(p1 - p0, p2 - p0);
+    const float      len    = glm::length(normal);
+    normals.push_back(len > 0.0F ? normal / len : glm::vec3(0.0F));
+    axis += normals.back();
+  }
+  const float axisLength = glm::length(axis);
+  if(axisLength <= 0.0F)
+    return bounds;
+  axis /= axisLength;
+
+  float minDot = 1.0F;
+  for(const glm::vec3& n : normals)
+    if(n != glm::vec3(0.0F))
+      minDot = std::min(minDot, glm::dot(axis, n));
+
+  // Normals spread over more than ~84 degrees: the cone would almost never cull anything
+  if(minDot <= 0.1F)
+    return bounds;
+
+  // Move the apex back along the axis, until it is behind all the triangle planes
+  float maxT = 0.0F;
+  for(size_t i = 0; i < normals.size(); i++)
+  {
+    const glm::vec3& n = normals[i];
+    if(n == glm::vec3(0.0F))
+      continue;
+    const glm::vec3& p0 = positions[vertices[triangles[i * 3]]];
+    maxT                = std::max(maxT, glm::dot(bounds.center - p0, n) / glm::dot(axis, n));
+  }
+
+  bounds.coneApex   = bounds.center - axis * maxT;
+  bounds.coneAxis   = axis;
+  bounds.coneCutoff = std::sqrt(1.0F - minDot * minDot);
+  return bounds;
+}
+
+std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& viewProjMatrix)
+{
+  auto row = [&](int i) {
+    return glm::vec4(viewProjMatrix[0][i], viewProjMatrix[1][i], viewProjMatrix[2][i], viewProjMatrix[3][i]);
+  };
+
+  std::array<glm::vec4, 6> planes = {
+      row(3) + row(0),  // Left
+      row(3) - row(0),  // Right
+      row(3) + row(1),  // Bottom (top with the Vulkan flip)
+      row(3) - row(1),  // Top
+      row(2),           // Near (depth 0)
+      row(3) - row(2),  // Far (depth 1)
+  };
+  for(glm::vec4& plane : planes)
+    plane /= glm::length(glm::vec3(plane));
+  return planes;
+}
+
+bool isSphereOutsideFrustum(const std::array<glm::vec4, 6>& planes, const glm::vec3& center, float radius)
+{
+  for(const glm::vec4& plane : planes)
+    if(glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+      return true;
+  return false;
+}
+
+bool isMeshletBackfacing(const MeshletBounds& bounds, const glm::vec3& cameraPosition)
+{
+  const glm::vec3 view = bounds.coneApex - cameraPosition;
+  const float     len  = glm::length(view);
+  return len > 0.0F && glm::dot(view / len, bounds.coneAxis) >= bounds.coneCutoff;
+}
+
+}  // namespace nvsamples
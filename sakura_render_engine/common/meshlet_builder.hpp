@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace nvsamples {
+
+// Limits of a meshlet, matching the outputs declared by the mesh shader
+constexpr uint32_t kMeshletMaxVertices  = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+// Culling data of a meshlet, in object space
+struct MeshletBounds
+{
+  glm::vec3 center{};      // Bounding sphere
+  float     radius = 0.0F;
+  glm::vec3 coneApex{};    // Normal cone: all triangles face away from a camera inside the cone
+  glm::vec3 coneAxis{};    //   (the cone opens along -coneAxis from the apex)
+  float     coneCutoff = 1.0F;  // Sine of the cone half angle, 1 disables the backface culling
+};
+
+// A meshlet refers to a range of vertices (indices of the mesh vertices) and of local triangles (3 bytes each)
+struct Meshlet
+{
+  uint32_t      vertexOffset   = 0;
+  uint32_t      triangleOffset = 0;  // In triangles, 3 bytes per triangle in `triangles`
+  uint32_t      vertexCount    = 0;
+  uint32_t      triangleCount  = 0;
+  MeshletBounds bounds;
+};
+
+struct MeshletMesh
+{
+  std::vector<Meshlet>  meshlets;
+  std::vector<uint32_t> vertices;   // Mesh vertex index of each meshlet vertex
+  std::vector<uint8_t>  triangles;  // Meshlet-local vertex indices, 3 per triangle
+};
+
+//--------------------------------------------------------------------------------------------------
+// Partition a triangle list into meshlets of at most maxVertices vertices and maxTriangles triangles.
+// Meshlets are grown greedily from a seed triangle, preferring the adjacent triangles that add the fewest new
+// vertices, then the closest ones, which keeps the meshlets compact for the sphere and the normal cone culling.
+MeshletMesh buildMeshlets(std::span<const uint32_t>  indices,
+                          std::span<const glm::vec3> positions,
+                          uint32_t                   maxVertices  = kMeshletMaxVertices,
+                          uint32_t                   maxTriangles = kMeshletMaxTriangles);
+
+// Bounding sphere and normal cone of a set of triangles (meshlet-local indices into `vertices`)
+MeshletBounds computeMeshletBounds(std::span<const uint32_t>  vertices,
+                                   std::span<const uint8_t>   triangles,
+                                   std::span<const glm::vec3> positions);
+
+// Frustum planes (xyz: inward normal, w: distance) from a view-projection matrix with a [0,1] depth range
+std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& viewProjMatrix);
+
+// Return true if the sphere is entirely outside of one of the frustum planes
+bool isSphereOutsideFrustum(const std::array<glm::vec4, 6>& planes, const glm::vec3& center, float radius);
+
+// Return true if all triangles of the meshlet face away from the camera (same space for bounds and camera).
+// The same test is done by the task shader.
+bool isMeshletBackfacing(const MeshletBounds& bounds, const glm::vec3& cameraPosition);
+
+}  // namespace nvsamples
@@ -0,0 +1,577 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "meshopt_decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MESHOPT_USE_SSE2 1
+#endif
+
+namespace nvsamples {
+
+namespace {
+
+constexpr uint8_t kVertexHeader   = 0xA0;
+constexpr uint8_t kIndexHeader    = 0xE0;
+constexpr uint8_t kSequenceHeader = 0xD0;
+
+constexpr size_t kByteGroupSize        = 16;
+constexpr size_t kByteGroupDecodeLimit = 24;  // Largest encoded group: 16 bytes of 4 bits + 8 bytes of sentinels
+constexpr size_t kVertexBlockSizeBytes = 8192;
+constexpr size_t kVertexBlockMaxSize   = 256;
+constexpr size_t kTailMaxSize          = 32;
+
+//--------------------------------------------------------------------------------------------------
+// Vertex codec
+
+// Group of 16 values of 2^bitsLog2 bits, MSB first. The all-ones value is a sentinel for a byte stored after the group.
+const uint8_t* decodeBytesGroup(const uint8_t* data, uint8_t* buffer, int bitsLog2)
+{
+  switch(bitsLog2)
+  {
+    case 0:
+      memset(buffer, 0, kByteGroupSize);
+      return data;
+    case 1:
+    case 2: {
+      const uint32_t bits     = 1U << bitsLog2;
+      const uint32_t sentinel = (1U << bits) - 1U;
+      const uint8_t* extra    = data + bits * 2;  // 16 values of `bits` bits
+      for(size_t i = 0; i < kByteGroupSize; i++)
+      {
+        const uint32_t bitOffset = uint32_t(i) * bits;
+        const uint32_t value     = (data[bitOffset / 8] >> (8 - bits - bitOffset % 8)) & sentinel;
+        buffer[i]                = value == sentinel ? *extra++ : uint8_t(value);
+      }
+      return extra;
+    }
+    default:
+      memcpy(buffer, data, kByteGroupSize);
+      return data + kByteGroupSize;
+  }
+}
+
+// `size` bytes (multiple of 16): 2-bit mode of each group in a header, then the groups
+const uint8_t* decodeBytes(const uint8_t* data, const uint8_t* dataEnd, uint8_t* buffer, size_t size)
+{
+  const uint8_t* header     = data;
+  const size_t   headerSize = (size / kByteGroupSize + 3) / 4;
+  if(size_t(dataEnd - data) < headerSize)
+    return nullptr;
+  data += headerSize;
+
+  for(size_t i = 0; i < size; i += kByteGroupSize)
+  {
+    if(size_t(dataEnd - data) < kByteGroupDecodeLimit)
+      return nullptr;
+    const size_t group = i / kByteGroupSize;
+    data               = decodeBytesGroup(data, buffer + i, (header[group / 4] >> ((group % 4) * 2)) & 3);
+  }
+  return data;
+}
+
+// Zigzag deltas to values, in place: buffer[i] = previous + unzigzag(buffer[i]) (size is a multiple of 16)
+void decodeDeltas(uint8_t* buffer, size_t size, uint8_t previous)
+{
+#if defined(MESHOPT_USE_SSE2)
+  const __m128i one   = _mm_set1_epi8(1);
+  const __m128i low7  = _mm_set1_epi8(0x7F);
+  const __m128i zero  = _mm_setzero_si128();
+  __m128i       carry = _mm_set1_epi8(char(previous));
+  for(size_t i = 0; i < size; i += kByteGroupSize)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+    v = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(v, 1), low7), _mm_sub_epi8(zero, _mm_and_si128(v, one)));
+    // Inclusive prefix sum of the 16 bytes
+    v     = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+    v     = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+    v     = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+    v     = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+    v     = _mm_add_epi8(v, carry);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i), v);
+    carry = _mm_set1_epi8(char(buffer[i + kByteGroupSize - 1]));
+  }
+#else
+  for(size_t i = 0; i < size; i++)
+  {
+    const uint8_t v = buffer[i];
+    previous        = uint8_t(previous + uint8_t((v >> 1) ^ uint8_t(-int(v & 1))));
+    buffer[i]       = previous;
+  }
+#endif
+}
+
+// Block of vertices: one byte stream per byte of the vertex, deltas from the previous vertex
+const uint8_t* decodeVertexBlock(const uint8_t* data,
+                                 const uint8_t* dataEnd,
+                                 uint8_t*       vertexData,
+                                 size_t         vertexCount,
+                                 size_t         vertexSize,
+                                 uint8_t        lastVertex[256])
+{
+  uint8_t      buffer[kVertexBlockMaxSize];
+  const size_t alignedCount = (vertexCount + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+
+  for(size_t k = 0; k < vertexSize; k++)
+  {
+    data = decodeBytes(data, dataEnd, buffer, alignedCount);
+    if(!data)
+      return nullptr;
+    decodeDeltas(buffer, alignedCount, lastVertex[k]);
+    for(size_t i = 0; i < vertexCount; i++)
+      vertexData[i * vertexSize + k] = buffer[i];
+  }
+  memcpy(lastVertex, vertexData + (vertexCount - 1) * vertexSize, vertexSize);
+  return data;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Index codecs
+
+uint32_t decodeVByte(const uint8_t*& data)
+{
+  const uint8_t lead = *data++;
+  if(lead < 128)
+    return lead;
+
+  uint32_t result = lead & 127;
+  uint32_t shift  = 7;
+  for(int i = 0; i < 4; i++)
+  {
+    const uint8_t group = *data++;
+    result |= uint32_t(group & 127) << shift;
+    shift += 7;
+    if(group < 128)
+      break;
+  }
+  return result;
+}
+
+uint32_t decodeIndex(const uint8_t*& data, uint32_t last)
+{
+  const uint32_t v = decodeVByte(data);
+  return last + ((v >> 1) ^ uint32_t(-int32_t(v & 1)));
+}
+
+void writeIndex(void* destination, size_t i, size_t indexSize, uint32_t index)
+{
+  if(indexSize == 2)
+    static_cast<uint16_t*>(destination)[i] = uint16_t(index);
+  else
+    static_cast<uint32_t*>(destination)[i] = index;
+}
+
+// FIFOs of the index codec, reads are wrapped around the 16 entries
+struct IndexFifos
+{
+  uint32_t edges[16][2];
+  uint32_t vertices[16];
+  uint32_t edgeOffset   = 0;
+  uint32_t vertexOffset = 0;
+
+  IndexFifos()
+  {
+    memset(edges, -1, sizeof(edges));
+    memset(vertices, -1, sizeof(vertices));
+  }
+
+  void pushVertex(uint32_t v, bool condition = true)
+  {
+    vertices[vertexOffset] = v;
+    vertexOffset           = (vertexOffset + uint32_t(condition)) & 15;
+  }
+  void pushEdge(uint32_t a, uint32_t b)
+  {
+    edges[edgeOffset][0] = a;
+    edges[edgeOffset][1] = b;
+    edgeOffset           = (edgeOffset + 1) & 15;
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+// Filters
+
+template <typename T>
+void decodeOctahedralScalar(T* data, size_t begin, size_t count)
+{
+  const float maxValue = float((1 << (sizeof(T) * 8 - 1)) - 1);
+  for(size_t i = begin; i < count; i++)
+  {
+    // z is stored with the same bit count as 1.0, the octahedral coordinates are unfolded for z < 0
+    float       x = float(data[i * 4 + 0]);
+    float       y = float(data[i * 4 + 1]);
+    const float z = float(data[i * 4 + 2]) - std::abs(x) - std::abs(y);
+    const float t = std::min(z, 0.0F);
+    x += x >= 0.0F ? t : -t;
+    y += y >= 0.0F ? t : -t;
+
+    const float s   = maxValue / std::sqrt(x * x + y * y + z * z);
+    data[i * 4 + 0] = T(int(x * s + (x >= 0.0F ? 0.5F : -0.5F)));
+    data[i * 4 + 1] = T(int(y * s + (y >= 0.0F ? 0.5F : -0.5F)));
+    data[i * 4 + 2] = T(int(z * s + (z >= 0.0F ? 0.5F : -0.5F)));
+  }
+}
+
+#if defined(MESHOPT_USE_SSE2)
+// Four elements at once: x, y, z, w as int32 lanes of 4 vectors (w is kept as is)
+void decodeOctahedralSse2(__m128i& xi, __m128i& yi, __m128i& zi, float maxValue)
+{
+  const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+  const __m128 half     = _mm_set1_ps(0.5F);
+
+  __m128       x = _mm_cvtepi32_ps(xi);
+  __m128       y = _mm_cvtepi32_ps(yi);
+  const __m128 z = _mm_sub_ps(_mm_sub_ps(_mm_cvtepi32_ps(zi), _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+  const __m128 t = _mm_min_ps(z, _mm_setzero_ps());
+  // x += x >= 0 ? t : -t, the sign of x flips the sign of t
+  x = _mm_add_ps(x, _mm_xor_ps(t, _mm_and_ps(x, signMask)));
+  y = _mm_add_ps(y, _mm_xor_ps(t, _mm_and_ps(y, signMask)));
+
+  const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+  const __m128 s             = _mm_div_ps(_mm_set1_ps(maxValue), _mm_sqrt_ps(lengthSquared));
+
+  // Round half away from zero
+  auto round = [&](__m128 v) {
+    v = _mm_mul_ps(v, s);
+    return _mm_cvttps_epi32(_mm_add_ps(v, _mm_or_ps(half, _mm_and_ps(v, signMask))));
+  };
+  xi = round(x);
+  yi = round(y);
+  zi = round(z);
+}
+
+// 4x4 transpose of int32 lanes
+void transpose4(__m128i& r0, __m128i& r1, __m128i& r2, __m128i& r3)
+{
+  const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+  const __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+  const __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+  const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+  r0               = _mm_unpacklo_epi64(t0, t1);
+  r1               = _mm_unpackhi_epi64(t0, t1);
+  r2               = _mm_unpacklo_epi64(t2, t3);
+  r3               = _mm_unpackhi_epi64(t2, t3);
+}
+#endif
+
+void decodeOctahedral8(int8_t* data, size_t count)
+{
+  size_t i = 0;
+#if defined(MESHOPT_USE_SSE2)
+  for(; i + 4 <= count; i += 4)
+  {
+    const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i lo = _mm_unpacklo_epi8(v, v);
+    const __m128i hi = _mm_unpackhi_epi8(v, v);
+    __m128i       e0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24);
+    __m128i       e1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24);
+    __m128i       e2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24);
+    __m128i       e3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24);
+    transpose4(e0, e1, e2, e3);
+    decodeOctahedralSse2(e0, e1, e2, 127.0F);
+    transpose4(e0, e1, e2, e3);
+    const __m128i packed = _mm_packs_epi16(_mm_packs_epi32(e0, e1), _mm_packs_epi32(e2, e3));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), packed);
+  }
+#endif
+  decodeOctahedralScalar(data, i, count);
+}
+
+void decodeOctahedral16(int16_t* data, size_t count)
+{
+  size_t i = 0;
+#if defined(MESHOPT_USE_SSE2)
+  for(; i + 4 <= count; i += 4)
+  {
+    const __m128i a  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4));
+    const __m128i b  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 4 + 8));
+    __m128i       e0 = _mm_srai_epi32(_mm_unpacklo_epi16(a, a), 16);
+    __m128i       e1 = _mm_srai_epi32(_mm_unpackhi_epi16(a, a), 16);
+    __m128i       e2 = _mm_srai_epi32(_mm_unpacklo_epi16(b, b), 16);
+    __m128i       e3 = _mm_srai_epi32(_mm_unpackhi_epi16(b, b), 16);
+    transpose4(e0, e1, e2, e3);
+    decodeOctahedralSse2(e0, e1, e2, 32767.0F);
+    transpose4(e0, e1, e2, e3);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4), _mm_packs_epi32(e0, e1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i * 4 + 8), _mm_packs_epi32(e2, e3));
+  }
+#endif
+  decodeOctahedralScalar(data, i, count);
+}
+
+void decodeQuaternion(int16_t* data, size_t count)
+{
+  const float scale = 1.0F / std::sqrt(2.0F);
+  for(size_t i = 0; i < count; i++)
+  {
+    // The scale of the 3 stored components is in the high bits of the 4th, the index of the largest one in its 2 low bits
+    const int   sf = data[i * 4 + 3] | 3;
+    const float ss = scale / float(sf);
+    const float x  = float(data[i * 4 + 0]) * ss;
+    const float y  = float(data[i * 4 + 1]) * ss;
+    const float z  = float(data[i * 4 + 2]) * ss;
+    const float w  = std::sqrt(std::max(1.0F - x * x - y * y - z * z, 0.0F));
+
+    const int qc                  = data[i * 4 + 3] & 3;
+    data[i * 4 + ((qc + 1) & 3)] = int16_t(int(x * 32767.0F + (x >= 0.0F ? 0.5F : -0.5F)));
+    data[i * 4 + ((qc + 2) & 3)] = int16_t(int(y * 32767.0F + (y >= 0.0F ? 0.5F : -0.5F)));
+    data[i * 4 + ((qc + 3) & 3)] = int16_t(int(z * 32767.0F + (z >= 0.0F ? 0.5F : -0.5F)));
+    data[i * 4 + ((qc + 0) & 3)] = int16_t(int(w * 32767.0F + 0.5F));
+  }
+}
+
+// 24-bit signed mantissa and 8-bit signed exponent to float
+void decodeExponential(uint32_t* data, size_t count)
+{
+  size_t i = 0;
+#if defined(MESHOPT_USE_SSE2)
+  for(; i + 4 <= count; i += 4)
+  {
+    const __m128i v        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+    const __m128i exponent = _mm_srai_epi32(v, 24);
+    const __m128  power    = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+    _mm_storeu_ps(reinterpret_cast<float*>(data + i), _mm_mul_ps(power, _mm_cvtepi32_ps(mantissa)));
+  }
+#endif
+  for(; i < count; i++)
+  {
+    const int32_t  mantissa = int32_t(data[i] << 8) >> 8;
+    const int32_t  exponent = int32_t(data[i]) >> 24;
+    const uint32_t powerBits = uint32_t(exponent + 127) << 23;
+    float          power;
+    memcpy(&power, &powerBits, sizeof(power));
+    const float result = power * float(mantissa);
+    memcpy(&data[i], &result, sizeof(result));
+  }
+}
+
+}  // namespace
+
+bool decodeMeshoptVertexBuffer(void* destination, size_t count, size_t byteStride, std::span<const uint8_t> source)
+{
+  if(byteStride == 0 || byteStride > 256 || byteStride % 4 != 0)
+    return false;
+  if(source.size() < 1 + byteStride)
+    return false;
+
+  const uint8_t* data    = source.data();
+  const uint8_t* dataEnd = data + source.size();
+  const uint8_t  header  = *data++;
+  if((header & 0xF0) != kVertexHeader || (header & 0x0F) > 0)
+    return false;
+
+  // The first vertex (the reference of the first deltas) is stored at the end of the stream
+  uint8_t lastVertex[256];
+  memcpy(lastVertex, dataEnd - byteStride, byteStride);
+
+  const size_t blockSize   = std::min((kVertexBlockSizeBytes / byteStride) & ~(kByteGroupSize - 1), kVertexBlockMaxSize);
+  uint8_t*     vertexData  = static_cast<uint8_t*>(destination);
+  for(size_t offset = 0; offset < count; offset += blockSize)
+  {
+    const size_t blockCount = std::min(blockSize, count - offset);
+    data = decodeVertexBlock(data, dataEnd, vertexData + offset * byteStride, blockCount, byteStride, lastVertex);
+    if(!data)
+      return false;
+  }
+
+  return size_t(dataEnd - data) == std::max(byteStride, kTailMaxSize);
+}
+
+bool decodeMeshoptIndexBuffer(void* destination, size_t count, size_t indexSize, std::span<const uint8_t> source)
+{
+  if(count % 3 != 0 || (indexSize != 2 && indexSize != 4))
+    return false;
+  if(source.size() < 1 + count / 3 + 16)
+    return false;
+  if((source[0] & 0xF0) != kIndexHeader || (source[0] & 0x0F) > 1)
+    return false;
+
+  const int      fecMax      = (source[0] & 0x0F) >= 1 ? 13 : 15;
+  const uint8_t* code        = source.data() + 1;                     // One code per triangle
+  const uint8_t* data        = code + count / 3;                      // Auxiliary codes and free indices
+  const uint8_t* dataSafeEnd = source.data() + source.size() - 16;  // Followed by the table of common auxiliary codes
+  const uint8_t* codeauxTable = dataSafeEnd;
+
+  IndexFifos fifos;
+  uint32_t   next = 0;  // Next new vertex
+  uint32_t   last = 0;  // Last free index, free indices are delta-encoded
+
+  for(size_t i = 0; i < count; i += 3)
+  {
+    if(data > dataSafeEnd)
+      return false;
+
+    const uint8_t codetri = *code++;
+    if(codetri < 0xF0)
+    {
+      // Triangle on a recent edge, the third vertex is new, recent or free
+      const int      fe = codetri >> 4;
+      const uint32_t a  = fifos.edges[(fifos.edgeOffset - 1 - fe) & 15][0];
+      const uint32_t b  = fifos.edges[(fifos.edgeOffset - 1 - fe) & 15][1];
+      const int      fec = codetri & 15;
+      uint32_t       c;
+      if(fec < fecMax)
+      {
+        c = fec == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - 1 - fec) & 15];
+        fifos.pushVertex(c, fec == 0);
+      }
+      else
+      {
+        // 13 and 14 are -1 and +1 from the last free index, 15 is an explicit delta
+        last = c = fec != 15 ? last + (fec - (fec ^ 3)) : decodeIndex(data, last);
+        fifos.pushVertex(c);
+      }
+      writeIndex(destination, i + 0, indexSize, a);
+      writeIndex(destination, i + 1, indexSize, b);
+      writeIndex(destination, i + 2, indexSize, c);
+      fifos.pushEdge(c, b);
+      fifos.pushEdge(a, c);
+    }
+    else
+    {
+      // Triangle without a recent edge: the first vertex is new (or free), the others are described by codeaux
+      uint32_t a, b, c;
+      int      feb, fec;
+      if(codetri < 0xFE)
+      {
+        const uint8_t codeaux = codeauxTable[codetri & 15];
+        feb                   = codeaux >> 4;
+        fec                   = codeaux & 15;
+        a                     = next++;
+        b                     = feb == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - feb) & 15];
+        c                     = fec == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - fec) & 15];
+        fifos.pushVertex(a);
+        fifos.pushVertex(b, feb == 0);
+        fifos.pushVertex(c, fec == 0);
+      }
+      else
+      {
+        const uint8_t codeaux = *data++;
+        const int     fea     = codetri == 0xFE ? 0 : 15;
+        feb                   = codeaux >> 4;
+        fec                   = codeaux & 15;
+        if(codeaux == 0)
+          next = 0;  // Reset
+
+        // 1..14 are vertex FIFO references as in the table case, 15 is a free index
+        a = fea == 0 ? next++ : 0;
+        b = feb == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - feb) & 15];
+        c = fec == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - fec) & 15];
+        if(fea == 15)
+          last = a = decodeIndex(data, last);
+        if(feb == 15)
+          last = b = decodeIndex(data, last);
+        if(fec == 15)
+          last = c = decodeIndex(data, last);
+        fifos.pushVertex(a);
+        fifos.pushVertex(b, feb == 0 || feb == 15);
+        fifos.pushVertex(c, fec == 0 || fec == 15);
+      }
+      writeIndex(destination, i + 0, indexSize, a);
+      writeIndex(destination, i + 1, indexSize, b);
+      writeIndex(destination, i + 2, indexSize, c);
+      fifos.pushEdge(b, a);
+      fifos.pushEdge(c, b);
+      fifos.pushEdge(a, c);
+    }
+  }
+
+  // All the data must have been read, up to the codeaux table
+  return data == dataSafeEnd;
+}
+
+bool decodeMeshoptIndexSequence(void* destination, size_t count, size_t indexSize, std::span<const uint8_t> source)
+{
+  if(indexSize != 2 && indexSize != 4)
+    return false;
+  if(source.size() < 1 + count + 4)
+    return false;
+  if((source[0] & 0xF0) != kSequenceHeader || (source[0] & 0x0F) > 1)
+    return false;
+
+  const uint8_t* data        = source.data() + 1;
+  const uint8_t* dataSafeEnd = source.data() + source.size() - 4;
+  uint32_t       last[2]     = {};  // Two baselines, selected by the low bit of each value
+
+  for(size_t i = 0; i < count; i++)
+  {
+    if(data >= dataSafeEnd)
+      return false;
+    uint32_t       v        = decodeVByte(data);
+    const uint32_t baseline = v & 1;
+    v >>= 1;
+    const uint32_t index = last[baseline] + ((v >> 1) ^ uint32_t(-int32_t(v & 1)));
+    last[baseline]       = index;
+    writeIndex(destination, i, indexSize, index);
+  }
+
+  return data == dataSafeEnd;
+}
+
+void decodeMeshoptFilter(void* data, size_t count, size_t byteStride, MeshoptFilter filter)
+{
+  switch(filter)
+  {
+    case MeshoptFilter::eOctahedral:
+      if(byteStride == 4)
+        decodeOctahedral8(static_cast<int8_t*>(data), count);
+      else if(byteStride == 8)
+        decodeOctahedral16(static_cast<int16_t*>(data), count);
+      break;
+    case MeshoptFilter::eQuaternion:
+      if(byteStride == 8)
+        decodeQuaternion(static_cast<int16_t*>(data), count);
+      break;
+    case MeshoptFilter::eExponential:
+      decodeExponential(static_cast<uint32_t*>(data), count * (byteStride / 4));
+      break;
+    default:
+      break;
+  }
+}
+
+bool decodeMeshoptStream(void*                    destination,
+                         size_t                   count,
+                         size_t                   byteStride,
+                         MeshoptMode              mode,
+                         MeshoptFilter            filter,
+                         std::span<const uint8_t> source)
+{
+  switch(mode)
+  {
+    case MeshoptMode::eAttributes:
+      if(!decodeMeshoptVertexBuffer(destination, count, byteStride, source))
+        return false;
+      decodeMeshoptFilter(destination, count, byteStride, filter);
+      return true;
+    case MeshoptMode::eTriangles:
+      return decodeMeshoptIndexBuffer(destination, count, byteStride, source);
+    case MeshoptMode::eIndices:
+      return decodeMeshoptIndexSequence(destination, count, byteStride, source);
+  }
+  return false;
+}
+
+}  // namespace nvsamples
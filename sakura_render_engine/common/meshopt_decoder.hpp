@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+//--------------------------------------------------------------------------------------------------
+// Decoders of the EXT_meshopt_compression bitstreams
+//
+// - ATTRIBUTES: vertex codec, byte-wise delta from the previous vertex, packed in groups of 16 bytes of 0/2/4/8 bits
+// - TRIANGLES:  index codec, triangles encoded from an edge and a vertex FIFO
+// - INDICES:    index sequence codec, zigzag varint deltas
+//
+// and of the filters applied on top of the vertex codec (octahedral normals, quaternions, exponent/mantissa floats).
+// The byte group prefix sums and the filters use SSE2 when available, with a scalar fallback.
+// All decoders return false on a malformed stream, the destination content is undefined in that case.
+
+namespace nvsamples {
+
+enum class MeshoptMode
+{
+  eAttributes,
+  eTriangles,
+  eIndices,
+};
+
+enum class MeshoptFilter
+{
+  eNone,
+  eOctahedral,
+  eQuaternion,
+  eExponential,
+};
+
+// `count` elements of `byteStride` bytes (multiple of 4, at most 256)
+bool decodeMeshoptVertexBuffer(void* destination, size_t count, size_t byteStride, std::span<const uint8_t> source);
+
+// `count` indices (multiple of 3) of `indexSize` bytes (2 or 4)
+bool decodeMeshoptIndexBuffer(void* destination, size_t count, size_t indexSize, std::span<const uint8_t> source);
+
+// `count` indices of `indexSize` bytes (2 or 4)
+bool decodeMeshoptIndexSequence(void* destination, size_t count, size_t indexSize, std::span<const uint8_t> source);
+
+// In-place filter of `count` decoded elements of `byteStride` bytes
+void decodeMeshoptFilter(void* data, size_t count, size_t byteStride, MeshoptFilter filter);
+
+// Decode a compressed buffer view: codec of the mode, followed by the filter (attributes only)
+bool decodeMeshoptStream(void*                    destination,
+                         size_t                   count,
+                         size_t                   byteStride,
+                         MeshoptMode              mode,
+                         MeshoptFilter            filter,
+                         std::span<const uint8_t> source);
+
+}  // namespace nvsamples
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "occlusion_culler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "job_system.hpp"
+#include "trace_recorder.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE2 1
+#endif
+
+namespace nvsamples {
+
+void OcclusionCuller::init(uint32_t width, uint32_t height, uint32_t numThreads /*= 0*/)
+{
+  m_tilesX = std::max(1U, (width + kTileWidth - 1) / kTileWidth);
+  m_tilesY = std::max(1U, (height + kTileHeight - 1) / kTileHeight);
+  m_width  = m_tilesX * kTileWidth;
+  m_height = m_tilesY * kTileHeight;
+  m_tiles.resize(size_t(m_tilesX) * m_tilesY);
+
+  if(numThreads == 0)
+    numThreads = JobSystem::getInstance().getThreadCount();
+  m_numThreads = std::min(numThreads, m_tilesY);
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjMatrix)
+{
+  m_viewProj = viewProjMatrix;
+  m_triangles.clear();
+  for(Tile& tile : m_tiles)
+  {
+    std::fill(std::begin(tile.depth), std::end(tile.depth), 1.0F);
+    tile.maxDepth = 1.0F;
+    tile.coverage = 0;
+  }
+}
+
+void OcclusionCuller::addOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const glm::mat4& transform)
+{
+  const glm::mat4 mvp = m_viewProj * transform;
+
+  std::vector<glm::vec4>& clipPos = m_clipPositions;
+  clipPos.resize(positions.size());
+  for(size_t i = 0; i < positions.size(); i++)
+    clipPos[i] = mvp * glm::vec4(positions[i], 1.0F);
+
+  for(size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    const glm::vec4 tri[3] = {clipPos[indices[i + 0]], clipPos[indices[i + 1]], clipPos[indices[i + 2]]};
+
+    // Trivial reject when the whole triangle is on the outside of one of the clip planes
+    bool outside = false;
+    for(int axis = 0; axis < 2 && !outside; axis++)
+    {
+      outside |= tri[0][axis] > tri[0].w && tri[1][axis] > tri[1].w && tri[2][axis] > tri[2].w;
+      outside |= tri[0][axis] < -tri[0].w && tri[1][axis] < -tri[1].w && tri[2][axis] < -tri[2].w;
+    }
+    outside |= tri[0].z < 0.0F && tri[1].z < 0.0F && tri[2].z < 0.0F;
+    if(outside)
+      continue;
+
+    // Clip against the near plane (z >= 0), the result is a polygon of up to 4 vertices
+    glm::vec4 poly[4];
+    int       count = 0;
+    for(int e = 0; e < 3; e++)
+    {
+      const glm::vec4& a = tri[e];
+      const glm::vec4& b = tri[(e + 1) % 3];
+      if(a.z >= 0.0F)
+        poly[count++] = a;
+      if((a.z >= 0.0F) != (b.z >= 0.0F))
+        poly[count++] = a + (b - a) * (a.z / (a.z - b.z));
+    }
+    for(int v = 2; v < count; v++)
+      setupTriangle(poly[0], poly[v - 1], poly[v]);
+  }
+}
+
+void OcclusionCuller::setupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+{
+  // Project to the screen: x,y in pixels and z the depth
+  auto toScreen = [&](const glm::vec4& c) {
+    const float invW = c.w > 1e-7F ? 1.0F / c.w : 1e7F;
+    return glm::vec3((c.x * invW * 0.5F + 0.5F) * float(m_width), (c.y * invW * 0.5F + 0.5F) * float(m_height), c.z * invW);
+  };
+  const glm::vec3 p0 = toScreen(c0);
+  const glm::vec3 p1 = toScreen(c1);
+  const glm::vec3 p2 = toScreen(c2);
+
+  const float area = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+  if(std::fabs(area) < 1e-6F)
+    return;
+
+  ScreenTriangle tri{};
+  tri.minX = std::max(0, int(std::floor(std::min({p0.x, p1.x, p2.x}))));
+  tri.minY = std::max(0, int(std::floor(std::min({p0.y, p1.y, p2.y}))));
+  tri.maxX = std::min(int(m_width) - 1, int(std::ceil(std::max({p0.x, p1.x, p2.x}))));
+  tri.maxY = std::min(int(m_height) - 1, int(std::ceil(std::max({p0.y, p1.y, p2.y}))));
+  if(tri.minX > tri.maxX || tri.minY > tri.maxY)
+    return;
+
+  // Edge functions, oriented so that the inside of the triangle is positive whatever the winding
+  const glm::vec3 v[3] = {p0, p1, p2};
+  const float     sign = area > 0.0F ? 1.0F : -1.0F;
+  for(int e = 0; e < 3; e++)
+  {
+    const glm::vec3& a = v[e];
+    const glm::vec3& b = v[(e + 1) % 3];
+    tri.edgeA[e]       = sign * (a.y - b.y);
+    tri.edgeB[e]       = sign * (b.x - a.x);
+    tri.edgeC[e]       = sign * (a.x * b.y - b.x * a.y);
+  }
+
+  // Depth is linear in screen space. The plane is pushed back by half a pixel of slope,
+  // so that the stored depth is the farthest depth of the triangle over the pixel (conservative).
+  tri.depthA = ((p1.z - p0.z) * (p2.y - p0.y) - (p2.z - p0.z) * (p1.y - p0.y)) / area;
+  tri.depthB = ((p1.x - p0.x) * (p2.z - p0.z) - (p2.x - p0.x) * (p1.z - p0.z)) / area;
+  tri.depthC = p0.z - tri.depthA * p0.x - tri.depthB * p0.y + 0.5F * (std::fabs(tri.depthA) + std::fabs(tri.depthB));
+
+  m_triangles.push_back(tri);
+}
+
+void OcclusionCuller::rasterize()
+{
+  if(m_triangles.empty())
+    return;
+  TRACE_SCOPE("OcclusionCuller::rasterize");
+
+  // Each job owns a band of tile rows: no synchronization is needed on the tiles
+  const uint32_t numBands    = std::max(1U, m_numThreads);
+  const uint32_t rowsPerBand = (m_tilesY + numBands - 1) / numBands;
+  JobSystem::getInstance().parallelFor(m_tilesY, rowsPerBand, [this](uint32_t rowBegin, uint32_t rowEnd) { rasterizeBand(rowBegin, rowEnd); });
+}
+
+void OcclusionCuller::rasterizeBand(uint32_t tileRowBegin, uint32_t tileRowEnd)
+{
+  TRACE_SCOPE("OcclusionCuller::rasterizeBand");
+  const int bandMinY = int(tileRowBegin * kTileHeight);
+  const int bandMaxY = int(tileRowEnd * kTileHeight) - 1;
+
+  for(const ScreenTriangle& tri : m_triangles)
+  {
+    const int minY = std::max(tri.minY, bandMinY);
+    const int maxY = std::min(tri.maxY, bandMaxY);
+    if(minY > maxY)
+      continue;
+
+    for(int tileY = minY / int(kTileHeight); tileY <= maxY / int(kTileHeight); tileY++)
+    {
+      for(int tileX = tri.minX / int(kTileWidth); tileX <= tri.maxX / int(kTileWidth); tileX++)
+      {
+        rasterizeTile(tri, m_tiles[size_t(tileY) * m_tilesX + tileX], tileX, tileY);
+      }
+    }
+  }
+}
+
+void OcclusionCuller::rasterizeTile(const ScreenTriangle& tri, Tile& tile, int tileX, int tileY) const
+{
+  const float baseX = float(tileX * int(kTileWidth)) + 0.5F;  // Pixel centers
+  const float baseY = float(tileY * int(kTileHeight)) + 0.5F;
+
+#if defined(OCCLUSION_USE_SSE2)
+  const __m128 offsets = _mm_setr_ps(0.0F, 1.0F, 2.0F, 3.0F);
+  const __m128 zero    = _mm_setzero_ps();
+  const __m128 one     = _mm_set1_ps(1.0F);
+  __m128       tileMax = zero;
+
+  for(uint32_t row = 0; row < kTileHeight; row++)
+  {
+    const __m128 py = _mm_set1_ps(baseY + float(row));
+    for(uint32_t col = 0; col < kTileWidth; col += 4)
+    {
+      const __m128 px = _mm_add_ps(_mm_set1_ps(baseX + float(col)), offsets);
+
+      // Coverage mask of the 4 pixels
+      __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      for(int e = 0; e < 3; e++)
+      {
+        const __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeA[e]), px),
+                                       _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edgeB[e]), py), _mm_set1_ps(tri.edgeC[e])));
+        mask              = _mm_and_ps(mask, _mm_cmpge_ps(edge, zero));
+      }
+
+      float* depthPtr = &tile.depth[row * kTileWidth + col];
+      __m128 depth    = _mm_loadu_ps(depthPtr);
+      const int bits  = _mm_movemask_ps(mask);
+      if(bits != 0)
+      {
+        __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.depthA), px),
+                              _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.depthB), py), _mm_set1_ps(tri.depthC)));
+        z        = _mm_min_ps(_mm_max_ps(z, zero), one);
+        depth    = _mm_or_ps(_mm_and_ps(mask, _mm_min_ps(depth, z)), _mm_andnot_ps(mask, depth));
+        _mm_storeu_ps(depthPtr, depth);
+        tile.coverage |= uint32_t(bits) << (row * kTileWidth + col);
+      }
+      tileMax = _mm_max_ps(tileMax, depth);
+    }
+  }
+  tileMax = _mm_max_ps(tileMax, _mm_shuffle_ps(tileMax, tileMax, _MM_SHUFFLE(1, 0, 3, 2)));
+  tileMax = _mm_max_ps(tileMax, _mm_shuffle_ps(tileMax, tileMax, _MM_SHUFFLE(2, 3, 0, 1)));
+  tile.maxDepth = _mm_cvtss_f32(tileMax);
+#else
+  float tileMax = 0.0F;
+  for(uint32_t row = 0; row < kTileHeight; row++)
+  {
+    const float py = baseY + float(row);
+    for(uint32_t col = 0; col < kTileWidth; col++)
+    {
+      const float px     = baseX + float(col);
+      bool        inside = true;
+      for(int e = 0; e < 3; e++)
+        inside &= tri.edgeA[e] * px + tri.edgeB[e] * py + tri.edgeC[e] >= 0.0F;
+
+      float& depth = tile.depth[row * kTileWidth + col];
+      if(inside)
+      {
+        const float z = std::clamp(tri.depthA * px + tri.depthB * py + tri.depthC, 0.0F, 1.0F);
+        depth         = std::min(depth, z);
+        tile.coverage |= 1U << (row * kTileWidth + col);
+      }
+      tileMax = std::max(tileMax, depth);
+    }
+  }
+  tile.maxDepth = tileMax;
+#endif
+}
+
+bool OcclusionCuller::isVisible(const glm::vec3& bboxMin, const glm::vec3& bboxMax, const glm::mat4& transform) const
+{
+  const glm::mat4 mvp = m_viewProj * transform;
+
+  glm::vec3 screenMin(1e30F);
+  glm::vec3 screenMax(-1e30F);
+  for(int corner = 0; corner < 8; corner++)
+  {
+    const glm::vec3 p((corner & 1) ? bboxMax.x : bboxMin.x, (corner & 2) ? bboxMax.y : bboxMin.y,
+                      (corner & 4) ? bboxMax.z : bboxMin.z);
+    const glm::vec4 clip = mvp * glm::vec4(p, 1.0F);
+    if(clip.z < 0.0F || clip.w <= 1e-7F)
+      return true;  // Crossing the near plane: consider visible
+    const glm::vec3 screen((clip.x / clip.w * 0.5F + 0.5F) * float(m_width),
+                           (clip.y / clip.w * 0.5F + 0.5F) * float(m_height), clip.z / clip.w);
+    screenMin = glm::min(screenMin, screen);
+    screenMax = glm::max(screenMax, screen);
+  }
+
+  // Outside of the view frustum
+  if(screenMax.x < 0.0F || screenMax.y < 0.0F || screenMin.x > float(m_width) || screenMin.y > float(m_height) || screenMin.z > 1.0F)
+    return false;
+
+  if(m_tiles.empty())
+    return true;
+
+  const int   minX    = std::max(0, int(std::floor(screenMin.x)));
+  const int   minY    = std::max(0, int(std::floor(screenMin.y)));
+  const int   maxX    = std::min(int(m_width) - 1, int(std::ceil(screenMax.x)));
+  const int   maxY    = std::min(int(m_height) - 1, int(std::ceil(screenMax.y)));
+  const float nearest = screenMin.z;
+
+  for(int tileY = minY / int(kTileHeight); tileY <= maxY / int(kTileHeight); tileY++)
+  {
+    for(int tileX = minX / int(kTileWidth); tileX <= maxX / int(kTileWidth); tileX++)
+    {
+      const Tile& tile = m_tiles[size_t(tileY) * m_tilesX + tileX];
+      if(tile.maxDepth < nearest)
+        continue;  // Every pixel of the tile is in front of the box
+      if(tile.coverage == 0)
+        return true;  // No occluder in this tile
+      // Per pixel test of the part of the tile overlapped by the box
+      const int y0 = std::max(minY, tileY * int(kTileHeight));
+      const int y1 = std::min(maxY, (tileY + 1) * int(kTileHeight) - 1);
+      const int x0 = std::max(minX, tileX * int(kTileWidth));
+      const int x1 = std::min(maxX, (tileX + 1) * int(kTileWidth) - 1);
+      for(int y = y0; y <= y1; y++)
+        for(int x = x0; x <= x1; x++)
+          if(tile.depth[(y % kTileHeight) * kTileWidth + (x % kTileWidth)] >= nearest)
+            return true;
+    }
+  }
+  return false;
+}
+
+float OcclusionCuller::getDepth(uint32_t x, uint32_t y) const
+{
+  if(x >= m_width || y >= m_height)
+    return 1.0F;
+  const Tile& tile = m_tiles[size_t(y / kTileHeight) * m_tilesX + x / kTileWidth];
+  return tile.depth[(y % kTileHeight) * kTileWidth + (x % kTileWidth)];
+}
+
+std::vector<uint32_t> selectOccluderMeshes(std::span<const OccluderCandidate> candidates,
+                                           const glm::vec3&                   sceneMin,
+                                           const glm::vec3&                   sceneMax,
+                                           float                              minSizeRatio /*= 0.05F*/,
+                                           uint32_t                           maxMeshTriangles /*= 4096*/,
+                                           uint32_t                           triangleBudget /*= 16384*/)
+{
+  // Area of the largest face of a box: what it can hide from the best point of view
+  const auto largestFace = [](const glm::vec3& bboxMin, const glm::vec3& bboxMax) {
+    const glm::vec3 extent = glm::max(bboxMax - bboxMin, glm::vec3(0.0F));
+    return std::max(extent.x * extent.y, std::max(extent.y * extent.z, extent.z * extent.x));
+  };
+  const float minSize = largestFace(sceneMin, sceneMax) * minSizeRatio;
+
+  std::vector<uint32_t> order;
+  std::vector<float>    sizes(candidates.size());
+  for(uint32_t i = 0; i < uint32_t(candidates.size()); i++)
+  {
+    const OccluderCandidate& candidate = candidates[i];
+    sizes[i]                           = largestFace(candidate.bboxMin, candidate.bboxMax);
+    if(candidate.triangleCount > 0 && candidate.instanceCount > 0 && candidate.triangleCount <= maxMeshTriangles && sizes[i] > 0.0F
+       && sizes[i] >= minSize)
+      order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sizes[a] > sizes[b]; });
+
+  std::vector<uint32_t> selected;
+  uint64_t              triangles = 0;
+  for(uint32_t i : order)
+  {
+    const uint64_t cost = uint64_t(candidates[i].triangleCount) * candidates[i].instanceCount;
+    if(triangles + cost > triangleBudget)
+      continue;  // A smaller candidate may still fit
+    triangles += cost;
+    selected.push_back(i);
+  }
+  return selected;
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace nvsamples {
+
+// Geometry of an occluder, kept on the CPU (object space positions and a triangle list)
+struct OccluderMesh
+{
+  std::vector<glm::vec3> positions;  // Object space positions
+  std::vector<uint32_t>  indices;    // Triangle list, 3 indices per triangle
+};
+
+// Mesh proposed as an occluder: world space bounds of its largest instance, and its rasterization cost
+struct OccluderCandidate
+{
+  glm::vec3 bboxMin{0.0F};     // World space bounds of the largest instance of the mesh
+  glm::vec3 bboxMax{0.0F};     //
+  uint32_t  triangleCount{};  // Triangles of the mesh
+  uint32_t  instanceCount{};  // Instances of the mesh, all of them are rasterized when the mesh is an occluder
+};
+
+// Select the meshes rasterized as occluders, returns their index in `candidates`.
+// Good occluders are large and simple: the candidates are ranked by the largest face of their bounds. The ones
+// smaller than `minSizeRatio` of the largest face of the scene bounds, or with more than `maxMeshTriangles`
+// triangles, are skipped, and the selection stops at `triangleBudget` rasterized triangles (triangles x instances).
+std::vector<uint32_t> selectOccluderMeshes(std::span<const OccluderCandidate> candidates,
+                                           const glm::vec3&                   sceneMin,
+                                           const glm::vec3&                   sceneMax,
+                                           float                              minSizeRatio     = 0.05F,
+                                           uint32_t                           maxMeshTriangles = 4096,
+                                           uint32_t                           triangleBudget   = 16384);
+
+//--------------------------------------------------------------------------------------------------
+// CPU software occlusion culler
+//
+// Occluder triangles are rasterized into a low resolution masked depth buffer. The buffer is split
+// in tiles of 8x4 pixels; each tile stores the depth of its pixels, a coverage mask (one bit per
+// pixel touched by an occluder) and the farthest depth of the tile, used to reject or accept whole
+// tiles when testing bounding boxes. Four pixels are processed at once with SSE2 (with a scalar
+// fallback), and the rasterization is split in horizontal bands rasterized by parallel jobs (JobSystem).
+//
+// Usage per frame:
+//   beginFrame(viewProj);
+//   addOccluder(...);           // for each occluder instance
+//   rasterize();
+//   isVisible(bboxMin, bboxMax, transform);  // for each instance to test
+//
+// Depth follows the Vulkan convention: 0 is the near plane and 1 the far plane.
+class OcclusionCuller
+{
+public:
+  static constexpr uint32_t kTileWidth  = 8;
+  static constexpr uint32_t kTileHeight = 4;
+
+  // Resolution of the depth buffer (rounded up to a multiple of the tile size), 0 threads means automatic
+  void init(uint32_t width, uint32_t height, uint32_t numThreads = 0);
+
+  // Clear the depth buffer and the queued occluders
+  void beginFrame(const glm::mat4& viewProjMatrix);
+
+  // Transform, clip and queue the triangles of an occluder for rasterization
+  void addOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices, const glm::mat4& transform);
+
+  // Rasterize all queued occluder triangles into the depth buffer
+  void rasterize();
+
+  // Return false if the transformed bounding box is entirely hidden behind the occluders or outside of the view
+  bool isVisible(const glm::vec3& bboxMin, const glm::vec3& bboxMax, const glm::mat4& transform) const;
+
+  uint32_t getWidth() const { return m_width; }
+  uint32_t getHeight() const { return m_height; }
+  uint32_t getOccluderTriangleCount() const { return uint32_t(m_triangles.size()); }
+
+  // Depth of a pixel, for debugging and visualization
+  float getDepth(uint32_t x, uint32_t y) const;
+
+private:
+  // Screen space triangle ready for rasterization
+  struct ScreenTriangle
+  {
+    float edgeA[3], edgeB[3], edgeC[3];  // Edge functions: E(x,y) = A*x + B*y + C, inside when all >= 0
+    float depthA, depthB, depthC;        // Depth plane: z(x,y) = A*x + B*y + C
+    int   minX, minY, maxX, maxY;        // Pixel bounding box (inclusive)
+  };
+
+  struct Tile
+  {
+    float    depth[kTileWidth * kTileHeight];  // Row major depth of the tile pixels
+    float    maxDepth;                         // Farthest depth of the tile
+    uint32_t coverage;                         // Bit set for each pixel covered by an occluder
+  };
+
+  void setupTriangle(const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2);
+  void rasterizeBand(uint32_t tileRowBegin, uint32_t tileRowEnd);
+  void rasterizeTile(const ScreenTriangle& tri, Tile& tile, int tileX, int tileY) const;
+
+  uint32_t          m_width{};
+  uint32_t          m_height{};
+  uint32_t          m_tilesX{};
+  uint32_t          m_tilesY{};
+  uint32_t          m_numThreads{1};
+  glm::mat4         m_viewProj{1};
+  std::vector<Tile> m_tiles;
+
+  std::vector<ScreenTriangle> m_triangles;
+  std::vector<glm::vec4>      m_clipPositions;  // Scratch of addOccluder(), kept to not allocate per occluder
+};
+
+}  // namespace nvsamples
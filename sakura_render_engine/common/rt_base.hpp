@@ -26,6 +26,7 @@
 //
 
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui/imgui.h>
 #include <imgui/backends/imgui_impl_vulkan.h>
@@ -543,9 +544,11 @@ public:
     const auto                   triangleCount = static_cast<uint32_t>(triMesh.indices.count / 3U);
 
     // Describe buffer as array of VertexObj.
+    // Quantized positions are built as is, the dequantization is folded in the instance transform (createTopLevelAS)
+    const VkFormat vertexFormat = triMesh.positions.format == shaderio::eVertexSnorm16 ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32_SFLOAT;
     VkAccelerationStructureGeometryTrianglesDataKHR triangles{
         .sType        = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
-        .vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,  // vec3 vertex position data
+        .vertexFormat = vertexFormat,  // vec3 vertex position data
         .vertexData   = {.deviceAddress = VkDeviceAddress(gltfMesh.gltfBuffer) + triMesh.positions.offset},
         .vertexStride = triMesh.positions.byteStride,
         .maxVertex    = triMesh.positions.count - 1,
@@ -596,15 +599,23 @@ public:
     tlasInstances.reserve(m_sceneResource.instances.size());
     const VkGeometryInstanceFlagsKHR flags{VK_GEOMETRY_INSTANCE_TRIANGLE_CULL_DISABLE_BIT_NV};
 
-    for(const shaderio::GltfInstance& instance : m_sceneResource.instances)
+    const nvsamples::InstanceStore& instances = m_sceneResource.instances;
+    for(uint32_t i = 0; i < instances.size(); i++)
     {
+      // Quantized positions: p = offset + q * scale
+      const uint32_t            meshIndex = instances.getMeshIndex(i);
+      glm::mat4                 transform = instances.getTransform(i);
+      const shaderio::GltfMesh& mesh      = m_sceneResource.meshes[meshIndex];
+      if(mesh.triMesh.positions.format == shaderio::eVertexSnorm16)
+        transform = transform * glm::translate(glm::mat4(1), mesh.positionOffset) * glm::scale(glm::mat4(1), mesh.positionScale);
+
       VkAccelerationStructureInstanceKHR ray_inst{};
-      ray_inst.transform           = nvvk::toTransformMatrixKHR(instance.transform);  // Position of the instance
-      ray_inst.instanceCustomIndex = instance.meshIndex;                              // gl_InstanceCustomIndexEXT
-      ray_inst.accelerationStructureReference         = m_asBuilder.blasSet[instance.meshIndex].address;
+      ray_inst.transform           = nvvk::toTransformMatrixKHR(transform);  // Position of the instance
+      ray_inst.instanceCustomIndex = meshIndex;                              // gl_InstanceCustomIndexEXT
+      ray_inst.accelerationStructureReference         = m_asBuilder.blasSet[meshIndex].address;
       ray_inst.instanceShaderBindingTableRecordOffset = 0;  // We will use the same hit group for all objects
       ray_inst.flags                                  = flags;
-      ray_inst.mask                                   = 0xFF;
+      ray_inst.mask                                   = (instances.getFlags(i) & nvsamples::eInstanceHidden) ? 0 : 0xFF;
       tlasInstances.emplace_back(ray_inst);
     }
 
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "shader_binary_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#include "nvutils/logger.hpp"
+
+namespace nvsamples {
+
+namespace {
+
+constexpr uint32_t kFileMagic   = 0x43424f53;  // "SOBC"
+constexpr uint32_t kFileVersion = 1;
+
+struct FileHeader
+{
+  uint32_t magic   = kFileMagic;
+  uint32_t version = kFileVersion;
+  uint8_t  shaderBinaryUUID[VK_UUID_SIZE]{};
+  uint32_t shaderBinaryVersion = 0;
+  uint32_t entryCount          = 0;
+};
+
+struct EntryHeader
+{
+  uint64_t key  = 0;
+  uint64_t size = 0;  // Bytes of binary following the header
+};
+
+// The binaries are passed to the driver from their std::vector storage, VK_SHADER_CODE_TYPE_BINARY_EXT code
+// must be 16-byte aligned
+static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= 16);
+
+// FNV-1a, 64 bits
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for(size_t i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+template <typename T>
+uint64_t hashValue(uint64_t hash, const T& value)
+{
+  return hashBytes(hash, &value, sizeof(value));
+}
+
+}  // namespace
+
+void ShaderBinaryCache::init(VkPhysicalDevice physicalDevice, const std::filesystem::path& filename)
+{
+  VkPhysicalDeviceShaderObjectPropertiesEXT shaderObjectProperties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_PROPERTIES_EXT};
+  VkPhysicalDeviceProperties2 properties{VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+  properties.pNext = &shaderObjectProperties;
+  vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::memcpy(m_shaderBinaryUUID, shaderObjectProperties.shaderBinaryUUID, VK_UUID_SIZE);
+  m_shaderBinaryVersion = shaderObjectProperties.shaderBinaryVersion;
+  m_filename            = filename;
+  m_entries.clear();
+  m_modified = false;
+  load();
+}
+
+void ShaderBinaryCache::deinit()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_filename.clear();
+}
+
+size_t ShaderBinaryCache::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_entries.size();
+}
+
+uint64_t ShaderBinaryCache::computeKey(const VkShaderCreateInfoEXT& createInfo, uint64_t codeHash)
+{
+  uint64_t hash = hashValue(codeHash, createInfo.flags);
+  hash          = hashValue(hash, createInfo.stage);
+  hash          = hashValue(hash, createInfo.nextStage);
+  hash          = hashValue(hash, createInfo.codeType);
+  if(createInfo.pName != nullptr)
+    hash = hashBytes(hash, createInfo.pName, std::strlen(createInfo.pName) + 1);
+  hash = hashValue(hash, createInfo.setLayoutCount);
+  for(uint32_t i = 0; i < createInfo.pushConstantRangeCount; i++)
+  {
+    const VkPushConstantRange& range = createInfo.pPushConstantRanges[i];
+    hash = hashValue(hash, range.stageFlags);
+    hash = hashValue(hash, range.offset);
+    hash = hashValue(hash, range.size);
+  }
+  if(const VkSpecializationInfo* specialization = createInfo.pSpecializationInfo)
+  {
+    for(uint32_t i = 0; i < specialization->mapEntryCount; i++)
+    {
+      const VkSpecializationMapEntry& entry = specialization->pMapEntries[i];
+      hash = hashValue(hash, entry.constantID);
+      hash = hashValue(hash, entry.offset);
+      hash = hashValue(hash, uint64_t(entry.size));
+    }
+    hash = hashBytes(hash, specialization->pData, specialization->dataSize);
+  }
+  return hash;
+}
+
+VkResult ShaderBinaryCache::createShaders(VkDevice device, std::span<const VkShaderCreateInfoEXT> createInfos, std::span<VkShaderEXT> shaders)
+{
+  std::fill(shaders.begin(), shaders.end(), VkShaderEXT(VK_NULL_HANDLE));
+
+  // Keys of the create infos, the code shared by consecutive permutations is hashed once
+  std::vector<uint64_t> keys(createInfos.size());
+  const void*           hashedCode = nullptr;
+  size_t                hashedSize = 0;
+  uint64_t              codeHash   = 0;
+  for(size_t i = 0; i < createInfos.size(); i++)
+  {
+    const VkShaderCreateInfoEXT& createInfo = createInfos[i];
+    if(createInfo.pCode != hashedCode || createInfo.codeSize != hashedSize)
+    {
+      hashedCode = createInfo.pCode;
+      hashedSize = createInfo.codeSize;
+      codeHash   = hashBytes(kHashSeed, createInfo.pCode, createInfo.codeSize);
+    }
+    keys[i] = computeKey(createInfo, codeHash);
+  }
+
+  // Binaries of the cached shaders, kept alive by their shared pointer while the driver reads them
+  std::vector<Binary> binaries(createInfos.size());
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(size_t i = 0; i < createInfos.size(); i++)
+    {
+      auto it = m_entries.find(keys[i]);
+      if(it != m_entries.end())
+      {
+        it->second.used = true;
+        binaries[i]     = it->second.binary;
+      }
+    }
+  }
+
+  std::vector<VkShaderCreateInfoEXT> batch;
+  std::vector<size_t>                batchIndices;  // Index of each create info of the batch in createInfos
+  std::vector<VkShaderEXT>           created;
+  for(size_t i = 0; i < createInfos.size(); i++)
+  {
+    if(binaries[i] == nullptr)
+      continue;
+    VkShaderCreateInfoEXT createInfo = createInfos[i];
+    createInfo.codeType              = VK_SHADER_CODE_TYPE_BINARY_EXT;
+    createInfo.codeSize              = binaries[i]->size();
+    createInfo.pCode                 = binaries[i]->data();
+    batch.push_back(createInfo);
+    batchIndices.push_back(i);
+  }
+  size_t binaryCount = 0;
+  if(!batch.empty())
+  {
+    created.assign(batch.size(), VK_NULL_HANDLE);
+    const VkResult result = vkCreateShadersEXT(device, uint32_t(batch.size()), batch.data(), nullptr, created.data());
+    if(result == VK_INCOMPATIBLE_SHADER_BINARY_EXT)
+      LOGW("Shader binary cache: binaries rejected by the driver, created from SPIR-V\n");
+    for(size_t j = 0; j < batch.size(); j++)
+    {
+      shaders[batchIndices[j]] = created[j];
+      binaryCount += created[j] != VK_NULL_HANDLE ? 1 : 0;
+    }
+    LOGI("Shader binary cache: %zu of %zu shaders created from binaries\n", binaryCount, createInfos.size());
+  }
+
+  // The other shaders from SPIR-V, their binaries are added to the cache
+  batch.clear();
+  batchIndices.clear();
+  for(size_t i = 0; i < createInfos.size(); i++)
+  {
+    if(shaders[i] == VK_NULL_HANDLE)
+    {
+      batch.push_back(createInfos[i]);
+      batchIndices.push_back(i);
+    }
+  }
+  if(batch.empty())
+    return VK_SUCCESS;
+
+  created.assign(batch.size(), VK_NULL_HANDLE);
+  const VkResult result = vkCreateShadersEXT(device, uint32_t(batch.size()), batch.data(), nullptr, created.data());
+
+  std::vector<std::pair<uint64_t, Binary>> added;
+  for(size_t j = 0; j < batch.size(); j++)
+  {
+    shaders[batchIndices[j]] = created[j];
+    if(created[j] == VK_NULL_HANDLE)
+      continue;
+    size_t dataSize = 0;
+    if(vkGetShaderBinaryDataEXT(device, created[j], &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+      continue;
+    auto data = std::make_shared<std::vector<uint8_t>>(dataSize);
+    if(vkGetShaderBinaryDataEXT(device, created[j], &dataSize, data->data()) != VK_SUCCESS)
+      continue;
+    added.emplace_back(keys[batchIndices[j]], std::move(data));
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for(auto& [key, binary] : added)
+    m_entries[key] = {.binary = std::move(binary), .used = true};
+  m_modified |= !added.empty();
+  return result;
+}
+
+bool ShaderBinaryCache::load()
+{
+  std::error_code ec;
+  uint64_t        remaining = std::filesystem::file_size(m_filename, ec);
+  std::ifstream   file(m_filename, std::ios::binary);
+  if(ec || !file)
+    return false;
+
+  FileHeader header{};
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!file || header.magic != kFileMagic || header.version != kFileVersion)
+    return false;
+  if(std::memcmp(header.shaderBinaryUUID, m_shaderBinaryUUID, VK_UUID_SIZE) != 0 || header.shaderBinaryVersion != m_shaderBinaryVersion)
+  {
+    LOGI("Shader binary cache: written by another driver, the shaders are created from SPIR-V\n");
+    return false;
+  }
+  remaining -= sizeof(header);
+
+  for(uint32_t i = 0; i < header.entryCount; i++)
+  {
+    EntryHeader entry{};
+    file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+    if(!file)
+      break;
+    remaining -= sizeof(entry);
+    if(entry.size == 0 || entry.size > remaining)
+      break;  // Truncated file
+    remaining -= entry.size;
+
+    auto data = std::make_shared<std::vector<uint8_t>>(entry.size);
+    file.read(reinterpret_cast<char*>(data->data()), std::streamsize(entry.size));
+    if(!file)
+      break;
+    m_entries[entry.key] = {.binary = std::move(data)};
+  }
+  return true;
+}
+
+bool ShaderBinaryCache::save()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if(!m_modified || m_filename.empty())
+    return true;
+
+  std::error_code ec;
+  std::filesystem::create_directories(m_filename.parent_path(), ec);
+
+  FileHeader header{.shaderBinaryVersion = m_shaderBinaryVersion};
+  std::memcpy(header.shaderBinaryUUID, m_shaderBinaryUUID, VK_UUID_SIZE);
+  for(const auto& [key, entry] : m_entries)
+    header.entryCount += entry.used ? 1 : 0;
+
+  std::filesystem::path tempPath = m_filename;
+  tempPath += ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if(!file)
+    {
+      LOGW("Shader binary cache: cannot write %s\n", tempPath.string().c_str());
+      return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(const auto& [key, entry] : m_entries)
+    {
+      if(!entry.used)
+        continue;
+      const EntryHeader entryHeader{.key = key, .size = entry.binary->size()};
+      file.write(reinterpret_cast<const char*>(&entryHeader), sizeof(entryHeader));
+      file.write(reinterpret_cast<const char*>(entry.binary->data()), std::streamsize(entry.binary->size()));
+    }
+    if(!file)
+      return false;
+  }
+  std::filesystem::rename(tempPath, m_filename, ec);
+  if(ec)
+    return false;
+  m_modified = false;
+  return true;
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan_core.h>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// On-disk cache of the shader object binaries
+//
+// vkCreateShadersEXT compiles the SPIR-V to the instruction set of the GPU on every run. The binaries of
+// the created shaders (vkGetShaderBinaryDataEXT) are saved, the next runs create the shaders from them
+// (VK_SHADER_CODE_TYPE_BINARY_EXT) and skip that compilation.
+//
+// A binary is only valid for the driver that produced it: the file records the shaderBinaryUUID and
+// shaderBinaryVersion of the device (VkPhysicalDeviceShaderObjectPropertiesEXT) and is ignored when they
+// differ. A binary the driver still rejects (VK_INCOMPATIBLE_SHADER_BINARY_EXT) is created from SPIR-V.
+//
+// The entries are keyed by the create info: code, stages, entry point, specialization and push constant
+// ranges. The descriptor set layouts are not part of the key, a cache file is used with the same layouts.
+// save() writes the entries used since init(): the ones of replaced shaders are dropped.
+//
+// createShaders() may be called from several threads.
+//
+//   cache.init(physicalDevice, device, filename);
+//   cache.createShaders(device, createInfos, shaders);  // From the binaries when cached, from SPIR-V otherwise
+//   ...
+//   cache.save();
+class ShaderBinaryCache
+{
+public:
+  // Load the binaries of the file, when they were written by the driver of the device
+  void init(VkPhysicalDevice physicalDevice, const std::filesystem::path& filename);
+  void deinit();  // Does not save
+
+  // Create the shaders of the SPIR-V create infos: the cached ones from their binaries, then the others in a single
+  // vkCreateShadersEXT call (on failure, the shaders of that call from the first one failing are VK_NULL_HANDLE:
+  // put the optional shaders last). The binaries of the shaders created from SPIR-V are added.
+  VkResult createShaders(VkDevice device, std::span<const VkShaderCreateInfoEXT> createInfos, std::span<VkShaderEXT> shaders);
+
+  // Write the used entries to the file, when some were added
+  bool save();
+
+  size_t size() const;
+
+private:
+  using Binary = std::shared_ptr<const std::vector<uint8_t>>;
+  struct Entry
+  {
+    Binary binary;
+    bool   used = false;  // Looked up or added since init()
+  };
+
+  static uint64_t computeKey(const VkShaderCreateInfoEXT& createInfo, uint64_t codeHash);
+  bool            load();
+
+  std::filesystem::path               m_filename;
+  uint8_t                             m_shaderBinaryUUID[VK_UUID_SIZE]{};
+  uint32_t                            m_shaderBinaryVersion = 0;
+  std::unordered_map<uint64_t, Entry> m_entries;
+  bool                                m_modified = false;  // Entries added since the file was read
+  mutable std::mutex                  m_mutex;
+};
+
+}  // namespace nvsamples
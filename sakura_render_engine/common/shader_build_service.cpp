@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "shader_build_service.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#include "nvslang/slang.hpp"
+#include "nvutils/logger.hpp"
+#include "nvutils/timers.hpp"
+
+#include "trace_recorder.hpp"
+
+namespace nvsamples {
+
+namespace {
+
+// Files read by the last compilation as reported by Slang: the source, then its imports and includes.
+// Empty when unknown.
+std::vector<std::filesystem::path> getCompiledFiles(const nvslang::SlangCompiler& compiler, const std::filesystem::path& source)
+{
+  slang::IModule* module = compiler.getSlangModule();
+  if(module == nullptr)
+    return {};
+
+  std::vector<std::filesystem::path> files{source};
+  for(int32_t i = 0; i < module->getDependencyFileCount(); i++)
+  {
+    std::error_code             ec;
+    const std::filesystem::path file = module->getDependencyFilePath(i);
+    if(!std::filesystem::equivalent(file, source, ec) && std::find(files.begin(), files.end(), file) == files.end())
+      files.push_back(file);
+  }
+  return files;
+}
+
+}  // namespace
+
+ShaderBuildService::ShaderBuildService()  = default;
+ShaderBuildService::~ShaderBuildService() = default;
+
+void ShaderBuildService::init(InitInfo info)
+{
+  m_info = std::move(info);
+}
+
+void ShaderBuildService::deinit()
+{
+  std::lock_guard<std::mutex> lock(m_buildMutex);
+  m_compiler.reset();
+}
+
+std::filesystem::path ShaderBuildService::getDepFile(const ShaderPermutation& permutation) const
+{
+  return m_info.depDirectory / (permutation.source.filename().string() + ".dep");
+}
+
+std::string ShaderBuildService::getOptions(const ShaderPermutation& permutation) const
+{
+  // The defines are part of the options
+  std::string options = m_info.optionsKey;
+  for(const auto& define : permutation.defines)
+    options += ";-D" + define.first + "=" + define.second;
+  return options;
+}
+
+uint64_t ShaderBuildService::getCacheKey(const ShaderPermutation& permutation) const
+{
+  if(m_info.cache == nullptr)
+    return 0;
+
+  // The files of the stored entry: when one changed, the key differs and the compilation stores the new list
+  const std::vector<std::filesystem::path> files = m_info.cache->getStoredDependencies(permutation.name);
+  return files.empty() ? 0 : m_info.cache->computeKey(files, getOptions(permutation));
+}
+
+bool ShaderBuildService::loadCached(const ShaderPermutation& permutation, std::vector<uint32_t>& spirv) const
+{
+  const uint64_t key = getCacheKey(permutation);
+  return key != 0 && m_info.cache->load(permutation.name, key, spirv);
+}
+
+std::vector<std::filesystem::path> ShaderBuildService::getDependencies(std::span<const ShaderPermutation> permutations) const
+{
+  std::vector<std::filesystem::path> files;
+  for(const ShaderPermutation& permutation : permutations)
+  {
+    if(m_info.cache == nullptr)
+    {
+      files.push_back(permutation.source);
+      continue;
+    }
+    std::vector<std::filesystem::path> permutationFiles = m_info.cache->getStoredDependencies(permutation.name);
+    if(permutationFiles.empty())
+      permutationFiles = m_info.cache->getDependencies(permutation.source, getDepFile(permutation));
+    for(std::filesystem::path& file : permutationFiles)
+    {
+      if(std::find(files.begin(), files.end(), file) == files.end())
+        files.push_back(std::move(file));
+    }
+  }
+  return files;
+}
+
+std::vector<uint32_t> ShaderBuildService::compile(nvslang::SlangCompiler& compiler, const ShaderPermutation& permutation) const
+{
+  std::vector<uint32_t> spirv;
+  const uint64_t        key = getCacheKey(permutation);
+  if(key != 0 && m_info.cache->load(permutation.name, key, spirv))
+    return spirv;
+
+  TRACE_SCOPE("ShaderBuildService::compile");
+  nvutils::PerformanceTimer timer;
+
+  // The strings of the macros outlive the compilation
+  compiler.clearMacros();
+  for(const auto& define : permutation.defines)
+    compiler.addMacro({define.first.c_str(), define.second.c_str()});
+
+  if(compiler.compileFile(permutation.source))
+  {
+    spirv.assign(compiler.getSpirv(), compiler.getSpirv() + compiler.getSpirvSize() / sizeof(uint32_t));
+    if(m_info.cache != nullptr)
+    {
+      const std::vector<std::filesystem::path> files = getCompiledFiles(compiler, permutation.source);
+      if(!files.empty())
+        m_info.cache->store(permutation.name, m_info.cache->computeKey(files, getOptions(permutation)), spirv, files);
+    }
+    LOGI("Compiled %s in %.1f ms\n", permutation.name.c_str(), timer.getMilliseconds());
+  }
+  else
+  {
+    LOGE("Error compiling shaders: %s\n%s\n", permutation.name.c_str(), compiler.getLastDiagnosticMessage().c_str());
+  }
+  return spirv;
+}
+
+std::vector<std::vector<uint32_t>> ShaderBuildService::build(std::span<const ShaderPermutation> permutations)
+{
+  std::lock_guard<std::mutex> lock(m_buildMutex);
+
+  std::vector<std::vector<uint32_t>> results(permutations.size());
+  if(permutations.empty())
+    return results;
+
+  // The setup may take time but it is done once
+  if(!m_compiler)
+  {
+    m_compiler = std::make_unique<nvslang::SlangCompiler>();
+    if(m_info.compilerSetup)
+      m_info.compilerSetup(*m_compiler);
+  }
+
+  for(size_t i = 0; i < permutations.size(); i++)
+    results[i] = compile(*m_compiler, permutations[i]);
+  return results;
+}
+
+}  // namespace nvsamples
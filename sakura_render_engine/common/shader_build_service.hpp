@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "shader_cache.hpp"
+
+namespace nvslang {
+class SlangCompiler;
+}
+
+namespace nvsamples {
+
+// One variant of a shader: the source compiled with a set of preprocessor macros
+struct ShaderPermutation
+{
+  std::string                                      name;     // Unique, names the cache entry, e.g. "foundation.slang"
+  std::filesystem::path                            source;   // Full path of the source
+  std::vector<std::pair<std::string, std::string>> defines;  // Preprocessor macros (name, value) of the permutation
+};
+
+//--------------------------------------------------------------------------------------------------
+// Compilation of shader permutations
+//
+// build() returns the SPIR-V of the permutations: from the shader cache when their source, includes, defines
+// and options did not change, otherwise compiled one after the other by a single nvslang::SlangCompiler,
+// created on first use with the setup function and kept for the next builds.
+//
+// build() blocks, it is called from a background thread. It does not run as a job of the JobSystem: a
+// compilation takes long, a thread waiting for the jobs of a frame would run it and stall the frame.
+class ShaderBuildService
+{
+public:
+  // Configure the compiler: search paths, target, options
+  using CompilerSetup = std::function<void(nvslang::SlangCompiler& compiler)>;
+
+  struct InitInfo
+  {
+    CompilerSetup         compilerSetup;
+    std::string           optionsKey;     // Description of the options set by compilerSetup, part of the cache keys
+    ShaderCache*          cache = nullptr;
+    std::filesystem::path depDirectory;  // Where the build writes <source name>.dep (_autogen)
+  };
+
+  ShaderBuildService();
+  ~ShaderBuildService();
+
+  void init(InitInfo info);
+  void deinit();
+
+  // SPIR-V of each permutation, in order. Empty for the permutations failing to compile (errors are logged).
+  std::vector<std::vector<uint32_t>> build(std::span<const ShaderPermutation> permutations);
+
+  // SPIR-V of the permutation from the cache only, false when it must be compiled
+  bool loadCached(const ShaderPermutation& permutation, std::vector<uint32_t>& spirv) const;
+
+  // Files the permutations depend on: the sources and their includes, e.g. to watch for modifications. Those
+  // reported by Slang for the last compilation, the ones of the build (.dep files) before the first.
+  std::vector<std::filesystem::path> getDependencies(std::span<const ShaderPermutation> permutations) const;
+
+private:
+  std::string           getOptions(const ShaderPermutation& permutation) const;
+  uint64_t              getCacheKey(const ShaderPermutation& permutation) const;
+  std::filesystem::path getDepFile(const ShaderPermutation& permutation) const;
+  std::vector<uint32_t> compile(nvslang::SlangCompiler& compiler, const ShaderPermutation& permutation) const;
+
+  InitInfo                                m_info;
+  std::mutex                              m_buildMutex;  // One build at a time, the Slang session is not thread-safe
+  std::unique_ptr<nvslang::SlangCompiler> m_compiler;    // Created on first use
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "shader_cache.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include <fmt/format.h>
+
+#include "nvutils/logger.hpp"
+
+namespace nvsamples {
+
+namespace {
+
+constexpr uint32_t kEntryMagic   = 0x43565053;  // "SPVC"
+constexpr uint32_t kEntryVersion = 2;  // 2: keys of the dependencies reported by the compiler
+constexpr uint32_t kSpirvMagic   = 0x07230203;
+
+struct EntryHeader
+{
+  uint32_t magic    = kEntryMagic;
+  uint32_t version  = kEntryVersion;
+  uint64_t key      = 0;
+  uint64_t codeSize = 0;  // Bytes of SPIR-V following the header
+};
+
+// FNV-1a, 64 bits
+constexpr uint64_t kHashSeed = 0xcbf29ce484222325ULL;
+
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for(size_t i = 0; i < size; i++)
+  {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint64_t hashString(uint64_t hash, std::string_view str)
+{
+  hash = hashBytes(hash, str.data(), str.size());
+  return hashBytes(hash, "", 1);  // Separator, "ab"+"c" and "a"+"bc" differ
+}
+
+bool readFile(const std::filesystem::path& filename, std::string& content)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if(!file)
+    return false;
+  content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+// Write to a temporary file then rename it, a reader never sees a partial file
+bool writeFileAtomic(const std::filesystem::path& filename, std::span<const std::string_view> chunks)
+{
+  std::filesystem::path tempPath = filename;
+  tempPath += ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if(!file)
+    {
+      LOGW("Shader cache: cannot write %s\n", tempPath.string().c_str());
+      return false;
+    }
+    for(std::string_view chunk : chunks)
+      file.write(chunk.data(), std::streamsize(chunk.size()));
+    if(!file)
+      return false;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tempPath, filename, ec);
+  return !ec;
+}
+
+}  // namespace
+
+void ShaderCache::init(const std::filesystem::path& cacheDirectory, std::vector<std::filesystem::path> searchPaths)
+{
+  m_cacheDirectory = cacheDirectory;
+  m_searchPaths    = std::move(searchPaths);
+}
+
+std::vector<std::filesystem::path> ShaderCache::readDepFile(const std::filesystem::path& depFile)
+{
+  std::string content;
+  if(!readFile(depFile, content))
+    return {};
+
+  // Tokens separated by white spaces, '\' escapes the next character ("\ ", "\:", "\\") or the end of line.
+  // The target ends with the first unescaped ':'.
+  std::vector<std::filesystem::path> dependencies;
+  std::string                        token;
+  bool                               afterTarget = false;
+  auto                               endToken    = [&]() {
+    if(afterTarget && !token.empty())
+    {
+      std::replace(token.begin(), token.end(), '\\', '/');  // Separators of the build machine
+      dependencies.emplace_back(token);
+    }
+    token.clear();
+  };
+  for(size_t i = 0; i < content.size(); i++)
+  {
+    const char c = content[i];
+    if(c == '\\' && i + 1 < content.size())
+    {
+      const char next = content[++i];
+      if(next == '\r' || next == '\n')
+        endToken();  // Line continuation
+      else
+        token += next;
+    }
+    else if(c == ':' && !afterTarget)
+    {
+      token.clear();  // The target
+      afterTarget = true;
+    }
+    else if(c == ' ' || c == '\t' || c == '\r' || c == '\n')
+      endToken();
+    else
+      token += c;
+  }
+  endToken();
+  return dependencies;
+}
+
+std::filesystem::path ShaderCache::resolveDependency(const std::filesystem::path& dependency) const
+{
+  std::error_code ec;
+  if(std::filesystem::exists(dependency, ec))
+    return dependency;
+
+  // Path of another machine: try the last components, the longest first (e.g. nvshaders/functions.h.slang)
+  const std::vector<std::filesystem::path> components(dependency.begin(), dependency.end());
+  for(size_t count = std::min<size_t>(3, components.size()); count > 0; count--)
+  {
+    std::filesystem::path suffix;
+    for(size_t i = components.size() - count; i < components.size(); i++)
+      suffix /= components[i];
+    for(const std::filesystem::path& dir : m_searchPaths)
+    {
+      if(std::filesystem::exists(dir / suffix, ec))
+        return dir / suffix;
+    }
+  }
+  return {};
+}
+
+uint64_t ShaderCache::computeKey(std::span<const std::filesystem::path> files, std::string_view options) const
+{
+  uint64_t    hash = hashString(kHashSeed, options);
+  std::string content;
+  for(const std::filesystem::path& file : files)
+  {
+    if(readFile(file, content))
+      hash = hashString(hash, content);
+    else
+      hash = hashString(hash, file.string());  // Missing: part of the key by name
+  }
+  return hash == 0 ? 1 : hash;  // 0 means "no key"
+}
+
+std::vector<std::filesystem::path> ShaderCache::getStoredDependencies(std::string_view name) const
+{
+  std::string content;
+  if(!readFile(getDependencyListPath(name), content))
+    return {};
+
+  // One path per line
+  std::vector<std::filesystem::path> files;
+  size_t                             begin = 0;
+  while(begin < content.size())
+  {
+    size_t end = content.find('\n', begin);
+    end        = end == std::string::npos ? content.size() : end;
+    if(end > begin)
+      files.emplace_back(std::u8string(content.begin() + begin, content.begin() + end));
+    begin = end + 1;
+  }
+  return files;
+}
+
+std::vector<std::filesystem::path> ShaderCache::getDependencies(const std::filesystem::path& source, const std::filesystem::path& depFile) const
+{
+  std::vector<std::filesystem::path> files{source};
+  for(const std::filesystem::path& dependency : readDepFile(depFile))
+  {
+    std::error_code             ec;
+    const std::filesystem::path resolved = resolveDependency(dependency);
+    if(!resolved.empty() && !std::filesystem::equivalent(resolved, source, ec))
+      files.push_back(resolved);
+  }
+  return files;
+}
+
+std::filesystem::path ShaderCache::getEntryPath(std::string_view name, uint64_t key) const
+{
+  return m_cacheDirectory / fmt::format("{}.{:016x}.spv", name, key);
+}
+
+std::filesystem::path ShaderCache::getDependencyListPath(std::string_view name) const
+{
+  return m_cacheDirectory / fmt::format("{}.deps", name);
+}
+
+bool ShaderCache::load(std::string_view name, uint64_t key, std::vector<uint32_t>& spirv) const
+{
+  std::ifstream file(getEntryPath(name, key), std::ios::binary);
+  if(!file)
+    return false;
+
+  EntryHeader header{};
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!file || header.magic != kEntryMagic || header.version != kEntryVersion || header.key != key
+     || header.codeSize == 0 || header.codeSize % sizeof(uint32_t) != 0)
+    return false;
+
+  std::vector<uint32_t> code(header.codeSize / sizeof(uint32_t));
+  file.read(reinterpret_cast<char*>(code.data()), std::streamsize(header.codeSize));
+  if(!file || code[0] != kSpirvMagic)
+    return false;
+
+  spirv = std::move(code);
+  return true;
+}
+
+bool ShaderCache::store(std::string_view name, uint64_t key, std::span<const uint32_t> spirv, std::span<const std::filesystem::path> files) const
+{
+  if(key == 0 || spirv.empty() || files.empty())
+    return false;
+
+  std::error_code ec;
+  std::filesystem::create_directories(m_cacheDirectory, ec);
+
+  // Previous entries of the name, stale now: <name>.<16 hexadecimal digits>.spv
+  const std::string prefix = std::string(name) + ".";
+  for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_cacheDirectory, ec))
+  {
+    const std::string filename = entry.path().filename().string();
+    if(filename.size() == prefix.size() + 16 + 4 && filename.starts_with(prefix) && filename.ends_with(".spv"))
+      std::filesystem::remove(entry.path(), ec);
+  }
+
+  const EntryHeader      header{.key = key, .codeSize = spirv.size_bytes()};
+  const std::string_view entry[] = {{reinterpret_cast<const char*>(&header), sizeof(header)},
+                                    {reinterpret_cast<const char*>(spirv.data()), spirv.size_bytes()}};
+  if(!writeFileAtomic(getEntryPath(name, key), entry))
+    return false;
+
+  // The files of the entry, for the key of the next lookup
+  std::string list;
+  for(const std::filesystem::path& file : files)
+  {
+    const std::u8string path = file.u8string();
+    list.append(path.begin(), path.end());
+    list += '\n';
+  }
+  const std::string_view listChunks[] = {list};
+  return writeFileAtomic(getDependencyListPath(name), listChunks);
+}
+
+}  // namespace nvsamples
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// On-disk cache of compiled SPIR-V
+//
+// A compiled shader is stored under a key hashing the files it was compiled from (the source and its
+// transitive includes, as reported by the compiler) and the compiler options. The list of files is stored
+// with the entry: the key of the next lookup hashes the same files, an include added since then changes
+// the file including it, and the compilation that follows stores the new list.
+//
+// The files are <cacheDirectory>/<name>.<key>.spv and <name>.deps, written to a temporary file then renamed,
+// so a reader never sees a partial file. The name identifies the shader, e.g. the source file name and its
+// permutation: storing an entry removes the previous entries of the same name.
+//
+// The Makefile-style .dep file the build writes next to the pre-compiled shader (_autogen/<name>.dep) gives
+// the files to watch before the first compilation; its paths are those of the build machine, the ones not
+// found on disk are looked up in the shader search paths by their last path components.
+//
+//   const std::vector<std::filesystem::path> files = cache.getStoredDependencies(name);
+//   if(files.empty() || !cache.load(name, cache.computeKey(files, options), spirv))
+//   { ...compile...; cache.store(name, cache.computeKey(compiledFiles, options), spirv, compiledFiles); }
+class ShaderCache
+{
+public:
+  void init(const std::filesystem::path& cacheDirectory, std::vector<std::filesystem::path> searchPaths);
+
+  // Key of the content of the files (a source and its dependencies) with the given compiler options, never 0
+  uint64_t computeKey(std::span<const std::filesystem::path> files, std::string_view options) const;
+
+  // Read the SPIR-V stored with the key, false when missing or invalid
+  bool load(std::string_view name, uint64_t key, std::vector<uint32_t>& spirv) const;
+
+  // Write the SPIR-V of the key and the files it was compiled from, replacing the previous entries of the name
+  bool store(std::string_view name, uint64_t key, std::span<const uint32_t> spirv, std::span<const std::filesystem::path> files) const;
+
+  // Files the last entry stored for the name was compiled from, empty when there is none
+  std::vector<std::filesystem::path> getStoredDependencies(std::string_view name) const;
+
+  // The source and the dependencies of the .dep file found on disk, e.g. the files to watch for modifications
+  std::vector<std::filesystem::path> getDependencies(const std::filesystem::path& source, const std::filesystem::path& depFile) const;
+
+  // Dependencies listed in a Makefile-style dependency file ("target: dep1 dep2 ..."), as written
+  static std::vector<std::filesystem::path> readDepFile(const std::filesystem::path& depFile);
+
+  const std::filesystem::path& getCacheDirectory() const { return m_cacheDirectory; }
+
+private:
+  std::filesystem::path getEntryPath(std::string_view name, uint64_t key) const;
+  std::filesystem::path getDependencyListPath(std::string_view name) const;
+  std::filesystem::path resolveDependency(const std::filesystem::path& dependency) const;
+
+  std::filesystem::path              m_cacheDirectory;
+  std::vector<std::filesystem::path> m_searchPaths;
+};
+
+}  // namespace nvsamples
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "trace_recorder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#include <fmt/format.h>
+
+#include "nvutils/logger.hpp"
+
+#include "job_system.hpp"
+
+namespace nvsamples {
+
+namespace {
+thread_local void* t_threadBuffer = nullptr;  // ThreadBuffer of the calling thread
+
+// JSON string content: quotes, backslashes and control characters are escaped
+std::string escapeJson(std::string_view text)
+{
+  std::string result;
+  result.reserve(text.size());
+  for(char c : text)
+  {
+    if(c == '"' || c == '\\')
+      result += {'\\', c};
+    else if(uint8_t(c) < 0x20)
+      result += fmt::format("\\u{:04x}", uint8_t(c));
+    else
+      result += c;
+  }
+  return result;
+}
+}  // namespace
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+  static TraceRecorder recorder;
+  return recorder;
+}
+
+uint64_t TraceRecorder::now()
+{
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::getThreadBuffer()
+{
+  if(t_threadBuffer == nullptr)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ThreadBuffer& buffer = *m_threads.emplace_back(std::make_unique<ThreadBuffer>());
+    buffer.threadId      = uint32_t(m_threads.size());
+    const uint32_t jobThread = JobSystem::getInstance().getThreadIndex();
+    buffer.name = jobThread != 0 ? fmt::format("Job worker {}", jobThread) : buffer.threadId == 1 ? "Main" : fmt::format("Thread {}", buffer.threadId);
+    t_threadBuffer       = &buffer;
+  }
+  return *static_cast<ThreadBuffer*>(t_threadBuffer);
+}
+
+void TraceRecorder::addCpuEvent(const char* name, uint64_t beginNs, uint64_t endNs)
+{
+  ThreadBuffer&  buffer = getThreadBuffer();
+  const uint64_t head   = buffer.head.load(std::memory_order_relaxed);
+  Event&         event  = buffer.events[head % kEventsPerThread];
+  event.name.store(name, std::memory_order_relaxed);
+  event.begin.store(beginNs, std::memory_order_relaxed);
+  event.end.store(endNs, std::memory_order_relaxed);
+  buffer.head.store(head + 1, std::memory_order_release);  // Publishes the event
+}
+
+void TraceRecorder::addGpuEvent(std::string_view name, uint64_t beginNs, uint64_t endNs)
+{
+  if(!isEnabled())
+    return;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  TraceEvent event{.name = std::string(name), .begin = beginNs, .end = endNs, .threadId = 0};
+  if(m_gpuEvents.size() < kEventsPerThread)
+    m_gpuEvents.push_back(std::move(event));
+  else
+    m_gpuEvents[m_gpuEventCount % kEventsPerThread] = std::move(event);
+  m_gpuEventCount++;
+}
+
+void TraceRecorder::setThreadName(std::string_view name)
+{
+  ThreadBuffer&               buffer = getThreadBuffer();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  buffer.name = name;
+}
+
+bool TraceRecorder::markFrame()
+{
+  const uint64_t frameEnd   = now();
+  const uint64_t frameBegin = m_lastFrameNs;
+  m_lastFrameNs             = frameEnd;
+  if(!isEnabled() || frameBegin == 0)
+    return false;
+  addCpuEvent("Frame", frameBegin, frameEnd);
+
+  // A hitch: dump the frames before it, at most once per second
+  const double frameMs = double(frameEnd - frameBegin) * 1e-6;
+  if(m_hitchThresholdMs <= 0.0 || frameMs < m_hitchThresholdMs || (m_lastDumpNs != 0 && frameEnd - m_lastDumpNs < 1'000'000'000))
+    return false;
+  m_lastDumpNs = frameEnd;
+  LOGW("Frame of %.2f ms (threshold %.2f ms), writing the trace\n", frameMs, m_hitchThresholdMs);
+  writeChromeTrace(m_hitchDirectory / fmt::format("hitch_{}.json", m_dumpCount++));
+  return true;
+}
+
+TraceRecorder::Snapshot TraceRecorder::takeSnapshot()
+{
+  Snapshot                    snapshot;
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for(const std::unique_ptr<ThreadBuffer>& buffer : m_threads)
+  {
+    snapshot.threadNames.push_back({buffer->threadId, buffer->name});
+
+    // The owner keeps writing: the events overwritten during the copy (older than the head after it) are dropped
+    const uint64_t          head  = buffer->head.load(std::memory_order_acquire);
+    const uint64_t          first = head > kEventsPerThread ? head - kEventsPerThread : 0;
+    std::vector<TraceEvent> events;
+    for(uint64_t i = first; i < head; i++)
+    {
+      const Event& event = buffer->events[i % kEventsPerThread];
+      events.push_back({event.name.load(std::memory_order_relaxed), event.begin.load(std::memory_order_relaxed),
+                        event.end.load(std::memory_order_relaxed), buffer->threadId});
+    }
+    const uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+    const uint64_t dropped   = std::min<uint64_t>(events.size(), headAfter > kEventsPerThread + first ? headAfter - kEventsPerThread - first : 0);
+    snapshot.events.insert(snapshot.events.end(), events.begin() + dropped, events.end());
+  }
+  snapshot.threadNames.push_back({0, "GPU"});
+  snapshot.events.insert(snapshot.events.end(), m_gpuEvents.begin(), m_gpuEvents.end());
+  return snapshot;
+}
+
+void TraceRecorder::writeChromeTrace(const std::filesystem::path& filename)
+{
+  // The snapshot is cheap, the formatting is not: it runs in a job
+  auto snapshot = std::make_shared<Snapshot>(takeSnapshot());
+  JobSystem::getInstance().schedule([snapshot, filename] {
+    if(writeSnapshot(*snapshot, filename))
+      LOGI("Trace written to %s (%zu events)\n", filename.string().c_str(), snapshot->events.size());
+    else
+      LOGW("Could not write the trace to %s\n", filename.string().c_str());
+  });
+}
+
+bool TraceRecorder::writeSnapshot(const Snapshot& snapshot, const std::filesystem::path& filename)
+{
+  std::ofstream file(filename);
+  if(!file)
+    return false;
+
+  // Complete events ("X") in microseconds, one track per thread and one for the GPU
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  bool first = true;
+  for(const auto& [threadId, name] : snapshot.threadNames)
+  {
+    file << fmt::format("{}{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                        first ? "" : ",\n", threadId, escapeJson(name));
+    first = false;
+  }
+  for(const TraceEvent& event : snapshot.events)
+  {
+    file << fmt::format(",\n{{\"ph\":\"X\",\"name\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                        escapeJson(event.name), event.threadId, double(event.begin) * 1e-3,
+                        double(event.end > event.begin ? event.end - event.begin : 0) * 1e-3);
+  }
+  file << "\n]}\n";
+  return bool(file);
+}
+
+}  // namespace nvsamples
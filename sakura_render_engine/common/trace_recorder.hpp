@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nvsamples {
+
+//--------------------------------------------------------------------------------------------------
+// Timeline of CPU scopes and GPU passes, written as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+//
+// Each thread records its CPU events in its own ring buffer, without lock: recording an event costs two
+// clock reads and a few relaxed stores, so the recorder can stay enabled in release builds. The rings
+// keep the last kEventsPerThread events, a dump (on demand, or when a frame exceeds the hitch threshold)
+// takes a snapshot of all the rings and writes it in a background job.
+// The GPU passes are recorded by the GpuProfiler, in the CPU time base.
+//
+//   void ElementFoundation::cullInstances()
+//   {
+//     TRACE_SCOPE(__FUNCTION__);  // The name must outlive the recorder (string literal)
+//     ...
+//   }
+class TraceRecorder
+{
+public:
+  static constexpr uint32_t kEventsPerThread = 16384;
+
+  static TraceRecorder& getInstance();
+
+  // Nanoseconds since the start of the process, time base of all the events
+  static uint64_t now();
+
+  void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+  bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  // Event of the calling thread, `name` must be a string with static storage
+  void addCpuEvent(const char* name, uint64_t beginNs, uint64_t endNs);
+
+  // Event of the GPU track
+  void addGpuEvent(std::string_view name, uint64_t beginNs, uint64_t endNs);
+
+  // Name of the calling thread in the trace
+  void setThreadName(std::string_view name);
+
+  // End of a CPU frame: records the frame on the calling thread and dumps the trace to `hitchDirectory` when
+  // the frame is longer than the hitch threshold (at most once per second). Returns true when a dump started.
+  bool markFrame();
+
+  void   setHitchThreshold(double milliseconds) { m_hitchThresholdMs = milliseconds; }  // 0 disables the dumps
+  double getHitchThreshold() const { return m_hitchThresholdMs; }
+  void   setHitchDirectory(const std::filesystem::path& directory) { m_hitchDirectory = directory; }
+
+  // Write the recorded events as Chrome trace JSON, the file is written by a background job
+  void writeChromeTrace(const std::filesystem::path& filename);
+
+private:
+  struct Event
+  {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t>    begin{0};
+    std::atomic<uint64_t>    end{0};
+  };
+
+  // Ring of one thread, written by that thread only
+  struct ThreadBuffer
+  {
+    std::array<Event, kEventsPerThread> events;
+    std::atomic<uint64_t>               head{0};  // Number of events written
+    uint32_t                            threadId = 0;
+    std::string                         name;     // Protected by m_mutex
+  };
+
+  struct TraceEvent
+  {
+    std::string name;
+    uint64_t    begin;
+    uint64_t    end;
+    uint32_t    threadId;
+  };
+
+  struct Snapshot
+  {
+    std::vector<TraceEvent>                       events;
+    std::vector<std::pair<uint32_t, std::string>> threadNames;
+  };
+
+  ThreadBuffer& getThreadBuffer();
+  Snapshot      takeSnapshot();
+  static bool   writeSnapshot(const Snapshot& snapshot, const std::filesystem::path& filename);
+
+  std::atomic<bool> m_enabled{true};
+
+  std::mutex                                 m_mutex;          // Registration of the threads, GPU events
+  std::vector<std::unique_ptr<ThreadBuffer>> m_threads;
+  std::vector<TraceEvent>                    m_gpuEvents;      // Ring of kEventsPerThread events
+  uint64_t                                   m_gpuEventCount = 0;
+
+  double                m_hitchThresholdMs = 0.0;
+  std::filesystem::path m_hitchDirectory   = ".";
+  uint64_t              m_lastFrameNs      = 0;
+  uint64_t              m_lastDumpNs       = 0;
+  uint32_t              m_dumpCount        = 0;
+};
+
+// Records the lifetime of the scope on the calling thread
+class TraceScope
+{
+public:
+  explicit TraceScope(const char* name)
+      : m_name(TraceRecorder::getInstance().isEnabled() ? name : nullptr)
+      , m_begin(m_name ? TraceRecorder::now() : 0)
+  {
+  }
+  ~TraceScope()
+  {
+    if(m_name)
+      TraceRecorder::getInstance().addCpuEvent(m_name, m_begin, TraceRecorder::now());
+  }
+  TraceScope(const TraceScope&)            = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* m_name;
+  uint64_t    m_begin;
+};
+
+}  // namespace nvsamples
+
+#define TRACE_SCOPE_CONCAT_(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) nvsamples::TraceScope TRACE_SCOPE_CONCAT(traceScope, __LINE__)(name)
@@ -26,33 +26,62 @@
 #include <stb/stb_image.h>
 
 #include "utils.hpp"
+#include "job_system.hpp"
 
 
 namespace nvsamples {
 
 nvvk::Image loadAndCreateImage(VkCommandBuffer cmd, nvvk::StagingUploader& staging, VkDevice device, const std::filesystem::path& filename, bool sRgb)
 {
-  // Load the image from disk
-  int            w, h, comp, req_comp{4};
-  std::string    filenameUtf8 = nvutils::utf8FromPath(filename);
-  const stbi_uc* data         = stbi_load(filenameUtf8.c_str(), &w, &h, &comp, req_comp);
-  assert((data != nullptr) && "Could not load texture image!");
-
-  // Define how to create the image
-  VkImageCreateInfo imageInfo = DEFAULT_VkImageCreateInfo;
-  imageInfo.format            = sRgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
-  imageInfo.usage             = VK_IMAGE_USAGE_SAMPLED_BIT;
-  imageInfo.extent            = {uint32_t(w), uint32_t(h), 1};
+  return loadAndCreateImages(cmd, staging, device, std::span(&filename, 1), sRgb).front();
+}
+
+std::vector<nvvk::Image> loadAndCreateImages(VkCommandBuffer                        cmd,
+                                             nvvk::StagingUploader&                 staging,
+                                             VkDevice                               device,
+                                             std::span<const std::filesystem::path> filenames,
+                                             bool                                   sRgb)
+{
+  struct DecodedImage
+  {
+    stbi_uc* data = nullptr;
+    int      w = 0, h = 0, comp = 0;
+  };
+  const int req_comp{4};
+
+  // Load the images from disk, the decoding is the expensive part
+  std::vector<DecodedImage> decoded(filenames.size());
+  JobSystem::getInstance().parallelFor(uint32_t(filenames.size()), 1, [&](uint32_t begin, uint32_t end) {
+    for(uint32_t i = begin; i < end; i++)
+    {
+      std::string filenameUtf8 = nvutils::utf8FromPath(filenames[i]);
+      decoded[i].data          = stbi_load(filenameUtf8.c_str(), &decoded[i].w, &decoded[i].h, &decoded[i].comp, req_comp);
+    }
+  });
 
   nvvk::ResourceAllocator* allocator = staging.getResourceAllocator();
 
-  // Use the VMA allocator to create the image
-  const std::span dataSpan(data, w * h * req_comp);
-  nvvk::Image     texture;
-  NVVK_CHECK(allocator->createImage(texture, imageInfo, DEFAULT_VkImageViewCreateInfo));
-  NVVK_CHECK(staging.appendImage(texture, dataSpan, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+  std::vector<nvvk::Image> textures;
+  for(const DecodedImage& image : decoded)
+  {
+    assert((image.data != nullptr) && "Could not load texture image!");
+
+    // Define how to create the image
+    VkImageCreateInfo imageInfo = DEFAULT_VkImageCreateInfo;
+    imageInfo.format            = sRgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.usage             = VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.extent            = {uint32_t(image.w), uint32_t(image.h), 1};
+
+    // Use the VMA allocator to create the image, the staging uploader copies the data
+    const std::span<const stbi_uc> dataSpan(image.data, size_t(image.w) * image.h * req_comp);
+    nvvk::Image                    texture;
+    NVVK_CHECK(allocator->createImage(texture, imageInfo, DEFAULT_VkImageViewCreateInfo));
+    NVVK_CHECK(staging.appendImage(texture, dataSpan, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+    stbi_image_free(image.data);
 
-  return texture;
+    textures.push_back(texture);
+  }
+  return textures;
 }
 
 }  // namespace nvsamples
\ No newline at end of file
@@ -45,4 +45,11 @@ nvvk::Image loadAndCreateImage(VkCommandBuffer              cmd,
                                const std::filesystem::path& filename,
                                bool                         sRgb = true);
 
+// Same as loadAndCreateImage for several files, the images are decoded in parallel
+std::vector<nvvk::Image> loadAndCreateImages(VkCommandBuffer                        cmd,
+                                             nvvk::StagingUploader&                 staging,
+                                             VkDevice                               device,
+                                             std::span<const std::filesystem::path> filenames,
+                                             bool                                   sRgb = true);
+
 }  // namespace nvsamples
\ No newline at end of file
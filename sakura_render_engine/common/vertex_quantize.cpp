@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "vertex_quantize.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace nvsamples {
+
+int16_t quantizeSnorm16(float v)
+{
+  return int16_t(std::lround(std::clamp(v, -1.0F, 1.0F) * 32767.0F));
+}
+
+uint8_t quantizeUnorm8(float v)
+{
+  return uint8_t(std::lround(std::clamp(v, 0.0F, 1.0F) * 255.0F));
+}
+
+// Round to nearest even, with denormals, infinities and NaN
+uint16_t floatToHalf(float v)
+{
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  const uint32_t sign     = (bits >> 16) & 0x8000U;
+  const uint32_t exponent = (bits >> 23) & 0xFFU;
+  uint32_t       mantissa = bits & 0x7FFFFFU;
+
+  if(exponent == 0xFF)  // Inf or NaN
+    return uint16_t(sign | 0x7C00U | (mantissa ? 0x200U : 0U));
+
+  const int halfExponent = int(exponent) - 127 + 15;
+  if(halfExponent >= 0x1F)  // Overflow
+    return uint16_t(sign | 0x7C00U);
+
+  if(halfExponent <= 0)  // Denormal or zero
+  {
+    if(halfExponent < -10)
+      return uint16_t(sign);
+    mantissa |= 0x800000U;
+    const uint32_t shift   = uint32_t(14 - halfExponent);
+    uint32_t       half    = mantissa >> shift;
+    const uint32_t rest    = mantissa & ((1U << shift) - 1U);
+    const uint32_t halfway = 1U << (shift - 1U);
+    if(rest > halfway || (rest == halfway && (half & 1U)))
+      half++;
+    return uint16_t(sign | half);
+  }
+
+  uint32_t half = sign | (uint32_t(halfExponent) << 10) | (mantissa >> 13);
+  const uint32_t rest = mantissa & 0x1FFFU;
+  if(rest > 0x1000U || (rest == 0x1000U && (half & 1U)))
+    half++;  // May carry into the exponent, which is the correct rounding
+  return uint16_t(half);
+}
+
+float halfToFloat(uint16_t h)
+{
+  const uint32_t sign     = uint32_t(h & 0x8000U) << 16;
+  uint32_t       exponent = (h >> 10) & 0x1FU;
+  uint32_t       mantissa = h & 0x3FFU;
+  uint32_t       bits;
+  if(exponent == 0x1F)
+    bits = sign | 0x7F800000U | (mantissa << 13);
+  else if(exponent != 0)
+    bits = sign | ((exponent + 112U) << 23) | (mantissa << 13);
+  else if(mantissa == 0)
+    bits = sign;
+  else
+  {
+    // Denormal: normalize the mantissa
+    exponent = 113;
+    while((mantissa & 0x400U) == 0)
+    {
+      mantissa <<= 1;
+      exponent--;
+    }
+    bits = sign | (exponent << 23) | ((mantissa & 0x3FFU) << 13);
+  }
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+glm::vec2 octahedralEncode(const glm::vec3& n)
+{
+  const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+  if(l1 <= 0.0F)
+    return glm::vec2(0.0F);
+  glm::vec2 e(n.x / l1, n.y / l1);
+  if(n.z < 0.0F)
+  {
+    const glm::vec2 folded((1.0F - std::abs(e.y)) * (e.x >= 0.0F ? 1.0F : -1.0F),
+                           (1.0F - std::abs(e.x)) * (e.y >= 0.0F ? 1.0F : -1.0F));
+    e = folded;
+  }
+  return e;
+}
+
+glm::vec3 octahedralDecode(const glm::vec2& e)
+{
+  glm::vec3   n(e.x, e.y, 1.0F - std::abs(e.x) - std::abs(e.y));
+  const float t = std::max(-n.z, 0.0F);
+  n.x += n.x >= 0.0F ? -t : t;
+  n.y += n.y >= 0.0F ? -t : t;
+  return glm::normalize(n);
+}
+
+void computePositionQuantization(std::span<const glm::vec3> positions, glm::vec3& offset, glm::vec3& scale)
+{
+  glm::vec3 bboxMin(FLT_MAX), bboxMax(-FLT_MAX);
+  for(const glm::vec3& p : positions)
+  {
+    bboxMin = glm::min(bboxMin, p);
+    bboxMax = glm::max(bboxMax, p);
+  }
+  if(positions.empty())
+    bboxMin = bboxMax = glm::vec3(0.0F);
+  // Flat axes (e.g. a plane) keep a small scale: the scale is folded into the TLAS instance transforms, which must
+  // stay invertible, and the quantized values of these axes are 0 anyway
+  offset = (bboxMin + bboxMax) * 0.5F;
+  scale  = glm::max((bboxMax - bboxMin) * 0.5F, glm::vec3(1e-6F));
+}
+
+std::vector<int16_t> encodePositionsSnorm16(std::span<const glm::vec3> positions, const glm::vec3& offset, const glm::vec3& scale)
+{
+  // The scale of computePositionQuantization is never 0, a zero scale still maps its axis to 0
+  const glm::vec3 invScale(scale.x > 0.0F ? 1.0F / scale.x : 0.0F, scale.y > 0.0F ? 1.0F / scale.y : 0.0F,
+                           scale.z > 0.0F ? 1.0F / scale.z : 0.0F);
+
+  std::vector<int16_t> result(positions.size() * 4);
+  for(size_t i = 0; i < positions.size(); i++)
+  {
+    const glm::vec3 n = (positions[i] - offset) * invScale;
+    result[i * 4 + 0] = quantizeSnorm16(n.x);
+    result[i * 4 + 1] = quantizeSnorm16(n.y);
+    result[i * 4 + 2] = quantizeSnorm16(n.z);
+    result[i * 4 + 3] = 0;
+  }
+  return result;
+}
+
+std::vector<int16_t> encodeNormalsOctahedral(std::span<const glm::vec3> normals)
+{
+  std::vector<int16_t> result(normals.size() * 2);
+  for(size_t i = 0; i < normals.size(); i++)
+  {
+    const glm::vec2 e = octahedralEncode(normals[i]);
+    result[i * 2 + 0] = quantizeSnorm16(e.x);
+    result[i * 2 + 1] = quantizeSnorm16(e.y);
+  }
+  return result;
+}
+
+std::vector<int16_t> encodeTangentsOctahedral(std::span<const glm::vec4> tangents)
+{
+  std::vector<int16_t> result(tangents.size() * 4);
+  for(size_t i = 0; i < tangents.size(); i++)
+  {
+    const glm::vec2 e = octahedralEncode(glm::vec3(tangents[i]));
+    result[i * 4 + 0] = quantizeSnorm16(e.x);
+    result[i * 4 + 1] = quantizeSnorm16(e.y);
+    result[i * 4 + 2] = tangents[i].w < 0.0F ? -32767 : 32767;
+    result[i * 4 + 3] = 0;
+  }
+  return result;
+}
+
+std::vector<uint16_t> encodeTexCoordsHalf(std::span<const glm::vec2> texCoords)
+{
+  std::vector<uint16_t> result(texCoords.size() * 2);
+  for(size_t i = 0; i < texCoords.size(); i++)
+  {
+    result[i * 2 + 0] = floatToHalf(texCoords[i].x);
+    result[i * 2 + 1] = floatToHalf(texCoords[i].y);
+  }
+  return result;
+}
+
+std::vector<uint8_t> encodeColorsUnorm8(std::span<const glm::vec4> colors)
+{
+  std::vector<uint8_t> result(colors.size() * 4);
+  for(size_t i = 0; i < colors.size(); i++)
+  {
+    for(int c = 0; c < 4; c++)
+      result[i * 4 + c] = quantizeUnorm8(colors[i][c]);
+  }
+  return result;
+}
+
+}  // namespace nvsamples
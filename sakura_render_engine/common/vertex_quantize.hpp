@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024-2025, NVIDIA CORPORATION.  All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-FileCopyrightText: Copyright (c) 2024-2025, NVIDIA CORPORATION.
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+//--------------------------------------------------------------------------------------------------
+// Compact vertex encodings, decoded by the vertex shader (see decodeAttribute in foundation.slang)
+//
+// - Positions:  4 x snorm16 (w unused) relative to the mesh bounds: p = offset + q * scale   (8 bytes instead of 12)
+// - Normals:    octahedral encoding in 2 x snorm16                                          (4 bytes instead of 12)
+// - Tangents:   octahedral encoding in 2 x snorm16, bitangent sign and padding in 2 x snorm16 (8 bytes instead of 16)
+// - TexCoords:  2 x half float                                                              (4 bytes instead of 8)
+// - Colors:     4 x unorm8                                                                  (4 bytes instead of 16)
+
+namespace nvsamples {
+
+int16_t  quantizeSnorm16(float v);
+uint8_t  quantizeUnorm8(float v);
+uint16_t floatToHalf(float v);
+float    halfToFloat(uint16_t h);
+
+// Octahedral mapping of a unit vector to [-1,1]^2, and back
+glm::vec2 octahedralEncode(const glm::vec3& n);
+glm::vec3 octahedralDecode(const glm::vec2& e);
+
+// Offset and scale mapping the [-1,1] snorm range to the bounding box, the scale is at least 1e-6 (flat axes)
+void computePositionQuantization(std::span<const glm::vec3> positions, glm::vec3& offset, glm::vec3& scale);
+
+std::vector<int16_t>  encodePositionsSnorm16(std::span<const glm::vec3> positions, const glm::vec3& offset, const glm::vec3& scale);
+std::vector<int16_t>  encodeNormalsOctahedral(std::span<const glm::vec3> normals);
+std::vector<int16_t>  encodeTangentsOctahedral(std::span<const glm::vec4> tangents);
+std::vector<uint16_t> encodeTexCoordsHalf(std::span<const glm::vec2> texCoords);
+std::vector<uint8_t>  encodeColorsUnorm8(std::span<const glm::vec4> colors);
+
+}  // namespace nvsamples
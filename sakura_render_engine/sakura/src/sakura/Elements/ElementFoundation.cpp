@@ -25,24 +25,36 @@ void ElementFoundation::onAttach(nvapp::Application* app)
         .instance = app->getInstance(),
         .vulkanApiVersion = VK_API_VERSION_1_4,
     };
+    if (m_memoryBudgetSupported)
+        allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;  // Budgets from the driver instead of estimates
     m_allocator.init(allocatorInfo);
+    m_memoryTracker.init(m_allocator);
 
     // The VMA allocator is used for all allocations, the staging uploader will use it for staging buffers and images
     m_stagingUploader.init(&m_allocator, true);
 
     // Setting up the Slang compiler for hot reload shader
-    m_slangCompiler.addSearchPaths(nvsamples::getShaderDirs());
-    m_slangCompiler.defaultTarget();
-    m_slangCompiler.defaultOptions();
-    m_slangCompiler.addOption({ slang::CompilerOptionName::DebugInformation,
+    m_shaderCache.init(nvutils::getExecutablePath().replace_extension(".shader_cache"), nvsamples::getShaderDirs());
+    m_shaderBinaryCache.init(app->getPhysicalDevice(), m_shaderCache.getCacheDirectory() / "foundation.shader_binaries");
+    m_shaderBuilder.init({
+        .compilerSetup = [](nvslang::SlangCompiler& compiler) {
+            compiler.addSearchPaths(nvsamples::getShaderDirs());
+            compiler.defaultTarget();
+            compiler.defaultOptions();
+            compiler.addOption({ slang::CompilerOptionName::DebugInformation,
                                {slang::CompilerOptionValueKind::Int, SLANG_DEBUG_INFO_LEVEL_MAXIMAL} });
 #if defined(AFTERMATH_AVAILABLE)
-    // This aftermath callback is used to report the shader hash (Spirv) to the Aftermath library.
-    m_slangCompiler.setCompileCallback([&](const std::filesystem::path& sourceFile, const uint32_t* spirvCode, size_t spirvSize) {
-        std::span<const uint32_t> data(spirvCode, spirvSize / sizeof(uint32_t));
-        AftermathCrashTracker::getInstance().addShaderBinary(data);
-        });
+            // This aftermath callback is used to report the shader hash (Spirv) to the Aftermath library.
+            compiler.setCompileCallback([](const std::filesystem::path& sourceFile, const uint32_t* spirvCode, size_t spirvSize) {
+                std::span<const uint32_t> data(spirvCode, spirvSize / sizeof(uint32_t));
+                AftermathCrashTracker::getInstance().addShaderBinary(data);
+                });
 #endif
+        },
+        .optionsKey = std::string("spirv;debug-info=maximal;slang=") + spGetBuildTagString(),
+        .cache = &m_shaderCache,
+        .depDirectory = nvutils::getExecutablePath().parent_path() / TARGET_EXE_TO_SOURCE_DIRECTORY / "_autogen",
+        });
 
     // Acquiring the texture sampler which will be used for displaying the GBuffer
     m_samplerPool.init(app->getDevice());
@@ -60,11 +72,26 @@ void ElementFoundation::onAttach(nvapp::Application* app)
     };
     m_gBuffers.init(gBufferInit);
 
-    createScene();                        // Create the scene with a teapot and a plane
+    // Low resolution depth buffer of the CPU occlusion culler
+    m_occlusionCuller.init(256, 128);
+
+    // Frames in flight, and the command pools of the threads recording the draws for each of them
+    m_framePacer.init(app->getDevice(), 2);
+    m_deletionQueue.init(app->getDevice(), &m_allocator);
+    m_commandRecorder.init(app->getDevice(), app->getQueue(0).familyIndex, nvsamples::FramePacer::kMaxFramesInFlight);
+    m_gpuProfiler.init(app->getDevice(), app->getPhysicalDevice(), app->getQueue(0).familyIndex, nvsamples::FramePacer::kMaxFramesInFlight);
+    nvsamples::TraceRecorder::getInstance().setHitchDirectory(nvutils::getExecutablePath().parent_path());  // Traces of the hitches
+
+    // Create the scene with a teapot and a plane (or the scene file)
+    {
+        VkCommandBuffer cmd = m_app->createTempCmdBuffer();
+        createScene(cmd);
+        m_app->submitAndWaitTempCmdBuffer(cmd);  // Submit the command buffer to upload the resources
+        m_stagingUploader.releaseStaging();
+    }
     createGraphicsDescriptorSetLayout();  // Create the descriptor set layout for the graphics pipeline
     createGraphicsPipelineLayout();       // Create the graphics pipeline layout
-    compileAndCreateGraphicsShaders();    // Compile the graphics shaders and create the shader modules
-    updateTextures();                     // Update the textures in the descriptor set (if any)
+    compileAndCreateGraphicsShaders();    // Create the shaders from the cache, or the pre-compiled ones while compiling
 
     // Initialize the Sky with the pre-compiled shader
     m_skySimple.init(&m_allocator, std::span(sky_simple_slang));
@@ -80,18 +107,39 @@ void ElementFoundation::onAttach(nvapp::Application* app)
 void ElementFoundation::onDetach() 
 {
     NVVK_CHECK(vkQueueWaitIdle(m_app->getQueue(0).queue));
+    m_shaderWatcher.stop();
+    if (m_shaderCompile.valid())
+    {
+        GraphicsShaders shaders = m_shaderCompile.get();  // Still using the compilers, its shaders were never used
+        setGraphicsShaders(shaders);
+    }
+    m_shaderBuilder.deinit();
+    m_shaderBinaryCache.save();
+    m_shaderBinaryCache.deinit();
+    m_deletionQueue.flushAll();  // The GPU is idle
 
     VkDevice device = m_app->getDevice();
 
     m_descPack.deinit();
     vkDestroyPipelineLayout(device, m_graphicPipelineLayout, nullptr);
-    vkDestroyShaderEXT(device, m_vertexShader, nullptr);
-    vkDestroyShaderEXT(device, m_fragmentShader, nullptr);
+    for (uint32_t i = 0; i < kShaderPermutationCount; i++)
+    {
+        vkDestroyShaderEXT(device, m_shaders.vertex[i], nullptr);
+        vkDestroyShaderEXT(device, m_shaders.fragment[i], nullptr);
+        vkDestroyShaderEXT(device, m_shaders.task[i], nullptr);
+        vkDestroyShaderEXT(device, m_shaders.mesh[i], nullptr);
+    }
 
     m_allocator.destroyBuffer(m_sceneResource.bSceneInfo);
     m_allocator.destroyBuffer(m_sceneResource.bMeshes);
     m_allocator.destroyBuffer(m_sceneResource.bMaterials);
     m_allocator.destroyBuffer(m_sceneResource.bInstances);
+    for (FrameResources& frame : m_frameResources)
+    {
+        m_allocator.destroyBuffer(frame.bSceneInfo);
+        m_allocator.destroyBuffer(frame.bInstances);
+        m_allocator.destroyBuffer(frame.bDrawInstances);
+    }
     for (auto& gltfData : m_sceneResource.bGltfDatas)
     {
         m_allocator.destroyBuffer(gltfData);
@@ -100,12 +148,17 @@ void ElementFoundation::onDetach()
     {
         m_allocator.destroyImage(texture);
     }
+    m_deletionQueue.deinit();  // The GPU is idle
 
+    m_commandRecorder.deinit();
+    m_framePacer.deinit();
+    m_gpuProfiler.deinit();
     m_gBuffers.deinit();
     m_stagingUploader.deinit();
     m_skySimple.deinit();
     m_tonemapper.deinit();
     m_samplerPool.deinit();
+    m_memoryTracker.deinit();
     m_allocator.deinit();
 }
 
@@ -170,6 +223,186 @@ void ElementFoundation::onUIRender()
         {
             nvgui::tonemapperWidget(m_tonemapperData);
         }
+        if (ImGui::CollapsingHeader("Culling"))
+        {
+            ImGui::Checkbox("Occlusion Culling", &m_useOcclusionCulling);
+            ImGui::Text("Culled instances: %u / %zu", m_culledInstances, m_sceneResource.instances.size());
+            ImGui::Text("Occluder triangles: %u", m_occlusionCuller.getOccluderTriangleCount());
+        }
+        if (ImGui::CollapsingHeader("Level of Detail"))
+        {
+            ImGui::Checkbox("Mesh LOD", &m_useMeshLod);
+            PE::begin();
+            PE::SliderFloat("Pixel Error", &m_lodPixelError, 0.1f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic,
+                "Maximum screen space error of the simplified meshes, in pixels");
+            PE::end();
+            ImGui::Text("Drawn triangles: %u", m_drawnTriangles);
+            ImGui::Text("Draw calls: %zu (%zu batches)", m_instancedDraws.size(), m_drawBatcher.getBatches().size());
+        }
+        if (ImGui::CollapsingHeader("Meshlets"))
+        {
+            ImGui::BeginDisabled(m_shaders.task[0] == VK_NULL_HANDLE);
+            ImGui::Checkbox("Task/Mesh Shaders", &m_useMeshShaders);
+            ImGui::Checkbox("Normal Cone Culling", &m_meshletConeCulling);
+            ImGui::SetItemTooltip("Skip the back facing meshlets: the back faces of open meshes disappear, unlike in the vertex path");
+            ImGui::EndDisabled();
+            if (m_shaders.task[0] == VK_NULL_HANDLE)
+                ImGui::TextDisabled("Mesh shaders are not available on this device");
+        }
+        if (ImGui::CollapsingHeader("Shader Permutations"))
+        {
+            // Off: every batch uses the generic permutation, branching on the material and the light at runtime
+            ImGui::Checkbox("Specialized Shaders", &m_useSpecializedShaders);
+            ImGui::Text("Permutations drawn: %u", m_drawnPermutations);
+            ImGui::Text("Cached shader binaries: %zu", m_shaderBinaryCache.size());
+        }
+        if (ImGui::CollapsingHeader("Command Recording"))
+        {
+            ImGui::Checkbox("Parallel Recording", &m_useParallelRecording);
+            nvsamples::SecondaryCommandRecorder::Settings settings = m_commandRecorder.getSettings();
+            bool                                          changed = false;
+            ImGui::BeginDisabled(!m_useParallelRecording);
+            PE::begin();
+            changed |= PE::SliderInt("Threads", (int*)&settings.numThreads, 0, int(m_commandRecorder.getMaxThreads()), "%d",
+                ImGuiSliderFlags_AlwaysClamp, "Threads recording secondary command buffers (0: all)");
+            changed |= PE::SliderInt("Min Draws", (int*)&settings.minItemsPerRange, 1, 1024, "%d",
+                ImGuiSliderFlags_AlwaysClamp | ImGuiSliderFlags_Logarithmic, "Minimum number of draws per secondary command buffer");
+            changed |= PE::SliderInt("Ranges per Thread", (int*)&settings.rangesPerThread, 1, 16, "%d",
+                ImGuiSliderFlags_AlwaysClamp, "Secondary command buffers per thread, more balance uneven draws");
+            PE::end();
+            ImGui::EndDisabled();
+            if (changed)
+                m_commandRecorder.setSettings(settings);
+            if (m_useParallelRecording)
+                ImGui::Text("%u command buffers on %u threads", m_commandRecorder.getLastRangeCount(), m_commandRecorder.getLastThreadCount());
+            ImGui::Text("Recording: %.3f ms", m_recordingTime);
+        }
+        if (ImGui::CollapsingHeader("Scene"))
+        {
+            // Swapped at the start of the next frame, without waiting for the GPU
+            ImGui::Text("%s", m_sceneResource.meshes.empty() ? "No scene"
+                : m_sceneFile.empty()                          ? "Default scene"
+                                                               : nvutils::utf8FromPath(m_sceneFile.filename()).c_str());
+            if (ImGui::Button("Load Default Scene"))
+                loadScene({});
+            ImGui::SameLine();
+            if (ImGui::Button("Unload Scene"))
+                unloadScene();
+            ImGui::TextDisabled("Drop a .gltf or .glb file on the window to load it");
+            ImGui::Text("GPU objects pending destruction: %zu", m_deletionQueue.size());
+        }
+        if (ImGui::CollapsingHeader("Frames in Flight"))
+        {
+            int framesInFlight = int(m_framePacer.getFramesInFlight());
+            PE::begin();
+            if (PE::SliderInt("Frames in Flight", &framesInFlight, 1, int(nvsamples::FramePacer::kMaxFramesInFlight), "%d",
+                ImGuiSliderFlags_AlwaysClamp, "Frames recorded by the CPU before waiting for the GPU (1: no overlap)"))
+                m_framePacer.setFramesInFlight(uint32_t(framesInFlight));
+            PE::end();
+            ImGui::Text("CPU wait for the GPU: %.3f ms", m_framePacer.getLastWaitTime());
+        }
+        if (ImGui::CollapsingHeader("GPU Timings"))
+        {
+            // Statistics over the last GpuProfiler::kHistorySize frames
+            if (ImGui::BeginTable("GpuTimings", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+            {
+                ImGui::TableSetupColumn("Pass");
+                ImGui::TableSetupColumn("Last");
+                ImGui::TableSetupColumn("Min");
+                ImGui::TableSetupColumn("Avg");
+                ImGui::TableSetupColumn("P99");
+                ImGui::TableHeadersRow();
+                for (const nvsamples::GpuProfiler::Stats& stats : m_gpuProfiler.getStats())
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(stats.name.c_str());
+                    for (double value : { stats.lastMs, stats.minMs, stats.avgMs, stats.p99Ms })
+                    {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%.3f ms", value);
+                    }
+                }
+                ImGui::EndTable();
+            }
+        }
+        if (ImGui::CollapsingHeader("Memory"))
+        {
+            if (ImGui::BeginTable("MemoryCategories", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+            {
+                ImGui::TableSetupColumn("Category");
+                ImGui::TableSetupColumn("Size");
+                ImGui::TableHeadersRow();
+                for (uint32_t i = 0; i < uint32_t(nvsamples::MemoryCategory::eCount); i++)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(nvsamples::MemoryTracker::getCategoryName(nvsamples::MemoryCategory(i)));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f MB", double(m_memoryTracker.getCategoryBytes(nvsamples::MemoryCategory(i))) / (1024.0 * 1024.0));
+                }
+                ImGui::EndTable();
+            }
+
+            // Usage of the heaps against their budget
+            const std::vector<nvsamples::MemoryTracker::HeapBudget>& heaps = m_memoryTracker.getHeapBudgets();
+            for (size_t heap = 0; heap < heaps.size(); heap++)
+            {
+                const float ratio = heaps[heap].budget > 0 ? float(double(heaps[heap].usage) / double(heaps[heap].budget)) : 0.0f;
+                char        overlay[96];
+                snprintf(overlay, sizeof(overlay), "Heap %zu%s: %.0f / %.0f MB", heap, heaps[heap].deviceLocal ? " (device)" : "",
+                    double(heaps[heap].usage) / (1024.0 * 1024.0), double(heaps[heap].budget) / (1024.0 * 1024.0));
+                ImGui::ProgressBar(ratio, ImVec2(-1.0f, 0.0f), overlay);
+            }
+            if (!m_memoryBudgetSupported)
+                ImGui::TextDisabled("VK_EXT_memory_budget not enabled, the usage is estimated");
+
+            float pressureThreshold = m_memoryTracker.getPressureThreshold() * 100.0f;
+            PE::begin();
+            if (PE::SliderFloat("Pressure Threshold", &pressureThreshold, 50.0f, 100.0f, "%.0f %%", ImGuiSliderFlags_AlwaysClamp,
+                "Usage of a device heap, relative to its budget, notifying the budget pressure callbacks"))
+                m_memoryTracker.setPressureThreshold(pressureThreshold / 100.0f);
+            PE::end();
+        }
+        if (ImGui::CollapsingHeader("Camera Path"))
+        {
+            // Keys of the camera, replayed by sakura_bench (--cameraPath)
+            if (ImGui::Button(m_recordCameraPath ? "Stop Recording" : "Record"))
+            {
+                m_recordCameraPath = !m_recordCameraPath;
+                if (m_recordCameraPath)
+                {
+                    m_cameraPath.clear();
+                    m_cameraPathTimer.reset();
+                }
+            }
+            ImGui::SameLine();
+            ImGui::BeginDisabled(m_recordCameraPath || m_cameraPath.empty());
+            if (ImGui::Button("Save"))
+            {
+                const std::filesystem::path pathFilename = nvutils::getExecutablePath().replace_extension(".camera_path.txt");
+                if (m_cameraPath.save(pathFilename))
+                    LOGI("Camera path written to %s\n", nvutils::utf8FromPath(pathFilename).c_str());
+            }
+            ImGui::EndDisabled();
+            ImGui::Text("%zu keys, %.1f s", m_cameraPath.getKeys().size(), m_cameraPath.getDuration());
+        }
+        if (ImGui::CollapsingHeader("Trace"))
+        {
+            nvsamples::TraceRecorder& trace = nvsamples::TraceRecorder::getInstance();
+            bool                      enabled = trace.isEnabled();
+            float                     hitchThreshold = float(trace.getHitchThreshold());
+            if (ImGui::Checkbox("Record Events", &enabled))
+                trace.setEnabled(enabled);
+            PE::begin();
+            if (PE::SliderFloat("Hitch Threshold", &hitchThreshold, 0.0f, 500.0f, "%.1f ms", ImGuiSliderFlags_AlwaysClamp,
+                "Frames longer than this write the trace next to the executable (0: disabled)"))
+                trace.setHitchThreshold(hitchThreshold);
+            PE::end();
+            if (ImGui::Button("Save Trace"))
+                trace.writeChromeTrace(nvutils::getExecutablePath().replace_extension(".trace.json"));
+            ImGui::SetItemTooltip("Chrome trace JSON, open in ui.perfetto.dev or chrome://tracing");
+        }
         ImGui::Separator();
         PE::begin();
         PE::SliderFloat2("Metallic/Roughness Override", glm::value_ptr(m_metallicRoughnessOverride), -0.01f, 1.0f, "%.2f",
@@ -182,7 +415,20 @@ void ElementFoundation::onUIRender()
 //---------------------------------------------------------------------------------------------------------------
 // When the viewport is resized, the GBuffer must be resized
 // - Called when the Window "viewport is resized
-void ElementFoundation::onResize(VkCommandBuffer cmd, const VkExtent2D& size) { NVVK_CHECK(m_gBuffers.update(cmd, size)); }
+void ElementFoundation::onResize(VkCommandBuffer cmd, const VkExtent2D& size)
+{
+    NVVK_CHECK(m_gBuffers.update(cmd, size));
+
+    // The G-buffer images are allocated by nvvk::GBuffer, their size is accounted from their memory requirements
+    VkDeviceSize gBufferBytes = 0;
+    for (VkImage image : { m_gBuffers.getColorImage(eImgRendered), m_gBuffers.getColorImage(eImgTonemapped), m_gBuffers.getDepthImage() })
+    {
+        VkMemoryRequirements requirements{};
+        vkGetImageMemoryRequirements(m_app->getDevice(), image, &requirements);
+        gBufferBytes += requirements.size;
+    }
+    m_memoryTracker.setExternalBytes(nvsamples::MemoryCategory::eGBuffers, gBufferBytes);
+}
 
 //---------------------------------------------------------------------------------------------------------------
 // Rendering the scene
@@ -192,13 +438,55 @@ void ElementFoundation::onResize(VkCommandBuffer cmd, const VkExtent2D& size) {
 void ElementFoundation::onRender(VkCommandBuffer cmd)
 {
     NVVK_DBG_SCOPE(cmd);  // <-- Helps to debug in NSight
+    nvsamples::TraceRecorder::getInstance().markFrame();  // End of the previous frame, dumps the trace on a hitch
+    TRACE_SCOPE("onRender");
+
+    // Camera path recording
+    const float cameraPathTime = float(m_cameraPathTimer.getSeconds());
+    if (m_recordCameraPath && (m_cameraPath.empty() || cameraPathTime - m_cameraPath.getDuration() >= 0.1f))
+        m_cameraPath.addKey({ .time = cameraPathTime, .eye = m_cameraManip->getEye(), .center = m_cameraManip->getCenter(), .up = m_cameraManip->getUp() });
+
+    m_memoryTracker.update();  // Heap budgets, may notify the budget pressure
+
+    // Wait until the GPU is done with the resources of this frame slot, the submission of the frame signals it
+    const uint32_t frameSlot = m_framePacer.beginFrame();
+    m_app->addSignalSemaphore(m_framePacer.getSignalInfo());
+    m_gpuProfiler.beginFrame(cmd, frameSlot);  // Reads the timings of the previous use of the slot
+
+    // Free the objects the GPU is done with, then apply a requested scene swap
+    const uint64_t completedFrame = m_framePacer.getCompletedFrame();
+    m_deletionQueue.flush(completedFrame);
+    if (m_stagingReleaseFrame != 0 && completedFrame >= m_stagingReleaseFrame)
+    {
+        m_stagingUploader.releaseStaging(true);
+        m_stagingReleaseFrame = 0;
+    }
+    if (m_sceneRequest != SceneRequest::eNone && m_stagingReleaseFrame == 0)  // One swap at a time, for the staging
+        swapScene(cmd);
+
+    // Textures of the scene in the descriptor set of this slot, the other slots may still be in use
+    FrameResources& frame = m_frameResources[frameSlot];
+    if (frame.texturesRevision != m_texturesRevision)
+    {
+        updateTextures(frameSlot);
+        frame.texturesRevision = m_texturesRevision;
+    }
+
+    // Cull the instances and build the instanced draws
+    buildDrawList();
 
-    // Update the scene information buffer, this cannot be done in between dynamic rendering
-    updateSceneBuffer(cmd);
+    // Write the scene information, the instances and the instanced draws of this frame
+    updateSceneBuffer(frameSlot);
+
+    // Timestamps around the passes
+    nvsamples::GpuProfiler::Section frameSection(m_gpuProfiler, cmd, "Frame");
 
     rasterScene(cmd);
 
-    postProcess(cmd);
+    {
+        nvsamples::GpuProfiler::Section section(m_gpuProfiler, cmd, "Post-process");
+        postProcess(cmd);
+    }
 }
 
 // Apply post-processing
@@ -226,69 +514,86 @@ void ElementFoundation::onUIMenu()
     if (ImGui::BeginMenu("Tools"))
     {
         reload |= ImGui::MenuItem("Reload Shaders", "F5");
+        ImGui::MenuItem("Auto Reload Shaders", nullptr, &m_autoReloadShaders);
+        if (m_shaderCompile.valid())
+            ImGui::TextDisabled("Compiling shaders...");
         ImGui::EndMenu();
     }
     reload |= ImGui::IsKeyPressed(ImGuiKey_F5);
     if (reload)
-    {
-        vkQueueWaitIdle(m_app->getQueue(0).queue);
-        compileAndCreateGraphicsShaders();  // Recompile shaders on F5 key press
-    }
+        reloadGraphicsShaders();  // Recompile shaders on F5 key press, in the background: the current ones keep rendering
+    pollShaderCompile();          // Swap in the shaders once compiled, and reload them when the sources are saved
 }
 
 //---------------------------------------------------------------------------------------------------------------
 // Create the scene for this sample
 // - Load a teapot, a plane and an image.
 // - Create instances for them, assign a material and a transformation
-void ElementFoundation::createScene()
+void ElementFoundation::createScene(VkCommandBuffer cmd)
 {
     SCOPED_TIMER(__FUNCTION__);
+    TRACE_SCOPE("createScene");
 
-    VkCommandBuffer cmd = m_app->createTempCmdBuffer();
-
-    // Load the GLTF resources
+    // Load the GLTF resources: the scene file when there is one, the teapot and the plane otherwise
+    if (!m_sceneFile.empty() && importSceneFile())
     {
-        tinygltf::Model teapotModel =
-            nvsamples::loadGltfResources(nvutils::findFile("teapot.gltf", nvsamples::getResourcesDirs()));  // Load the GLTF resources from the file
-
-        tinygltf::Model planeModel =
-            nvsamples::loadGltfResources(nvutils::findFile("plane.gltf", nvsamples::getResourcesDirs()));  // Load the GLTF resources from the file
-
-        // Textures
+        // Meshes and instances of the file, with a single material
+    }
+    else
+    {
+        // The files are loaded by parallel jobs
+        tinygltf::Model       teapotModel;
+        tinygltf::Model       planeModel;
+        nvsamples::JobSystem& jobs = nvsamples::JobSystem::getInstance();
+        nvsamples::JobCounter modelsLoaded;
+        jobs.schedule([&] { teapotModel = nvsamples::loadGltfResources(nvutils::findFile("teapot.gltf", nvsamples::getResourcesDirs())); }, &modelsLoaded);
+        jobs.schedule([&] { planeModel = nvsamples::loadGltfResources(nvutils::findFile("plane.gltf", nvsamples::getResourcesDirs())); }, &modelsLoaded);
+
+        // Textures, decoded in parallel while the models are loading
         {
-            std::filesystem::path imageFilename = nvutils::findFile("tiled_floor.png", nvsamples::getResourcesDirs());
-            nvvk::Image texture = nvsamples::loadAndCreateImage(cmd, m_stagingUploader, m_app->getDevice(), imageFilename);  // Load the image from the file and create a texture from it
-            NVVK_DBG_NAME(texture.image);
-            m_samplerPool.acquireSampler(texture.descriptor.sampler);
-            m_textures.emplace_back(texture);  // Store the texture in the vector of textures
+            const std::filesystem::path imageFilenames[] = { nvutils::findFile("tiled_floor.png", nvsamples::getResourcesDirs()) };
+            for (nvvk::Image& texture : nvsamples::loadAndCreateImages(cmd, m_stagingUploader, m_app->getDevice(), imageFilenames))  // Load the images from the files and create textures from them
+            {
+                NVVK_DBG_NAME(texture.image);
+                m_samplerPool.acquireSampler(texture.descriptor.sampler);
+                m_textures.emplace_back(texture);  // Store the texture in the vector of textures
+                m_memoryTracker.track(texture.allocation, nvsamples::MemoryCategory::eTextures);
+                m_texturesRevision++;
+            }
         }
+        jobs.wait(modelsLoaded);
 
         // Upload the GLTF resources to the GPU
         {
-            nvsamples::importGltfData(m_sceneResource, teapotModel, m_stagingUploader);  // Import the GLTF resources
-            nvsamples::importGltfData(m_sceneResource, planeModel, m_stagingUploader);   // Import the GLTF resources
+            const nvsamples::GltfImportSettings importSettings{ .generateLods = true, .optimizeMeshes = true, .buildMeshlets = true, .quantizeVertices = true };
+            nvsamples::importGltfData(m_sceneResource, teapotModel, m_stagingUploader, false, importSettings);  // Import the GLTF resources
+            nvsamples::importGltfData(m_sceneResource, planeModel, m_stagingUploader, false, importSettings);   // Import the GLTF resources
         }
-    }
-
-
-    m_sceneResource.materials = {
-        // Teapot material
-        {.baseColorFactor = glm::vec4(0.8f, 1.0f, 0.6f, 1.0f), .metallicFactor = 0.5f, .roughnessFactor = 0.5f},
-        // Plane material with texture
-        {.baseColorFactor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), .metallicFactor = 0.1f, .roughnessFactor = 0.8f, .baseColorTextureIndex = 0} };
 
+        m_sceneResource.materials = {
+            // Teapot material
+            {.baseColorFactor = glm::vec4(0.8f, 1.0f, 0.6f, 1.0f), .metallicFactor = 0.5f, .roughnessFactor = 0.5f},
+            // Plane material with texture
+            {.baseColorFactor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), .metallicFactor = 0.1f, .roughnessFactor = 0.8f, .baseColorTextureIndex = 0} };
 
-    m_sceneResource.instances = {
+        m_sceneResource.instances.clear();
         // Teapot
-        {.transform = glm::translate(glm::mat4(1), glm::vec3(0, 0, 0)) * glm::scale(glm::mat4(1), glm::vec3(0.5f)),
-         .materialIndex = 0,
-         .meshIndex = 0},
-         // Plane
-         {.transform = glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, -0.9f, 0)), glm::vec3(2.f)), .materialIndex = 1, .meshIndex = 1},
-    };
+        m_sceneResource.instances.add(glm::translate(glm::mat4(1), glm::vec3(0, 0, 0)) * glm::scale(glm::mat4(1), glm::vec3(0.5f)),
+            /*meshIndex*/ 0, /*materialIndex*/ 0);
+        // Plane
+        m_sceneResource.instances.add(glm::scale(glm::translate(glm::mat4(1), glm::vec3(0, -0.9f, 0)), glm::vec3(2.f)),
+            /*meshIndex*/ 1, /*materialIndex*/ 1);
+
+        const tinygltf::Model* models[] = { &teapotModel, &planeModel };
+        createOccluders(models);  // The plane
+    }
 
 
     nvsamples::createGltfSceneInfoBuffer(m_sceneResource, m_stagingUploader);  // Create buffers for the scene data (GPU buffers)
+    for (const nvvk::Buffer& gltfData : m_sceneResource.bGltfDatas)
+        m_memoryTracker.track(gltfData.allocation, nvsamples::MemoryCategory::eGeometry);
+    for (const nvvk::Buffer* buffer : { &m_sceneResource.bSceneInfo, &m_sceneResource.bMeshes, &m_sceneResource.bMaterials, &m_sceneResource.bInstances })
+        m_memoryTracker.track(buffer->allocation, nvsamples::MemoryCategory::eSceneData);
 
     m_stagingUploader.cmdUploadAppended(cmd);  // Upload the scene information to the GPU
 
@@ -307,14 +612,202 @@ void ElementFoundation::createScene()
     sceneInfo.punctualLights[0].type = shaderio::GltfLightType::ePoint;
     sceneInfo.punctualLights[0].coneAngle = 0.9f;  // Cone angle for spot lights (0 for point and directional lights)
 
-    m_app->submitAndWaitTempCmdBuffer(cmd);  // Submit the command buffer to upload the resources
-
     // Default camera
     m_cameraManip->setClipPlanes({ 0.01F, 100.0F });
     m_cameraManip->setLookat({ 0.0F, 0.5F, 5.0 }, { 0.F, 0.F, 0.F }, { 0.0F, 1.0F, 0.0F });
 }
 
 
+//---------------------------------------------------------------------------------------------------------------
+// Scene swap requests, applied by onRender() at the start of the next frame
+//
+void ElementFoundation::loadScene(const std::filesystem::path& filename)
+{
+    m_sceneRequest = SceneRequest::eLoad;
+    m_requestedSceneFile = filename;
+}
+
+void ElementFoundation::unloadScene()
+{
+    m_sceneRequest = SceneRequest::eUnload;
+    m_requestedSceneFile.clear();
+}
+
+void ElementFoundation::onFileDrop(const std::filesystem::path& filename)
+{
+    if (filename.extension() == ".gltf" || filename.extension() == ".glb")
+        loadScene(filename);
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Replace the scene without waiting for the GPU: the resources of the current scene are retired with the number of
+// the previous frame, the last one using them, and the new scene is uploaded by the commands of this frame.
+// Its staging buffers are released once this frame is done.
+//
+void ElementFoundation::swapScene(VkCommandBuffer cmd)
+{
+    TRACE_SCOPE("swapScene");
+    retireScene();
+
+    m_sceneFile = m_requestedSceneFile;
+    if (m_sceneRequest == SceneRequest::eLoad)
+    {
+        createScene(cmd);
+        nvvk::cmdMemoryBarrier(cmd, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);  // Uploads before the draws
+        m_stagingReleaseFrame = m_framePacer.getFrameNumber();
+    }
+    m_sceneRequest = SceneRequest::eNone;
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Hand the GPU resources of the scene to the deletion queue and clear the CPU state derived from it.
+// They were last used by the previous frame, the current one is recorded with the new scene.
+//
+void ElementFoundation::retireScene()
+{
+    std::vector<nvvk::Buffer> buffers = std::move(m_sceneResource.bGltfDatas);
+    for (nvvk::Buffer* buffer : { &m_sceneResource.bSceneInfo, &m_sceneResource.bMeshes, &m_sceneResource.bMaterials, &m_sceneResource.bInstances })
+    {
+        if (buffer->buffer != VK_NULL_HANDLE)
+            buffers.push_back(*buffer);
+    }
+    std::vector<nvvk::Image> images = std::move(m_textures);
+    m_deletionQueue.push(m_framePacer.getFrameNumber() - 1, [this, buffers, images]() mutable {
+        for (nvvk::Buffer& buffer : buffers)
+        {
+            m_memoryTracker.untrack(buffer.allocation);
+            m_allocator.destroyBuffer(buffer);
+        }
+        for (nvvk::Image& image : images)
+        {
+            m_memoryTracker.untrack(image.allocation);
+            m_allocator.destroyImage(image);
+        }
+    });
+
+    m_sceneResource = {};
+    m_textures.clear();
+    m_texturesRevision++;
+    m_occluderMeshes.clear();
+    m_instanceVisible.clear();
+    m_drawBatcher.clear();
+    for (FrameResources& frame : m_frameResources)
+        frame.instancesRevision = ~0ULL;  // The new InstanceStore restarts its revisions
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Import the scene set with setSceneFile(): the meshes and the instances of the nodes, all with a default material.
+// Returns false when the file has no mesh, the default scene is used instead.
+//
+bool ElementFoundation::importSceneFile()
+{
+    const tinygltf::Model model = nvsamples::loadGltfResources(m_sceneFile);
+    if (model.meshes.empty())
+    {
+        LOGW("No mesh in %s, loading the default scene\n", nvutils::utf8FromPath(m_sceneFile).c_str());
+        return false;
+    }
+
+    const nvsamples::GltfImportSettings importSettings{ .generateLods = true, .optimizeMeshes = true, .buildMeshlets = true, .quantizeVertices = true };
+    m_sceneResource.instances.clear();
+    nvsamples::importGltfData(m_sceneResource, model, m_stagingUploader, true, importSettings);  // Import the meshes and the instances
+
+    m_sceneResource.materials = {
+        {.baseColorFactor = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f), .metallicFactor = 0.1f, .roughnessFactor = 0.6f, .baseColorTextureIndex = -1} };
+
+    const tinygltf::Model* models[] = { &model };
+    createOccluders(models);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Pick the occluders among the meshes of the scene, and keep a CPU copy of their geometry for the occlusion culler
+// (one entry per mesh, empty when the mesh is not an occluder). Only large and simple meshes make good occluders:
+// the candidates are ranked by the world space bounds of their largest instance (selectOccluderMeshes).
+// The models are the ones imported in m_sceneResource, in order: their meshes are the meshes of the scene.
+//
+void ElementFoundation::createOccluders(std::span<const tinygltf::Model* const> models)
+{
+    const nvsamples::InstanceStore& instances = m_sceneResource.instances;
+    const nvutils::Bbox             sceneBounds = getSceneBounds();
+    m_occluderMeshes.assign(m_sceneResource.meshes.size(), {});
+    if (sceneBounds.isEmpty())
+        return;
+
+    std::vector<nvsamples::OccluderCandidate> candidates(m_sceneResource.meshes.size());
+    std::vector<float>                        largestInstance(candidates.size(), -1.0F);  // Diagonal of the bounds
+    for (uint32_t i = 0; i < instances.size(); i++)
+    {
+        const uint32_t       meshIndex = instances.getMeshIndex(i);
+        const nvutils::Bbox& meshBounds = m_sceneResource.meshBounds[meshIndex];
+        if (meshBounds.isEmpty())
+            continue;
+        const nvutils::Bbox           bounds = meshBounds.transform(instances.getTransform(i));
+        nvsamples::OccluderCandidate& candidate = candidates[meshIndex];
+        candidate.instanceCount++;
+        const float size = glm::length(bounds.max() - bounds.min());
+        if (size > largestInstance[meshIndex])
+        {
+            largestInstance[meshIndex] = size;
+            candidate.bboxMin = bounds.min();
+            candidate.bboxMax = bounds.max();
+        }
+    }
+    for (size_t meshIndex = 0; meshIndex < candidates.size(); meshIndex++)
+        candidates[meshIndex].triangleCount = m_sceneResource.meshes[meshIndex].triMesh.indices.count / 3;
+
+    const std::vector<uint32_t> occluders = nvsamples::selectOccluderMeshes(candidates, sceneBounds.min(), sceneBounds.max());
+    uint32_t                    firstMesh = 0;
+    for (const tinygltf::Model* model : models)
+    {
+        const uint32_t meshCount = uint32_t(model->meshes.size());
+        for (uint32_t meshIndex : occluders)
+        {
+            if (meshIndex >= firstMesh && meshIndex < firstMesh + meshCount)
+            {
+                nvsamples::OccluderMesh& occluder = m_occluderMeshes[meshIndex];
+                nvsamples::extractGltfMeshGeometry(*model, int(meshIndex - firstMesh), occluder.positions, occluder.indices);
+            }
+        }
+        firstMesh += meshCount;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// World space bounds of the instances, from the bounds of their mesh
+//
+nvutils::Bbox ElementFoundation::getSceneBounds() const
+{
+    const nvsamples::InstanceStore& instances = m_sceneResource.instances;
+    nvutils::Bbox                   bounds;
+    for (uint32_t i = 0; i < instances.size(); i++)
+    {
+        const nvutils::Bbox& meshBounds = m_sceneResource.meshBounds[instances.getMeshIndex(i)];
+        if (!meshBounds.isEmpty())
+            bounds.insert(meshBounds.transform(instances.getTransform(i)));
+    }
+    return bounds;
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Statistics of the last rendered frame, the memory usage is the sum of the allocations of all the heaps (at the
+// last update of the memory tracker, at the start of the frame)
+//
+ElementFoundation::FrameStats ElementFoundation::getFrameStats() const
+{
+    uint64_t gpuMemoryUsage = 0;
+    for (const nvsamples::MemoryTracker::HeapBudget& heap : m_memoryTracker.getHeapBudgets())
+        gpuMemoryUsage += heap.allocationBytes;
+
+    return { .instanceCount = uint32_t(m_sceneResource.instances.size()),
+             .culledInstances = m_culledInstances,
+             .drawCalls = uint32_t(m_instancedDraws.size()),
+             .triangles = m_drawnTriangles,
+             .recordingMs = m_recordingTime,
+             .gpuMemoryUsage = gpuMemoryUsage };
+}
+
+
 //---------------------------------------------------------------------------------------------------------------
 // The Vulkan descriptor set defines the resources that are used by the shaders.
 // Here we add the bindings for the textures.
@@ -329,7 +822,8 @@ void ElementFoundation::createGraphicsDescriptorSetLayout()
         | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT);
 
     // Creating the descriptor set and set layout from the bindings
-    m_descPack.init(bindings, m_app->getDevice(), 1, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+    // One set per frame slot: the textures of a slot are replaced when its previous frame is done
+    m_descPack.init(bindings, m_app->getDevice(), nvsamples::FramePacer::kMaxFramesInFlight, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
         VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 
     NVVK_DBG_NAME(m_descPack.getLayout());
@@ -346,7 +840,7 @@ void ElementFoundation::createGraphicsPipelineLayout()
 {
     // Push constant is used to pass data to the shader at each frame
     const VkPushConstantRange pushConstantRange{
-        .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS, .offset = 0, .size = sizeof(shaderio::TutoPushConstant) };
+        .stageFlags = getPushConstantStages(), .offset = 0, .size = sizeof(shaderio::TutoPushConstant) };
 
     // The pipeline layout is used to pass data to the pipeline, anything with "layout" in the shader
     const VkPipelineLayoutCreateInfo pipelineLayoutInfo{
@@ -365,72 +859,147 @@ void ElementFoundation::createGraphicsPipelineLayout()
 //--------------------------------------------------------------------------------------------------
 // Update the textures: this is called when the scene is loaded
 // Textures are updated in the descriptor set (0)
-void ElementFoundation::updateTextures()
+void ElementFoundation::updateTextures(uint32_t frameSlot)
 {
     if (m_textures.empty())
         return;
 
-    // Update the descriptor set with the textures
+    // Update the descriptor set of the frame slot with the textures
     nvvk::WriteSetContainer write{};
     VkWriteDescriptorSet    allTextures =
         m_descPack.makeWrite(shaderio::BindingPoints::eTextures, 0, 1, uint32_t(m_textures.size()));
+    allTextures.dstSet = m_descPack.getSet(frameSlot);
     nvvk::Image* allImages = m_textures.data();
     write.append(allTextures, allImages);
     vkUpdateDescriptorSets(m_app->getDevice(), write.size(), write.data(), 0, nullptr);
 }
 
-// This function is used to compile the Slang shader, and when it fails, it will use the pre-compiled shaders
-VkShaderModuleCreateInfo ElementFoundation::compileSlangShader(const std::filesystem::path& filename, const std::span<const uint32_t>& spirv)
+//---------------------------------------------------------------------------------------------------------------
+// Compile units of the graphics shaders. A single one: the permutations of foundation.slang are specialization
+// constants of the same SPIR-V, see createGraphicsShaders().
+std::vector<nvsamples::ShaderPermutation> ElementFoundation::getShaderPermutations() const
+{
+    const std::filesystem::path shaderSource = nvutils::findFile("foundation.slang", nvsamples::getShaderDirs());
+    return { { .name = "foundation.slang", .source = shaderSource } };
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Create the graphics shaders at startup: from the shader cache when the source did not change, otherwise from the
+// pre-compiled shaders while the source is compiled in the background.
+// The actual graphics pipeline is created elsewhere and uses these shader objects.
+void ElementFoundation::compileAndCreateGraphicsShaders()
 {
     SCOPED_TIMER(__FUNCTION__);
+    TRACE_SCOPE("compileAndCreateGraphicsShaders");
 
     // Use pre-compiled shaders by default
-    VkShaderModuleCreateInfo shaderCode = nvsamples::getShaderModuleCreateInfo(spirv);
+    const std::vector<nvsamples::ShaderPermutation> permutations = getShaderPermutations();
+    VkShaderModuleCreateInfo shaderCode = nvsamples::getShaderModuleCreateInfo(foundation_slang);
+    std::vector<uint32_t>    cachedSpirv;
+    if (m_shaderBuilder.loadCached(permutations[0], cachedSpirv))
+        shaderCode = nvsamples::getShaderModuleCreateInfo(cachedSpirv);
+    else
+        reloadGraphicsShaders();
+
+    GraphicsShaders shaders{};
+    createGraphicsShaders(shaderCode, shaders);
+    setGraphicsShaders(shaders);
+
+    // Automatic reload when a source or one of its includes is saved
+    m_shaderWatcher.start(m_shaderBuilder.getDependencies(permutations));
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Compile the permutations and create their shader objects on another thread, while the current shaders keep rendering.
+// The result is swapped in by pollShaderCompile(). The compilation does not run as a job of the JobSystem: a thread
+// waiting for the jobs of the frame would run it and stall the frame.
+void ElementFoundation::reloadGraphicsShaders()
+{
+    if (m_shaderCompile.valid())
+    {
+        m_shaderReloadPending = true;  // Compiled again once done, the source may have changed since it started
+        return;
+    }
 
-    // Try compiling the shader
-    std::filesystem::path shaderSource = nvutils::findFile(filename, nvsamples::getShaderDirs());
-    if (m_slangCompiler.compileFile(shaderSource))
+    m_shaderCompile = std::async(std::launch::async, [this, permutations = getShaderPermutations()]() {
+        TRACE_SCOPE("compileGraphicsShaders");
+        GraphicsShaders                          shaders{};
+        const std::vector<std::vector<uint32_t>> spirv = m_shaderBuilder.build(permutations);
+        if (!spirv[0].empty())
+            createGraphicsShaders(nvsamples::getShaderModuleCreateInfo(spirv[0]), shaders);
+        return shaders;
+        });
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Swap in the shaders compiled in the background once they are ready, and start the reloads requested meanwhile.
+// - Called before the frame is recorded
+void ElementFoundation::pollShaderCompile()
+{
+    if (m_autoReloadShaders && m_shaderWatcher.hasChanged())
+        reloadGraphicsShaders();
+
+    if (!m_shaderCompile.valid() || m_shaderCompile.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    GraphicsShaders shaders = m_shaderCompile.get();
+    if (shaders.vertex[0] != VK_NULL_HANDLE)
     {
-        // Using the Slang compiler to compile the shaders
-        shaderCode.codeSize = m_slangCompiler.getSpirvSize();
-        shaderCode.pCode = m_slangCompiler.getSpirv();
+        setGraphicsShaders(shaders);
+        m_shaderBinaryCache.save();  // Binaries of the new shaders, for the next launch
+
+        // Watch the includes of this compilation, some may have been added or removed
+        std::vector<std::filesystem::path> files = m_shaderBuilder.getDependencies(getShaderPermutations());
+        if (m_shaderWatcher.isRunning() && files != m_shaderWatcher.getFiles())
+            m_shaderWatcher.start(std::move(files));
     }
     else
+        LOGW("Shader reload failed, keeping the current shaders\n");
+
+    if (m_shaderReloadPending)
     {
-        LOGE("Error compiling shaders: %s\n%s\n", shaderSource.string().c_str(),
-            m_slangCompiler.getLastDiagnosticMessage().c_str());
+        m_shaderReloadPending = false;
+        reloadGraphicsShaders();
     }
-    return shaderCode;
 }
- 
 
 //---------------------------------------------------------------------------------------------------------------
-// Compile the graphics shaders and create the shader modules.
-// This function only creates vertex and fragment shader modules for the graphics pipeline.
-// The actual graphics pipeline is created elsewhere and uses these shader modules.
-// This function will use the pre-compiled shaders if the compilation fails.
-void ElementFoundation::compileAndCreateGraphicsShaders()
+// Replace the shaders used to render: the previous ones may still be used by the submitted frames, they are destroyed
+// once the last one is done. Called outside onRender(), the current frame number is the last submitted frame.
+void ElementFoundation::setGraphicsShaders(GraphicsShaders& shaders)
 {
-    SCOPED_TIMER(__FUNCTION__);
-
-    // Use pre-compiled shaders by default
-    VkShaderModuleCreateInfo shaderCode = compileSlangShader("foundation.slang", foundation_slang);
-
-    // Destroy the previous shaders if they exist
-    vkDestroyShaderEXT(m_app->getDevice(), m_vertexShader, nullptr);
-    vkDestroyShaderEXT(m_app->getDevice(), m_fragmentShader, nullptr);
+    const uint64_t lastFrame = m_framePacer.getFrameNumber();
+    for (uint32_t i = 0; i < kShaderPermutationCount; i++)
+    {
+        m_deletionQueue.destroyShader(lastFrame, m_shaders.vertex[i]);
+        m_deletionQueue.destroyShader(lastFrame, m_shaders.fragment[i]);
+        m_deletionQueue.destroyShader(lastFrame, m_shaders.task[i]);
+        m_deletionQueue.destroyShader(lastFrame, m_shaders.mesh[i]);
+    }
+    m_shaders = std::exchange(shaders, {});
+}
 
+//---------------------------------------------------------------------------------------------------------------
+// Create the shader objects of all the stages and permutations from the SPIR-V of foundation.slang, with batched
+// vkCreateShadersEXT calls. The permutations share the SPIR-V, they only differ by their specialization constant.
+// The shaders whose driver binaries were saved by a previous run are created from them, without compilation.
+// Only reads constant state and the thread-safe binary cache: safe to call from the shader compilation thread.
+// Returns false when the generic vertex or fragment shader cannot be created, `shaders` is then empty.
+bool ElementFoundation::createGraphicsShaders(const VkShaderModuleCreateInfo& shaderCode, GraphicsShaders& shaders)
+{
     // Push constant is used to pass data to the shader at each frame
     const VkPushConstantRange pushConstantRange{
-        .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
+        .stageFlags = getPushConstantStages(),
         .offset = 0,
         .size = sizeof(shaderio::TutoPushConstant),
     };
 
     // Shader create information, this is used to create the shader modules
-    VkShaderCreateInfoEXT shaderInfo{
+    const VkShaderCreateInfoEXT shaderInfo{
         .sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
         .codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+        .codeSize = shaderCode.codeSize,
+        .pCode = shaderCode.pCode,
         .pName = "main",
         .setLayoutCount = 1,
         .pSetLayouts = m_descPack.getLayoutPtr(),
@@ -438,91 +1007,363 @@ void ElementFoundation::compileAndCreateGraphicsShaders()
         .pPushConstantRanges = &pushConstantRange,
     };
 
-    // Vertex Shader
-    shaderInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    shaderInfo.nextStage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    shaderInfo.pName = "vertexMain";  // The entry point of the vertex shader
-    shaderInfo.codeSize = shaderCode.codeSize;
-    shaderInfo.pCode = shaderCode.pCode;
-    vkCreateShadersEXT(m_app->getDevice(), 1U, &shaderInfo, nullptr, &m_vertexShader);
-    NVVK_DBG_NAME(m_vertexShader);
-
-    // Fragment Shader
-    shaderInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    shaderInfo.nextStage = 0;
-    shaderInfo.pName = "fragmentMain";  // The entry point of the vertex shader
-    shaderInfo.codeSize = shaderCode.codeSize;
-    shaderInfo.pCode = shaderCode.pCode;
-    vkCreateShadersEXT(m_app->getDevice(), 1U, &shaderInfo, nullptr, &m_fragmentShader);
-    NVVK_DBG_NAME(m_fragmentShader);
+    // Value of the specialization constant (kShaderFeatures) of each permutation
+    std::array<uint32_t, kShaderPermutationCount>             features{};
+    std::array<VkSpecializationInfo, kShaderPermutationCount> specializations{};
+    const VkSpecializationMapEntry                            featuresEntry{ .constantID = 0, .offset = 0, .size = sizeof(uint32_t) };
+    for (uint32_t permutation = 0; permutation < kShaderPermutationCount; permutation++)
+    {
+        features[permutation] = permutation == 0 ? SHADER_FEATURES_GENERIC : permutation - 1;
+        specializations[permutation] = { .mapEntryCount = 1, .pMapEntries = &featuresEntry, .dataSize = sizeof(uint32_t), .pData = &features[permutation] };
+    }
+
+    std::vector<VkShaderCreateInfoEXT> createInfos;
+    std::vector<VkShaderEXT*>          targets;  // Where each created shader is stored in `shaders`
+    auto addShader = [&](VkShaderStageFlagBits stage, VkShaderStageFlags nextStage, const char* entryPoint,
+        std::array<VkShaderEXT, kShaderPermutationCount>& stageShaders, uint32_t permutation) {
+            VkShaderCreateInfoEXT createInfo = shaderInfo;
+            createInfo.stage = stage;
+            createInfo.nextStage = nextStage;
+            createInfo.pName = entryPoint;
+            createInfo.pSpecializationInfo = &specializations[permutation];
+            createInfos.push_back(createInfo);
+            targets.push_back(&stageShaders[permutation]);
+        };
+    auto addSpecialized = [&](VkShaderStageFlagBits stage, VkShaderStageFlags nextStage, const char* entryPoint,
+        std::array<VkShaderEXT, kShaderPermutationCount>& stageShaders) {
+            for (uint32_t permutation = 1; permutation < kShaderPermutationCount; permutation++)
+            {
+                if (stage == VK_SHADER_STAGE_FRAGMENT_BIT || getGeometryPermutation(permutation) == permutation)
+                    addShader(stage, nextStage, entryPoint, stageShaders, permutation);
+            }
+        };
+
+    // Vertex and Fragment Shaders, then Task and Mesh Shaders for the meshlet path (only when the device supports them).
+    // The generic permutations come first and the optional stages last: when a shader fails, the ones before it are
+    // still created and the missing specialized shaders are replaced by the generic ones.
+    shaders = {};
+    addShader(VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT, "vertexMain", shaders.vertex, 0);
+    addShader(VK_SHADER_STAGE_FRAGMENT_BIT, 0, "fragmentMain", shaders.fragment, 0);
+    addSpecialized(VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT, "vertexMain", shaders.vertex);
+    addSpecialized(VK_SHADER_STAGE_FRAGMENT_BIT, 0, "fragmentMain", shaders.fragment);
+    if (m_meshShaderSupported)
+    {
+        addShader(VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT, "taskMain", shaders.task, 0);
+        addShader(VK_SHADER_STAGE_MESH_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT, "meshMain", shaders.mesh, 0);
+        addSpecialized(VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT, "taskMain", shaders.task);
+        addSpecialized(VK_SHADER_STAGE_MESH_BIT_EXT, VK_SHADER_STAGE_FRAGMENT_BIT, "meshMain", shaders.mesh);
+    }
+
+    std::vector<VkShaderEXT> handles(createInfos.size());
+    m_shaderBinaryCache.createShaders(m_app->getDevice(), createInfos, handles);
+    for (size_t i = 0; i < handles.size(); i++)
+        *targets[i] = handles[i];
+
+    if (shaders.vertex[0] == VK_NULL_HANDLE || shaders.fragment[0] == VK_NULL_HANDLE)
+    {
+        LOGE("Vertex/Fragment shaders not created\n");
+        for (VkShaderEXT handle : handles)
+            vkDestroyShaderEXT(m_app->getDevice(), handle, nullptr);
+        shaders = {};
+        return false;
+    }
+
+    // The pre-compiled fallback may not contain the meshlet entry points
+    if (m_meshShaderSupported && (shaders.task[0] == VK_NULL_HANDLE || shaders.mesh[0] == VK_NULL_HANDLE))
+    {
+        LOGW("Task/Mesh shaders not created, the meshlet path is disabled\n");
+        for (uint32_t permutation = 0; permutation < kShaderPermutationCount; permutation++)
+        {
+            vkDestroyShaderEXT(m_app->getDevice(), shaders.task[permutation], nullptr);
+            vkDestroyShaderEXT(m_app->getDevice(), shaders.mesh[permutation], nullptr);
+        }
+        shaders.task = {};
+        shaders.mesh = {};
+    }
+
+    NVVK_DBG_NAME(shaders.vertex[0]);
+    NVVK_DBG_NAME(shaders.fragment[0]);
+    NVVK_DBG_NAME(shaders.task[0]);
+    NVVK_DBG_NAME(shaders.mesh[0]);
+    return true;
+}
+
+// Permutation whose geometry stages (vertex, task, mesh) are used with `permutation`: the same features without the
+// ones only read by the fragment shader
+uint32_t ElementFoundation::getGeometryPermutation(uint32_t permutation)
+{
+    if (permutation == 0)
+        return 0;
+    return 1 + ((permutation - 1) & SHADER_FEATURE_BASE_COLOR_TEXTURE);
+}
+
+// Permutation drawing the batches of the material with the features of the light, the generic one when disabled
+uint32_t ElementFoundation::getDrawPermutation(uint32_t sceneFeatures, uint32_t materialIndex) const
+{
+    if (!m_useSpecializedShaders)
+        return 0;
+    uint32_t features = sceneFeatures;
+    if (m_sceneResource.materials[materialIndex].baseColorTextureIndex > 0)
+        features |= SHADER_FEATURE_BASE_COLOR_TEXTURE;
+    return 1 + features;
+}
+
+// Stages using the push constant: all graphics stages, and the task/mesh stages when they are enabled on the device
+VkShaderStageFlags ElementFoundation::getPushConstantStages() const
+{
+    VkShaderStageFlags stages = VK_SHADER_STAGE_ALL_GRAPHICS;
+    if (m_meshShaderSupported)
+        stages |= VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT;
+    return stages;
 }
 
 //---------------------------------------------------------------------------------------------------------------
-// The update of scene information buffer (UBO)
+// The update of the buffers of the frame: scene information, instances and instance indices of the draws
+// The GPU no longer reads the buffers of the slot (FramePacer::beginFrame), they are written through their mapping
+// and the submission of the frame makes the writes visible: no copy nor barrier in the command buffer.
 //
-void ElementFoundation::updateSceneBuffer(VkCommandBuffer cmd)
+void ElementFoundation::updateSceneBuffer(uint32_t frameSlot)
 {
-    NVVK_DBG_SCOPE(cmd);  // <-- Helps to debug in NSight
+    TRACE_SCOPE("updateSceneBuffer");
+    FrameResources&                 frame = m_frameResources[frameSlot];
+    const nvsamples::InstanceStore& instances = m_sceneResource.instances;
+
+    // The instances only change with the scene, each slot is rewritten once after a change
+    if (frame.instancesRevision != instances.getRevision())
+    {
+        std::vector<shaderio::GltfInstance> gpuInstances(instances.size());
+        instances.writeGpuInstances(gpuInstances);
+        writeFrameBuffer(frame.bInstances, gpuInstances.data(), std::span(gpuInstances).size_bytes());
+        frame.instancesRevision = instances.getRevision();
+    }
+    writeFrameBuffer(frame.bDrawInstances, m_drawInstanceIndices.data(), std::span(m_drawInstanceIndices).size_bytes());
+
     const glm::mat4& viewMatrix = m_cameraManip->getViewMatrix();
     const glm::mat4& projMatrix = m_cameraManip->getPerspectiveMatrix();
 
     m_sceneResource.sceneInfo.viewProjMatrix = projMatrix * viewMatrix;  // Combine the view and projection matrices
     m_sceneResource.sceneInfo.cameraPosition = m_cameraManip->getEye();  // Get the camera position
-    m_sceneResource.sceneInfo.instances = (shaderio::GltfInstance*)m_sceneResource.bInstances.address;  // Get the address of the instance buffer
+    m_sceneResource.sceneInfo.instances = (shaderio::GltfInstance*)frame.bInstances.address;  // Get the address of the instance buffer of the frame
     m_sceneResource.sceneInfo.meshes = (shaderio::GltfMesh*)m_sceneResource.bMeshes.address;  // Get the address of the mesh buffer
     m_sceneResource.sceneInfo.materials = (shaderio::GltfMetallicRoughness*)m_sceneResource.bMaterials.address;  // Get the address of the material buffer
+    m_sceneResource.sceneInfo.drawInstances = (uint32_t*)frame.bDrawInstances.address;  // Get the address of the instance index of the draws
 
-    // Making sure the scene information buffer is updated before rendering
-    // Wait that the fragment shader is done reading the previous scene information and wait for the transfer to complete
-    nvvk::cmdBufferMemoryBarrier(cmd, {
-        m_sceneResource.bSceneInfo.buffer,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
-        VK_PIPELINE_STAGE_2_TRANSFER_BIT });
+    // Meshlet culling in the task shader
+    const std::array<glm::vec4, 6> frustumPlanes = nvsamples::extractFrustumPlanes(m_sceneResource.sceneInfo.viewProjMatrix);
+    std::copy(frustumPlanes.begin(), frustumPlanes.end(), m_sceneResource.sceneInfo.frustumPlanes);
+    m_sceneResource.sceneInfo.meshletConeCulling = m_meshletConeCulling ? 1 : 0;
 
-    vkCmdUpdateBuffer(cmd,
-        m_sceneResource.bSceneInfo.buffer,
-        0,
-        sizeof(shaderio::GltfSceneInfo),
-        &m_sceneResource.sceneInfo);
+    writeFrameBuffer(frame.bSceneInfo, &m_sceneResource.sceneInfo, sizeof(shaderio::GltfSceneInfo));
+}
 
-    nvvk::cmdBufferMemoryBarrier(cmd, {
-        m_sceneResource.bSceneInfo.buffer,
-        VK_PIPELINE_STAGE_2_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT });
+//---------------------------------------------------------------------------------------------------------------
+// Write data in a buffer of a frame slot, (re)creating the buffer when it is too small
+// The buffers are persistently mapped, in device memory when it is host visible (e.g. resizable BAR). The slot is
+// not in use by the GPU, so a buffer can be replaced without waiting.
+//
+void ElementFoundation::writeFrameBuffer(nvvk::Buffer& buffer, const void* data, VkDeviceSize size)
+{
+    if (buffer.bufferSize < std::max(size, VkDeviceSize(sizeof(uint32_t))))
+    {
+        m_memoryTracker.untrack(buffer.allocation);
+        m_allocator.destroyBuffer(buffer);
+        NVVK_CHECK(m_allocator.createBuffer(buffer, std::max(size * 2, VkDeviceSize(1024)), VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT));
+        NVVK_DBG_NAME(buffer.buffer);
+        m_memoryTracker.track(buffer.allocation, nvsamples::MemoryCategory::eSceneData);
+    }
+    if (size == 0)
+        return;
+    std::memcpy(buffer.mapping, data, size);
+    NVVK_CHECK(vmaFlushAllocation(m_allocator, buffer.allocation, 0, size));  // No-op for host coherent memory
 }
 
 
+//---------------------------------------------------------------------------------------------------------------
+// CPU occlusion culling of the instances
+// The occluders are rasterized in a low resolution depth buffer, then the bounding box of every other instance
+// is tested against it. The result is stored in m_instanceVisible, used when building the draw list.
+//
+void ElementFoundation::cullInstances()
+{
+    TRACE_SCOPE("cullInstances");
+    const nvsamples::InstanceStore& instances = m_sceneResource.instances;
+    const std::span<const uint32_t> meshIndices = instances.getMeshIndices();
+    const std::span<const uint32_t> flags = instances.getFlags();
+    m_instanceVisible.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); i++)
+        m_instanceVisible[i] = (flags[i] & nvsamples::eInstanceHidden) ? 0 : 1;
+    m_culledInstances = 0;
+    if (!m_useOcclusionCulling)
+        return;
+
+    auto isOccluder = [&](uint32_t meshIndex) {
+        return meshIndex < m_occluderMeshes.size() && !m_occluderMeshes[meshIndex].indices.empty();
+    };
+
+    // Rasterize the occluders
+    const glm::mat4 viewProjMatrix = m_cameraManip->getPerspectiveMatrix() * m_cameraManip->getViewMatrix();
+    m_occlusionCuller.beginFrame(viewProjMatrix);
+    for (uint32_t i = 0; i < instances.size(); i++)
+    {
+        if (m_instanceVisible[i] && isOccluder(meshIndices[i]))
+        {
+            const nvsamples::OccluderMesh& occluder = m_occluderMeshes[meshIndices[i]];
+            m_occlusionCuller.addOccluder(occluder.positions, occluder.indices, instances.getTransform(i));
+        }
+    }
+    m_occlusionCuller.rasterize();
+
+    // Test the bounding box of the instances, occluders are always drawn
+    for (uint32_t i = 0; i < instances.size(); i++)
+    {
+        const nvutils::Bbox& bounds = m_sceneResource.meshBounds[meshIndices[i]];
+        if (!m_instanceVisible[i] || isOccluder(meshIndices[i]) || bounds.isEmpty())
+            continue;
+
+        if (!m_occlusionCuller.isVisible(bounds.min(), bounds.max(), instances.getTransform(i)))
+        {
+            m_instanceVisible[i] = 0;
+            m_culledInstances++;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Select the level of detail of an instance (0 is the full resolution mesh)
+// The object space error of each level is projected on the screen at the distance of the bounding sphere,
+// the coarsest level with an error below m_lodPixelError is used.
+//
+uint32_t ElementFoundation::selectMeshLod(uint32_t instanceIndex) const
+{
+    const uint32_t                             meshIndex = m_sceneResource.instances.getMeshIndex(instanceIndex);
+    const std::vector<nvsamples::GltfMeshLod>& lods = m_sceneResource.meshLods[meshIndex];
+    const nvutils::Bbox&                       bounds = m_sceneResource.meshBounds[meshIndex];
+    if (!m_useMeshLod || lods.empty() || bounds.isEmpty())
+        return 0;
+
+    // The largest scale of the instance, errors and radius are scaled by it
+    const glm::mat4x3& transform = m_sceneResource.instances.getTransforms()[instanceIndex];
+    const float        scale = std::max({ glm::length(transform[0]), glm::length(transform[1]), glm::length(transform[2]) });
+
+    const glm::vec3 center = transform * glm::vec4(bounds.center(), 1.0f);
+    const float     distance = glm::length(center - m_cameraManip->getEye()) - bounds.radius() * scale;
+    if (distance <= 0.0f)
+        return 0;
+
+    // Pixels per world unit at the given distance
+    const float projScale = std::abs(m_cameraManip->getPerspectiveMatrix()[1][1]) * 0.5f * float(m_app->getViewportSize().height);
+    uint32_t    lodIndex = 0;
+    for (uint32_t i = 0; i < lods.size(); i++)
+    {
+        if (lods[i].error * scale / distance * projScale > m_lodPixelError)
+            break;
+        lodIndex = i + 1;
+    }
+    return lodIndex;
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Build the instanced draws of the frame
+// The instances sharing a mesh and a material are drawn with a single instanced draw call. The visible instances of
+// each batch are split by level of detail, their indices are listed in bDrawInstances and the shaders find the
+// instance of SV_InstanceID at drawInstances[firstInstance + SV_InstanceID].
+//
+void ElementFoundation::buildDrawList()
+{
+    TRACE_SCOPE("buildDrawList");
+    // Find the instances hidden by the occluders before building the draw list
+    cullInstances();
+
+    // Only the instances whose mesh or material changed move to another batch
+    const nvsamples::InstanceStore& instances = m_sceneResource.instances;
+    const std::span<const uint32_t> meshIndices = instances.getMeshIndices();
+    const std::span<const uint32_t> materialIndices = instances.getMaterialIndices();
+    m_drawBatcher.resize(uint32_t(instances.size()));
+    for (uint32_t i = 0; i < instances.size(); i++)
+        m_drawBatcher.setInstance(i, meshIndices[i], materialIndices[i]);
+
+    const bool useMeshlets = m_useMeshShaders && m_shaders.task[0] != VK_NULL_HANDLE;
+
+    // Features of the light shared by all the batches, the material adds its own
+    const shaderio::GltfSceneInfo& sceneInfo = m_sceneResource.sceneInfo;
+    uint32_t sceneFeatures = sceneInfo.useSky == 1 ? SHADER_FEATURE_LIGHT_SKY : uint32_t(sceneInfo.punctualLights[0].type) & SHADER_FEATURE_LIGHT_MASK;
+    if (m_metallicRoughnessOverride.x >= 0.0f || m_metallicRoughnessOverride.y >= 0.0f)
+        sceneFeatures |= SHADER_FEATURE_METALLIC_ROUGHNESS_OVERRIDE;
+
+    m_instancedDraws.clear();
+    m_drawInstanceIndices.clear();
+    std::vector<std::pair<uint32_t, uint32_t>> lodInstances;  // (level of detail, instance index)
+    for (const nvsamples::DrawBatch& batch : m_drawBatcher.getBatches())
+    {
+        // Meshlets are drawn at full resolution, the other meshes at the level of detail of each instance
+        const bool meshlets = useMeshlets && m_sceneResource.meshes[batch.meshIndex].meshlets.count > 0;
+        const uint32_t permutation = getDrawPermutation(sceneFeatures, batch.materialIndex);
+        lodInstances.clear();
+        for (uint32_t instanceIndex : batch.instances)
+        {
+            if (m_instanceVisible[instanceIndex])
+                lodInstances.push_back({ meshlets ? 0 : selectMeshLod(instanceIndex), instanceIndex });
+        }
+        std::sort(lodInstances.begin(), lodInstances.end());
+
+        for (size_t i = 0; i < lodInstances.size(); i++)
+        {
+            if (i == 0 || lodInstances[i].first != lodInstances[i - 1].first)
+            {
+                m_instancedDraws.push_back({ .meshIndex = batch.meshIndex,
+                                             .lodIndex = lodInstances[i].first,
+                                             .firstInstance = uint32_t(m_drawInstanceIndices.size()),
+                                             .instanceCount = 0,
+                                             .meshlets = meshlets,
+                                             .permutation = permutation });
+            }
+            m_instancedDraws.back().instanceCount++;
+            m_drawInstanceIndices.push_back(lodInstances[i].second);
+        }
+    }
+
+    // Draws sharing their shaders are recorded together, the shaders are only bound when the permutation changes
+    std::stable_sort(m_instancedDraws.begin(), m_instancedDraws.end(), [](const InstancedDraw& a, const InstancedDraw& b) {
+        return std::tie(a.meshlets, a.permutation) < std::tie(b.meshlets, b.permutation);
+        });
+    m_drawnPermutations = 0;
+    for (size_t i = 0; i < m_instancedDraws.size(); i++)
+    {
+        if (i == 0 || m_instancedDraws[i].permutation != m_instancedDraws[i - 1].permutation || m_instancedDraws[i].meshlets != m_instancedDraws[i - 1].meshlets)
+            m_drawnPermutations++;
+    }
+
+    // Triangles of the full resolution meshes for the meshlets (before the meshlet culling), of the level of detail otherwise
+    m_drawnTriangles = 0;
+    for (const InstancedDraw& draw : m_instancedDraws)
+    {
+        const shaderio::GltfMesh& gltfMesh = m_sceneResource.meshes[draw.meshIndex];
+        const uint32_t indexCount = draw.lodIndex == 0 ? gltfMesh.triMesh.indices.count : m_sceneResource.meshLods[draw.meshIndex][draw.lodIndex - 1].indices.count;
+        m_drawnTriangles += indexCount / 3 * draw.instanceCount;
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------
 // Recording the commands to render the scene
 //
 void ElementFoundation::rasterScene(VkCommandBuffer cmd)
 {
     NVVK_DBG_SCOPE(cmd);  // <-- Helps to debug in NSight
-
-    // Push constant information, see usage later
-    shaderio::TutoPushConstant pushValues{
-        .sceneInfoAddress = (shaderio::GltfSceneInfo*)m_sceneResource.bSceneInfo.address,  // Pass the address of the scene information buffer to the shader
-        .metallicRoughnessOverride = m_metallicRoughnessOverride,  // Override the metallic and roughness values
-    };
-    const VkPushConstantsInfo pushInfo{
-        .sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
-        .layout = m_graphicPipelineLayout,
-        .stageFlags = VK_SHADER_STAGE_ALL_GRAPHICS,
-        .offset = 0,
-        .size = sizeof(shaderio::TutoPushConstant),
-        .pValues = &pushValues,  // Other values are passed later
-    };
+    TRACE_SCOPE("rasterScene");
 
     // Rendering the Sky
     if (m_sceneResource.sceneInfo.useSky)
     {
+        nvsamples::GpuProfiler::Section section(m_gpuProfiler, cmd, "Sky");
         const glm::mat4& viewMatrix = m_cameraManip->getViewMatrix();
         const glm::mat4& projMatrix = m_cameraManip->getPerspectiveMatrix();
         m_skySimple.runCompute(cmd, m_app->getViewportSize(), viewMatrix, projMatrix,
             m_sceneResource.sceneInfo.skySimpleParam, m_gBuffers.getDescriptorImageInfo(eImgRendered));
     }
 
-    // Rendering to the GBuffer
+    // Rendering to the GBuffer, timed until the end of the function
+    nvsamples::GpuProfiler::Section rasterSection(m_gpuProfiler, cmd, "Raster");
     VkRenderingAttachmentInfo colorAttachment = DEFAULT_VkRenderingAttachmentInfo;
     colorAttachment.loadOp = m_sceneResource.sceneInfo.useSky ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR;  // Load the previous content of the GBuffer color attachment (Sky rendering)
     colorAttachment.imageView = m_gBuffers.getColorImageView(eImgRendered);
@@ -534,8 +1375,9 @@ void ElementFoundation::rasterScene(VkCommandBuffer cmd)
     depthAttachment.imageView = m_gBuffers.getDepthImageView();
     depthAttachment.clearValue = { .depthStencil = DEFAULT_VkClearDepthStencilValue };
 
-    // Create the rendering info
+    // Create the rendering info, the draws are recorded in secondary command buffers when recording in parallel
     VkRenderingInfo renderingInfo = DEFAULT_VkRenderingInfo;
+    renderingInfo.flags = m_useParallelRecording ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
     renderingInfo.renderArea = DEFAULT_VkRect2D(m_gBuffers.getSize());
     renderingInfo.colorAttachmentCount = 1;
     renderingInfo.pColorAttachments = &colorAttachment;
@@ -545,6 +1387,59 @@ void ElementFoundation::rasterScene(VkCommandBuffer cmd)
     nvvk::cmdImageMemoryBarrier(cmd, { m_gBuffers.getColorImage(eImgRendered), VK_IMAGE_LAYOUT_GENERAL,
                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
 
+    // All dynamic states are set when recording the draws
+    m_dynamicPipeline.rasterizationState.cullMode = VK_CULL_MODE_NONE;  // Don't cull any triangles (double-sided rendering)
+
+    // ** BEGIN RENDERING **
+    vkCmdBeginRendering(cmd, &renderingInfo);
+
+    nvutils::PerformanceTimer recordingTimer;
+    if (m_useParallelRecording)
+    {
+        // Formats of the attachments, the secondary command buffers continue the rendering
+        const VkFormat                                colorFormat = m_gBuffers.getColorFormat(eImgRendered);
+        const VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &colorFormat,
+            .depthAttachmentFormat = m_gBuffers.getDepthFormat(),
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        };
+        m_commandRecorder.recordAndExecute(cmd, m_framePacer.getFrameSlot(), inheritanceRenderingInfo, uint32_t(m_instancedDraws.size()),
+            [&](VkCommandBuffer secondary, uint32_t begin, uint32_t end) { recordDraws(secondary, begin, end); });
+    }
+    else
+    {
+        recordDraws(cmd, 0, uint32_t(m_instancedDraws.size()));
+    }
+    m_recordingTime = float(recordingTimer.getMilliseconds());
+
+    // ** END RENDERING **
+    vkCmdEndRendering(cmd);
+    nvvk::cmdImageMemoryBarrier(cmd, { m_gBuffers.getColorImage(eImgRendered), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                      VK_IMAGE_LAYOUT_GENERAL });
+}
+
+//---------------------------------------------------------------------------------------------------------------
+// Recording the instanced draws [begin, end) of the frame
+// This is called from the worker threads with secondary command buffers, which do not inherit any state: all the
+// states used by the draws are set here. The members are only read.
+//
+void ElementFoundation::recordDraws(VkCommandBuffer cmd, uint32_t begin, uint32_t end)
+{
+    // Push constant information, see usage later
+    shaderio::TutoPushConstant pushValues{
+        .sceneInfoAddress = (shaderio::GltfSceneInfo*)m_frameResources[m_framePacer.getFrameSlot()].bSceneInfo.address,  // Pass the address of the scene information buffer of the frame to the shader
+        .metallicRoughnessOverride = m_metallicRoughnessOverride,  // Override the metallic and roughness values
+    };
+    const VkPushConstantsInfo pushInfo{
+        .sType = VK_STRUCTURE_TYPE_PUSH_CONSTANTS_INFO,
+        .layout = m_graphicPipelineLayout,
+        .stageFlags = getPushConstantStages(),
+        .offset = 0,
+        .size = sizeof(shaderio::TutoPushConstant),
+        .pValues = &pushValues,  // Other values are passed later
+    };
 
     // Bind the descriptor sets for the graphics pipeline (making textures available to the shaders)
     const VkBindDescriptorSetsInfo bindDescriptorSetsInfo{ .sType = VK_STRUCTURE_TYPE_BIND_DESCRIPTOR_SETS_INFO,
@@ -552,57 +1447,102 @@ void ElementFoundation::rasterScene(VkCommandBuffer cmd)
                                                           .layout = m_graphicPipelineLayout,
                                                           .firstSet = 0,
                                                           .descriptorSetCount = 1,
-                                                          .pDescriptorSets = m_descPack.getSetPtr() };
+                                                          .pDescriptorSets = m_descPack.getSetPtr(m_framePacer.getFrameSlot()) };
     vkCmdBindDescriptorSets2(cmd, &bindDescriptorSetsInfo);
 
-
-    // ** BEGIN RENDERING **
-    vkCmdBeginRendering(cmd, &renderingInfo);
-
     // All dynamic states are set here
-    m_dynamicPipeline.rasterizationState.cullMode = VK_CULL_MODE_NONE;  // Don't cull any triangles (double-sided rendering)
     m_dynamicPipeline.cmdApplyAllStates(cmd);
     m_dynamicPipeline.cmdSetViewportAndScissor(cmd, m_app->getViewportSize());
     vkCmdSetDepthTestEnable(cmd, VK_TRUE);
 
-    // Same shader for all meshes
-    m_dynamicPipeline.cmdBindShaders(cmd, {
-        .vertex = m_vertexShader,
-        .fragment = m_fragmentShader });
-
+    // Shaders of the permutation of the draw: the vertex pipeline, or the task/mesh pipeline for the meshes with meshlets.
+    // A specialized shader that could not be created is replaced by the generic one, their interfaces are the same.
+    auto getShader = [](const std::array<VkShaderEXT, kShaderPermutationCount>& shaders, uint32_t permutation) {
+        return shaders[permutation] != VK_NULL_HANDLE ? shaders[permutation] : shaders[0];
+        };
+    int        boundPath = -1;
+    uint32_t   boundPermutation = ~0U;
+    auto       bindShaders = [&](bool meshlets, uint32_t permutation) {
+        if (boundPath == int(meshlets) && boundPermutation == permutation)
+            return;
+        boundPath = int(meshlets);
+        boundPermutation = permutation;
+        const uint32_t geometry = getGeometryPermutation(permutation);
+        m_dynamicPipeline.cmdBindShaders(cmd, {
+            .vertex = meshlets ? VK_NULL_HANDLE : getShader(m_shaders.vertex, geometry),
+            .fragment = getShader(m_shaders.fragment, permutation) });
+        if (m_meshShaderSupported)
+        {
+            const VkShaderStageFlagBits stages[] = { VK_SHADER_STAGE_TASK_BIT_EXT, VK_SHADER_STAGE_MESH_BIT_EXT };
+            const VkShaderEXT           shaders[] = { meshlets ? getShader(m_shaders.task, geometry) : VK_NULL_HANDLE,
+                                                      meshlets ? getShader(m_shaders.mesh, geometry) : VK_NULL_HANDLE };
+            vkCmdBindShadersEXT(cmd, 2, stages, shaders);
+        }
+    };
 
     // We don't send vertex attributes, they are pulled in the shader
-    VkVertexInputBindingDescription2EXT   bindingDescription = {};
-    VkVertexInputAttributeDescription2EXT attributeDescription = {};
     vkCmdSetVertexInputEXT(cmd, 0, nullptr, 0, nullptr);
 
-    for (size_t i = 0; i < m_sceneResource.instances.size(); i++)
+    for (uint32_t drawIndex = begin; drawIndex < end; drawIndex++)
     {
-        uint32_t                      meshIndex = m_sceneResource.instances[i].meshIndex;
-        const shaderio::GltfMesh& gltfMesh = m_sceneResource.meshes[meshIndex];
+        const InstancedDraw&          draw = m_instancedDraws[drawIndex];
+        const shaderio::GltfMesh&     gltfMesh = m_sceneResource.meshes[draw.meshIndex];
         const shaderio::TriangleMesh& triMesh = gltfMesh.triMesh;
 
         // Push constant is information that is passed to the shader at each draw call.
-        pushValues.normalMatrix = glm::transpose(glm::inverse(glm::mat3(m_sceneResource.instances[i].transform)));
-        pushValues.instanceIndex = int(i);  // The index of the instance in the m_instances vector
+        pushValues.firstInstance = int(draw.firstInstance);  // The instances of the draw in GltfSceneInfo::drawInstances
         vkCmdPushConstants2(cmd, &pushInfo);
 
+        // Meshlets: one task shader workgroup culls MESHLET_TASK_GROUP_SIZE meshlets (full resolution, no LOD),
+        // one row of workgroups per instance. The rows are split to stay in the limit of the Y dimension.
+        if (draw.meshlets)
+        {
+            bindShaders(true, draw.permutation);
+            const uint32_t maxRows = 65535;
+            const uint32_t groupCount = (gltfMesh.meshlets.count + MESHLET_TASK_GROUP_SIZE - 1) / MESHLET_TASK_GROUP_SIZE;
+            for (uint32_t first = 0; first < draw.instanceCount; first += maxRows)
+            {
+                if (first > 0)
+                {
+                    pushValues.firstInstance = int(draw.firstInstance + first);
+                    vkCmdPushConstants2(cmd, &pushInfo);
+                }
+                vkCmdDrawMeshTasksEXT(cmd, groupCount, std::min(maxRows, draw.instanceCount - first), 1);
+            }
+            continue;
+        }
+        bindShaders(false, draw.permutation);
+
+        // Simplified index buffer for distant instances, the vertices are shared by all levels
+        const shaderio::BufferView& indices = draw.lodIndex == 0 ? triMesh.indices : m_sceneResource.meshLods[draw.meshIndex][draw.lodIndex - 1].indices;
+
         // Bind index buffers
-        vkCmdBindIndexBuffer(cmd, m_sceneResource.bGltfDatas[meshIndex].buffer, triMesh.indices.offset,
+        vkCmdBindIndexBuffer(cmd, m_sceneResource.bGltfDatas[m_sceneResource.meshBufferIndex[draw.meshIndex]].buffer, indices.offset,
             VkIndexType(gltfMesh.indexType));
 
-        // Draw the mesh
-        vkCmdDrawIndexed(cmd, triMesh.indices.count, 1, 0, 0, 0);  // All indices
+        // Draw all the instances of the batch at this level of detail
+        vkCmdDrawIndexed(cmd, indices.count, draw.instanceCount, 0, 0, 0);
     }
-
-    // ** END RENDERING **
-    vkCmdEndRendering(cmd);
-    nvvk::cmdImageMemoryBarrier(cmd, { m_gBuffers.getColorImage(eImgRendered), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                                      VK_IMAGE_LAYOUT_GENERAL });
 }
 
 void ElementFoundation::onLastHeadlessFrame() 
 {
     m_app->saveImageToFile(m_gBuffers.getColorImage(eImgTonemapped), m_gBuffers.getSize(),
         nvutils::getExecutablePath().replace_extension(".jpg").string());
+
+    // GPU timings of the rendered frames, the GPU is done with all of them
+    m_gpuProfiler.collect();
+    const std::filesystem::path timingsFilename = nvutils::getExecutablePath().replace_extension(".gpu_timings.csv");
+    if (m_gpuProfiler.exportStats(timingsFilename))
+        LOGI("GPU timings written to %s\n", nvutils::utf8FromPath(timingsFilename).c_str());
+    else
+        LOGW("Could not write the GPU timings to %s\n", nvutils::utf8FromPath(timingsFilename).c_str());
+
+    // Memory usage per category and heap budgets
+    m_memoryTracker.update();
+    const std::filesystem::path memoryFilename = nvutils::getExecutablePath().replace_extension(".memory.json");
+    if (m_memoryTracker.exportJson(memoryFilename))
+        LOGI("Memory usage written to %s\n", nvutils::utf8FromPath(memoryFilename).c_str());
+    else
+        LOGW("Could not write the memory usage to %s\n", nvutils::utf8FromPath(memoryFilename).c_str());
 }
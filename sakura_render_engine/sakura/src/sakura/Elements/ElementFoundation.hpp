@@ -13,6 +13,8 @@
 
 
 
+#include <future>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <imgui/imgui.h>
@@ -32,6 +34,21 @@
 #include "common/gltf_utils.hpp"  // GLTF utilities for loading and importing GLTF models
 #include "common/utils.hpp"       // Common utilities for the sample application
 #include "common/path_utils.hpp"  // Path utilities for handling resources file paths
+#include "common/occlusion_culler.hpp"  // CPU occlusion culling of the instances
+#include "common/meshlet_builder.hpp"   // Meshlet frustum planes
+#include "common/draw_batcher.hpp"      // Grouping of the instances by mesh and material
+#include "common/command_recorder.hpp"  // Parallel recording of secondary command buffers
+#include "common/job_system.hpp"        // Work-stealing job scheduler shared by the loader, the culling and the recording
+#include "common/frame_pacer.hpp"       // Frames in flight, reuse of the per-frame resources
+#include "common/gpu_profiler.hpp"      // GPU timings of the passes
+#include "common/trace_recorder.hpp"    // Timeline of the CPU scopes and GPU passes (Chrome trace)
+#include "common/camera_path.hpp"       // Recorded camera paths, replayed by the benchmark
+#include "common/memory_tracker.hpp"    // Memory usage per category and heap budgets
+#include "common/deletion_queue.hpp"    // Destruction of the GPU objects once the frames using them are done
+#include "common/shader_cache.hpp"      // On-disk cache of the compiled SPIR-V
+#include "common/file_watcher.hpp"      // Modifications of the shader sources, for the automatic reload
+#include "common/shader_build_service.hpp"  // Concurrent compilation of the shader permutations
+#include "common/shader_binary_cache.hpp"   // Driver binaries of the shader objects, saved between runs
 
 
 class ElementFoundation : public nvapp::IAppElement
@@ -55,19 +72,79 @@ public:
 	virtual void onUIMenu() override;
 	virtual void onRender(VkCommandBuffer cmd) override;
 	virtual void onLastHeadlessFrame() override;
+	virtual void onFileDrop(const std::filesystem::path& filename) override;
 
-	void createScene();
+	void createScene(VkCommandBuffer cmd);
+	bool importSceneFile();
+	void createOccluders(std::span<const tinygltf::Model* const> models);
+	void swapScene(VkCommandBuffer cmd);
+	void retireScene();
 	void createGraphicsDescriptorSetLayout();
 	void createGraphicsPipelineLayout();
-	void updateTextures();
-	VkShaderModuleCreateInfo compileSlangShader(const std::filesystem::path& filename, const std::span<const uint32_t>& spirv);
+	void updateTextures(uint32_t frameSlot);
+	// Shader objects of the permutations of foundation.slang: index 0 is the generic permutation, testing the features at
+	// runtime, index 1 + features is specialized for the SHADER_FEATURE_* bits (shaderio.h). The geometry stages only
+	// depend on SHADER_FEATURE_BASE_COLOR_TEXTURE, they are created for the permutations without the other bits.
+	static constexpr uint32_t kShaderPermutationCount = 1 + SHADER_FEATURE_COUNT;
+	struct GraphicsShaders
+	{
+		std::array<VkShaderEXT, kShaderPermutationCount> vertex{};
+		std::array<VkShaderEXT, kShaderPermutationCount> fragment{};
+		std::array<VkShaderEXT, kShaderPermutationCount> task{};
+		std::array<VkShaderEXT, kShaderPermutationCount> mesh{};
+	};
+	static uint32_t getGeometryPermutation(uint32_t permutation);
+	std::vector<nvsamples::ShaderPermutation> getShaderPermutations() const;
 	void compileAndCreateGraphicsShaders();
-	void updateSceneBuffer(VkCommandBuffer cmd);
+	void reloadGraphicsShaders();
+	void pollShaderCompile();
+	void setGraphicsShaders(GraphicsShaders& shaders);
+	bool createGraphicsShaders(const VkShaderModuleCreateInfo& shaderCode, GraphicsShaders& shaders);
+	VkShaderStageFlags getPushConstantStages() const;
+	uint32_t getDrawPermutation(uint32_t sceneFeatures, uint32_t materialIndex) const;
+	void cullInstances();
+	void buildDrawList();
+	void updateSceneBuffer(uint32_t frameSlot);
+	void writeFrameBuffer(nvvk::Buffer& buffer, const void* data, VkDeviceSize size);
+	uint32_t selectMeshLod(uint32_t instanceIndex) const;
 	void rasterScene(VkCommandBuffer cmd);
+	void recordDraws(VkCommandBuffer cmd, uint32_t begin, uint32_t end);
 	void postProcess(VkCommandBuffer cmd);
 
 
 
+	// Enable the task/mesh shader path, to call before attaching the element (requires VK_EXT_mesh_shader)
+	void setMeshShaderSupport(bool supported) { m_meshShaderSupported = supported; }
+
+	// Heap budgets from the driver, to call before attaching the element (requires VK_EXT_memory_budget)
+	void setMemoryBudgetSupport(bool supported) { m_memoryBudgetSupported = supported; }
+
+	// glTF file loaded instead of the default scene (teapot and plane), to call before attaching the element
+	void setSceneFile(const std::filesystem::path& filename) { m_sceneFile = filename; }
+
+	// Replace the scene at the start of the next frame, by the file or the default scene when the filename is empty.
+	// The resources of the previous scene are destroyed once the GPU is done with the frames using them.
+	void loadScene(const std::filesystem::path& filename);
+	// Remove the scene at the start of the next frame, only the sky is rendered
+	void unloadScene();
+
+	// World space bounds of the instances
+	nvutils::Bbox getSceneBounds() const;
+
+	// Statistics of the last rendered frame
+	struct FrameStats
+	{
+		uint32_t instanceCount;    // Instances in the scene
+		uint32_t culledInstances;  // Instances hidden by the occlusion culling
+		uint32_t drawCalls;        // Instanced draws
+		uint32_t triangles;        // Triangles of the drawn levels of detail
+		float    recordingMs;      // CPU time recording the draws
+		uint64_t gpuMemoryUsage;   // Bytes allocated by the resource allocator, in all memory heaps
+	};
+	FrameStats getFrameStats() const;
+	nvsamples::GpuProfiler&       getGpuProfiler() { return m_gpuProfiler; }  // e.g. to reset the statistics
+	nvsamples::MemoryTracker&     getMemoryTracker() { return m_memoryTracker; }  // e.g. to react to the budget pressure
+
 	// Accessor for camera manipulator
 	std::shared_ptr<nvutils::CameraManipulator> getCameraManipulator() const { return m_cameraManip; }
 private:
@@ -77,7 +154,6 @@ private:
 	nvvk::StagingUploader  m_stagingUploader{};  // Utility to upload data to the GPU, used for staging buffers and images
 	nvvk::SamplerPool      m_samplerPool{};      // Texture sampler pool, used to acquire texture samplers for images
 	nvvk::GBuffer          m_gBuffers{};         // The G-Buffer
-	nvslang::SlangCompiler m_slangCompiler{};    // The Slang compiler used to compile the shaders
 
 	// Camera manipulator
 	std::shared_ptr<nvutils::CameraManipulator> m_cameraManip{ std::make_shared<nvutils::CameraManipulator>() };
@@ -88,8 +164,9 @@ private:
 	VkPipelineLayout m_graphicPipelineLayout{};  // The pipeline layout use with graphics pipeline
 
 	// Shaders
-	VkShaderEXT m_vertexShader{};    // The vertex shader used to render the scene
-	VkShaderEXT m_fragmentShader{};  // The fragment shader used to render the scene
+	GraphicsShaders m_shaders{};                    // Vertex and fragment shaders, task and mesh shaders (meshlet path), per permutation
+	bool            m_useSpecializedShaders{ true };  // Draw each batch with the permutation of its material and light
+	uint32_t        m_drawnPermutations{ 0 };         // Number of permutations bound by the draws of the frame
 
 
 	// Scene information buffer (UBO)
@@ -100,4 +177,90 @@ private:
 	nvshaders::Tonemapper    m_tonemapper{};      // Tonemapper for post-processing effects
 	shaderio::TonemapperData m_tonemapperData{};  // Tonemapper data used to pass parameters to the tonemapper shader
 	glm::vec2 m_metallicRoughnessOverride{ -0.01f, -0.01f };  // Override values for metallic and roughness, used in the UI to control the material properties
+
+	// CPU occlusion culling
+	nvsamples::OcclusionCuller           m_occlusionCuller{};           // Software rasterizer of the occluders, tests the instances bounding boxes
+	std::vector<nvsamples::OccluderMesh> m_occluderMeshes{};            // CPU geometry of the occluders, per mesh (empty when the mesh is not an occluder)
+	std::vector<uint8_t>                 m_instanceVisible{};           // Visibility of each instance for the current frame
+	bool                                 m_useOcclusionCulling{ true };  // Enable the CPU occlusion culling
+	uint32_t                             m_culledInstances{};           // Number of instances culled in the last frame
+
+	// Mesh levels of detail
+	bool     m_useMeshLod{ true };      // Select the level of detail of each instance from its screen space error
+	float    m_lodPixelError{ 1.0f };   // Maximum screen space error of a level of detail, in pixels
+	uint32_t m_drawnTriangles{};        // Number of triangles drawn in the last frame
+
+	// Instanced draws
+	struct InstancedDraw
+	{
+		uint32_t meshIndex;      // Mesh of the batch
+		uint32_t lodIndex;       // Level of detail (0 is the full resolution mesh)
+		uint32_t firstInstance;  // First entry in m_drawInstanceIndices
+		uint32_t instanceCount;  // Number of instances drawn
+		bool     meshlets;       // Drawn with the task/mesh shaders
+		uint32_t permutation;    // Shader permutation of the material and the light, index in GraphicsShaders
+	};
+	nvsamples::DrawBatcher     m_drawBatcher{};          // Instances grouped by (mesh, material), updated incrementally
+	std::vector<InstancedDraw> m_instancedDraws{};       // Draws of the current frame
+	std::vector<uint32_t>      m_drawInstanceIndices{};  // Instance index of each draw entry, uploaded to FrameResources::bDrawInstances
+
+	// Frames in flight: the buffers written by the CPU each frame have one copy per frame slot
+	struct FrameResources
+	{
+		nvvk::Buffer bSceneInfo{};                   // GltfSceneInfo of the frame
+		nvvk::Buffer bInstances{};                   // GltfInstance records (GltfSceneInfo::instances)
+		nvvk::Buffer bDrawInstances{};               // Copy of m_drawInstanceIndices (GltfSceneInfo::drawInstances)
+		uint64_t     instancesRevision{ ~0ULL };     // InstanceStore revision written in bInstances
+		uint64_t     texturesRevision{ ~0ULL };      // m_texturesRevision written in the descriptor set of the slot
+	};
+	nvsamples::FramePacer m_framePacer{};            // Waits for the GPU before a frame slot is reused
+	std::array<FrameResources, nvsamples::FramePacer::kMaxFramesInFlight> m_frameResources{};
+	nvsamples::GpuProfiler m_gpuProfiler{};          // Timestamps of the passes, read when the frame slot is reused
+
+	// Shader cache and reload: the shaders are compiled in the background (after a cache miss at launch, F5, or a saved
+	// source) while the current ones keep rendering, and swapped once their shader objects are created
+	nvsamples::ShaderCache        m_shaderCache{};
+	nvsamples::ShaderBinaryCache  m_shaderBinaryCache{};           // Skips the driver compilation of the shader objects
+	nvsamples::ShaderBuildService m_shaderBuilder{};               // The Slang compilers used to compile the shaders
+	std::future<GraphicsShaders>  m_shaderCompile{};               // Background compilation, uses m_shaderBuilder
+	bool                          m_shaderReloadPending{ false };  // Reload requested during the compilation
+	nvsamples::FileWatcher        m_shaderWatcher{};               // The shader sources and their includes
+	bool                          m_autoReloadShaders{ true };     // Reload the shaders when the watched files are saved
+
+	// Memory
+	nvsamples::MemoryTracker m_memoryTracker{};                  // Allocations tagged by category
+	bool                     m_memoryBudgetSupported{ false };  // VK_EXT_memory_budget is enabled on the device
+
+	// Command recording
+	nvsamples::SecondaryCommandRecorder m_commandRecorder{};             // Records the draws on several threads
+	bool                                m_useParallelRecording{ true };  // Record the draws in secondary command buffers
+	float                               m_recordingTime{};               // CPU time to record the draws, in milliseconds
+
+	// Scene
+	std::filesystem::path m_sceneFile{};  // glTF file of the scene, the default scene when empty
+	uint64_t              m_texturesRevision{ 0 };  // Incremented when m_textures changes
+
+	// Scene swap, applied at the start of the next frame
+	enum class SceneRequest
+	{
+		eNone,
+		eLoad,    // Load m_requestedSceneFile
+		eUnload,  // Empty scene
+	};
+	SceneRequest          m_sceneRequest{ SceneRequest::eNone };
+	std::filesystem::path m_requestedSceneFile{};
+	uint64_t              m_stagingReleaseFrame{ 0 };  // Frame uploading the last swapped scene, its staging is released once done
+
+	// Replaced scenes and shaders, destroyed once the GPU is done with the last frame using them (frame numbers)
+	nvsamples::DeletionQueue m_deletionQueue{};
+
+	// Camera path recording, one key every 0.1 second
+	nvsamples::CameraPath     m_cameraPath{};
+	bool                      m_recordCameraPath{ false };
+	nvutils::PerformanceTimer m_cameraPathTimer{};
+
+	// Meshlets
+	bool m_meshShaderSupported{ false };  // VK_EXT_mesh_shader task and mesh shaders are enabled on the device
+	bool m_useMeshShaders{ false };       // Draw the meshes with meshlets through the task/mesh shaders
+	bool m_meshletConeCulling{ false };   // Cull the back facing meshlets, off by default: the materials are double-sided like the vertex path (VK_CULL_MODE_NONE)
 };
\ No newline at end of file
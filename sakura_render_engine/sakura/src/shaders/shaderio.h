@@ -30,11 +30,18 @@ enum BindingPoints
   eTextures = 0,  // Binding point for textures
 };
 
+// Features of a specialized permutation of foundation.slang, value of its specialization constant (constant_id 0)
+#define SHADER_FEATURE_LIGHT_MASK 0x3                   // Light model: GltfLightType of the first light, or the sky
+#define SHADER_FEATURE_LIGHT_SKY 0x3                    //   Sun of the sky (directional)
+#define SHADER_FEATURE_BASE_COLOR_TEXTURE 0x4           // The material has a base color texture
+#define SHADER_FEATURE_METALLIC_ROUGHNESS_OVERRIDE 0x8  // The push constant overrides the metallic or the roughness
+#define SHADER_FEATURE_COUNT 16                         // Number of feature sets
+#define SHADER_FEATURES_GENERIC 0xFFFFFFFF              // Generic permutation: the features are tested at runtime
+
 
 struct TutoPushConstant
 {
-  float3x3       normalMatrix;
-  int            instanceIndex;              // Instance index for the current draw call
+  int            firstInstance;              // First entry of the draw in GltfSceneInfo::drawInstances
   GltfSceneInfo* sceneInfoAddress;           // Address of the scene information buffer
   float2         metallicRoughnessOverride;  // Metallic and roughness override values
 };
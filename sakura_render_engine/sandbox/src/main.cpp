@@ -1,4 +1,5 @@
 #include <sakura/Elements/ElementFoundation.hpp>
+#include "common/job_system_benchmark.hpp"
 
 
 //---------------------------------------------------------------------------------------------------------------
@@ -10,19 +11,31 @@ int main(int argc, char** argv)
     // Parsing the command line
     nvutils::ParameterParser   cli(nvutils::getExecutablePath().stem().string());
     nvutils::ParameterRegistry reg;
+    bool benchmarkJobs = false;
     reg.add({ "headless", "Run in headless mode" }, &appInfo.headless, true);
+    reg.add({ "benchmarkJobs", "Measure the job system throughput and scaling, then exit" }, &benchmarkJobs, true);
     cli.add(reg);
     cli.parse(argc, argv);
 
+    if (benchmarkJobs)
+    {
+        nvsamples::runJobSystemBenchmark();
+        return 0;
+    }
+
     // Setting up the Vulkan context, instance and device extensions
     VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures
     { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT };
+    VkPhysicalDeviceMeshShaderFeaturesEXT meshShaderFeatures
+    { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
     nvvk::ContextInitInfo vkSetup{
         .instanceExtensions = {VK_EXT_DEBUG_UTILS_EXTENSION_NAME},
         .deviceExtensions =
             {
                 {VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME},
                 {VK_EXT_SHADER_OBJECT_EXTENSION_NAME, &shaderObjectFeatures},
+                {VK_EXT_MESH_SHADER_EXTENSION_NAME, &meshShaderFeatures, false},  // Optional, meshlet rendering path
+                {VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, nullptr, false},            // Optional, heap budgets from the driver
             },
     };
     if (!appInfo.headless)
@@ -70,6 +83,8 @@ int main(int argc, char** argv)
     auto windowTitle = std::make_shared<nvapp::ElementDefaultWindowTitle>();  // Element displaying the window title with application name and size
     auto windowMenu = std::make_shared<nvapp::ElementDefaultMenu>();  // Element displaying a menu, File->Exit ...
     auto camManip = foundation->getCameraManipulator();
+    foundation->setMeshShaderSupport(meshShaderFeatures.taskShader == VK_TRUE && meshShaderFeatures.meshShader == VK_TRUE);
+    foundation->setMemoryBudgetSupport(vkContext.hasExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME));
     elemCamera->setCameraManipulator(camManip);
 
     // Adding all elements